@@ -0,0 +1,528 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <coroutine>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#include <MemEx.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//Global allocator implementation
+namespace MemEx {
+	ptr_t GAllocate(size_t BlockSize, size_t BlockAlignment) noexcept {
+		return _aligned_malloc(BlockSize, BlockAlignment);
+	}
+
+	void GFree(ptr_t BlockPtr) noexcept {
+		_aligned_free(BlockPtr);
+	}
+}
+
+using namespace MemEx;
+
+struct SmallObject {
+	uint64_t Data[8]{ };
+};
+
+//Run [Work] on [ThreadsCount] threads started at the same time, returns the elapsed seconds
+template<typename TWork>
+double RunOnThreads(size_t ThreadsCount, TWork Work) {
+	std::atomic<bool> bStart{ false };
+	std::vector<std::thread> Threads;
+
+	for (size_t i = 0; i < ThreadsCount; i++) {
+		Threads.emplace_back([&]() {
+			while (!bStart.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+
+			Work();
+		});
+	}
+
+	const auto Start = std::chrono::steady_clock::now();
+	bStart.store(true, std::memory_order_release);
+
+	for (auto& Thread : Threads) {
+		Thread.join();
+	}
+
+	const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+	return Elapsed.count();
+}
+
+//Each thread allocates and releases [Iterations] batches of [BatchSize] objects, returns allocations/sec
+double BenchmarkAllocation(size_t ThreadsCount, size_t Iterations) {
+	constexpr size_t BatchSize = 64;
+
+	const double Seconds = RunOnThreads(ThreadsCount, [Iterations]() {
+		MPtr<SmallObject> Batch[BatchSize];
+
+		for (size_t i = 0; i < Iterations; i++) {
+			for (auto& Obj : Batch) {
+				Obj = MemoryManager::Alloc<SmallObject>();
+			}
+			for (auto& Obj : Batch) {
+				Obj.Reset();
+			}
+		}
+	});
+
+	return static_cast<double>(ThreadsCount * Iterations * BatchSize) / Seconds;
+}
+
+void RunAllocationBenchmark() {
+	constexpr size_t Iterations = 20000;
+
+	const size_t MaxThreads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+	std::cout << "#Allocation benchmark (" << PoolShardsCount << " shards per tier):\n";
+
+	double SingleThreadRate = 0.0;
+	for (size_t ThreadsCount = 1; ThreadsCount <= MaxThreads; ThreadsCount *= 2) {
+		const double Rate = BenchmarkAllocation(ThreadsCount, Iterations);
+		if (ThreadsCount == 1) {
+			SingleThreadRate = Rate;
+		}
+
+		std::cout << "\tThreads:" << ThreadsCount
+			<< "\tAllocations/sec:" << static_cast<size_t>(Rate)
+			<< "\tScaling:" << (Rate / SingleThreadRate) << "x\n";
+	}
+}
+
+//Coroutine that completes on its first resume, [TPromiseBase] selects the frame allocator
+template<typename TPromiseBase>
+struct BenchmarkTask {
+	struct promise_type : TPromiseBase {
+		BenchmarkTask get_return_object() noexcept {
+			return BenchmarkTask{ std::coroutine_handle<promise_type>::from_promise(*this) };
+		}
+
+		std::suspend_always initial_suspend() noexcept { return { }; }
+		std::suspend_always final_suspend() noexcept { return { }; }
+		void return_void() noexcept { }
+		void unhandled_exception() noexcept { }
+	};
+
+	std::coroutine_handle<promise_type> Handle;
+};
+
+struct DefaultCoroutineAllocator { };
+
+std::atomic<uint64_t> BenchmarkSink{ 0 };
+
+template<typename TPromiseBase>
+BenchmarkTask<TPromiseBase> SmallCoroutine(uint64_t A, uint64_t B, uint64_t* Out) {
+	*Out += A * B;
+	co_return;
+}
+
+//Each thread spawns, completes and destroys [Iterations] batches of [BatchSize] coroutines, returns coroutines/sec
+template<typename TPromiseBase>
+double BenchmarkCoroutines(size_t ThreadsCount, size_t Iterations) {
+	constexpr size_t BatchSize = 64;
+
+	const double Seconds = RunOnThreads(ThreadsCount, [Iterations]() {
+		BenchmarkTask<TPromiseBase> Batch[BatchSize];
+		uint64_t Sink = 0;
+
+		for (size_t i = 0; i < Iterations; i++) {
+			for (size_t j = 0; j < BatchSize; j++) {
+				Batch[j] = SmallCoroutine<TPromiseBase>(i, j, &Sink);
+			}
+			for (auto& Task : Batch) {
+				Task.Handle.resume();
+				Task.Handle.destroy();
+			}
+		}
+
+		//Keep the coroutine bodies observable
+		BenchmarkSink.fetch_add(Sink, std::memory_order_relaxed);
+	});
+
+	return static_cast<double>(ThreadsCount * Iterations * BatchSize) / Seconds;
+}
+
+void RunCoroutineBenchmark() {
+	constexpr size_t Iterations = 20000;
+
+	const size_t MaxThreads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+	std::cout << "#Coroutine spawn/complete benchmark:\n";
+
+	for (size_t ThreadsCount = 1; ThreadsCount <= MaxThreads; ThreadsCount *= 2) {
+		const double DefaultRate = BenchmarkCoroutines<DefaultCoroutineAllocator>(ThreadsCount, Iterations);
+		const double PooledRate = BenchmarkCoroutines<MemExCoroutineAllocator>(ThreadsCount, Iterations);
+
+		std::cout << "\tThreads:" << ThreadsCount
+			<< "\tDefault coroutines/sec:" << static_cast<size_t>(DefaultRate)
+			<< "\tMemEx coroutines/sec:" << static_cast<size_t>(PooledRate)
+			<< "\tSpeedup:" << (PooledRate / DefaultRate) << "x\n";
+	}
+}
+
+//Hardware cache misses of the calling thread, only available on Linux (perf_event_open)
+class CacheMissCounter {
+public:
+	CacheMissCounter() noexcept {
+#ifdef __linux__
+		perf_event_attr Attributes{ };
+		Attributes.type = PERF_TYPE_HARDWARE;
+		Attributes.size = sizeof(Attributes);
+		Attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+		Attributes.disabled = 1;
+		Attributes.exclude_kernel = 1;
+		Attributes.exclude_hv = 1;
+
+		Descriptor = static_cast<int>(syscall(SYS_perf_event_open, &Attributes, 0, -1, -1, 0));
+#endif
+	}
+
+	~CacheMissCounter() noexcept {
+#ifdef __linux__
+		if (Descriptor >= 0) {
+			close(Descriptor);
+		}
+#endif
+	}
+
+	bool IsAvailable() const noexcept {
+		return Descriptor >= 0;
+	}
+
+	void Start() noexcept {
+#ifdef __linux__
+		if (Descriptor >= 0) {
+			ioctl(Descriptor, PERF_EVENT_IOC_RESET, 0);
+			ioctl(Descriptor, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	uint64_t Stop() noexcept {
+		uint64_t Count = 0;
+#ifdef __linux__
+		if (Descriptor >= 0) {
+			ioctl(Descriptor, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(Descriptor, &Count, sizeof(Count)) != sizeof(Count)) {
+				Count = 0;
+			}
+		}
+#endif
+		return Count;
+	}
+
+private:
+	int Descriptor{ -1 };
+};
+
+struct alignas(MEMEX_CACHE_LINE_SIZE) ReuseBlock {
+	uint8_t Data[SmallMemBlockSize]{ };
+};
+
+//Allocate, write and release a block [Iterations] times, returns the elapsed seconds and the cache misses
+template<typename TPool>
+double BenchmarkReuse(size_t Iterations, uint64_t& OutCacheMisses) {
+	CacheMissCounter Counter;
+
+	const auto Start = std::chrono::steady_clock::now();
+	Counter.Start();
+
+	for (size_t i = 0; i < Iterations; i++) {
+		ReuseBlock* Block = TPool::NewRaw();
+		memset(Block->Data, static_cast<int>(i), sizeof(Block->Data));
+		TPool::Deallocate(Block);
+	}
+
+	OutCacheMisses = Counter.Stop();
+	const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+	return Elapsed.count();
+}
+
+void RunReuseOrderBenchmark() {
+	constexpr size_t PoolSize = 4096;
+	constexpr size_t Iterations = 1000000;
+
+	using FIFOPool = TObjectPool<ReuseBlock, PoolSize, true, 1, false>;
+	using LIFOPool = TObjectPool<ReuseBlock, PoolSize, true, 1, true>;
+
+	FIFOPool::Preallocate();
+	LIFOPool::Preallocate();
+
+	uint64_t FIFOMisses = 0;
+	uint64_t LIFOMisses = 0;
+	const double FIFOSeconds = BenchmarkReuse<FIFOPool>(Iterations, FIFOMisses);
+	const double LIFOSeconds = BenchmarkReuse<LIFOPool>(Iterations, LIFOMisses);
+
+	std::cout << "#Block reuse order benchmark (" << PoolSize << " blocks of " << sizeof(ReuseBlock) << " bytes):\n";
+	std::cout << "\tFIFO:\tAllocations/sec:" << static_cast<size_t>(Iterations / FIFOSeconds);
+	if (CacheMissCounter().IsAvailable()) {
+		std::cout << "\tCacheMisses:" << FIFOMisses;
+	}
+	std::cout << "\n\tLIFO:\tAllocations/sec:" << static_cast<size_t>(Iterations / LIFOSeconds);
+	if (CacheMissCounter().IsAvailable()) {
+		std::cout << "\tCacheMisses:" << LIFOMisses;
+	}
+	std::cout << "\n";
+}
+
+//Allocate, touch (one byte per page) and free buffers of 64KB to 4MB, [LiveCount] buffers are kept alive (freed in allocation order)
+//returns the elapsed seconds
+template<typename TAlloc, typename TFree>
+double BenchmarkLargeBuffers(size_t Iterations, TAlloc Alloc, TFree Free) {
+	constexpr size_t Sizes[] = { 64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024, 128 * 1024, 2 * 1024 * 1024 };
+	constexpr size_t LiveCount = 8;
+
+	uint8_t* Live[LiveCount]{ };
+
+	const auto Start = std::chrono::high_resolution_clock::now();
+
+	for (size_t i = 0; i < Iterations; i++) {
+		const size_t Size = Sizes[i % std::size(Sizes)];
+
+		uint8_t*& Slot = Live[i % LiveCount];
+		if (Slot) {
+			Free(Slot);
+		}
+
+		Slot = Alloc(Size);
+		for (size_t Offset = 0; Offset < Size; Offset += MEMEX_PAGE_SIZE) {
+			Slot[Offset] = static_cast<uint8_t>(i);
+		}
+		BenchmarkSink.fetch_add(Slot[Size - 1], std::memory_order_relaxed);
+	}
+
+	for (uint8_t* Buffer : Live) {
+		if (Buffer) {
+			Free(Buffer);
+		}
+	}
+
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - Start).count();
+}
+
+void RunLargeObjectBenchmark() {
+	constexpr size_t Iterations = 20000;
+
+	const double OSSeconds = BenchmarkLargeBuffers(Iterations,
+		[](size_t Size) { return reinterpret_cast<uint8_t*>(GAllocate(Size, MEMEX_CACHE_LINE_SIZE)); },
+		[](uint8_t* Buffer) { GFree(Buffer); }
+	);
+
+	const double CacheSeconds = BenchmarkLargeBuffers(Iterations,
+		[](size_t Size) { return MemoryManager::AllocBuffer<uint8_t, true>(Size).Release(); },
+		[](uint8_t* Buffer) { MPtr<uint8_t>(Buffer).Reset(); }
+	);
+
+	std::cout << "#Large buffers benchmark (64KB - 4MB):\n";
+	std::cout << "\tGAllocate:\tBuffers/sec:" << static_cast<size_t>(Iterations / OSSeconds) << "\n";
+	std::cout << "\tLargeObjectCache:\tBuffers/sec:" << static_cast<size_t>(Iterations / CacheSeconds) << "\tSpeedup:" << OSSeconds / CacheSeconds << "x\n";
+}
+
+struct QueueMessage : IResource<QueueMessage>, MQueueNode {
+	uint64_t Payload[4]{ };
+};
+
+//Queue of MemoryManager nodes guarded by a std::mutex (the pattern replaced by TMPSCQueue/TMPMCQueue)
+class MutexDequeQueue {
+public:
+	bool TryPush(MPtr<QueueMessage>&& Node) noexcept {
+		std::lock_guard<std::mutex> Guard(Lock);
+		Queue.push_back(std::move(Node));
+		return true;
+	}
+
+	MPtr<QueueMessage> TryPop() noexcept {
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (Queue.empty()) {
+			return { };
+		}
+
+		MPtr<QueueMessage> Node = std::move(Queue.front());
+		Queue.pop_front();
+		return Node;
+	}
+
+private:
+	std::mutex						Lock;
+	std::deque<MPtr<QueueMessage>>	Queue;
+};
+
+//[ProducersCount] threads allocate and push [Iterations] messages each, [ConsumersCount] threads pop and free them
+//returns messages/sec
+template<typename TPush, typename TPop>
+double BenchmarkQueue(size_t ProducersCount, size_t ConsumersCount, size_t Iterations, TPush Push, TPop Pop) {
+	const size_t Total = ProducersCount * Iterations;
+	std::atomic<size_t> Received{ 0 };
+	std::atomic<size_t> ThreadIndex{ 0 };
+
+	const double Seconds = RunOnThreads(ProducersCount + ConsumersCount, [&]() {
+		if (ThreadIndex.fetch_add(1, std::memory_order_relaxed) < ProducersCount) {
+			for (size_t i = 0; i < Iterations; i++) {
+				MPtr<QueueMessage> Message = QueueMessage::New();
+				Message->Payload[0] = i;
+
+				while (!Push(std::move(Message))) {
+					std::this_thread::yield();
+				}
+			}
+			return;
+		}
+
+		while (Received.load(std::memory_order_relaxed) < Total) {
+			MPtr<QueueMessage> Message = Pop();
+			if (Message.IsNull()) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			BenchmarkSink.fetch_add(Message->Payload[0], std::memory_order_relaxed);
+			Received.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	return static_cast<double>(Total) / Seconds;
+}
+
+void RunQueueBenchmark() {
+	constexpr size_t Iterations = 200000;
+
+	const size_t MaxThreads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const size_t ProducersCount = MaxThreads > 2 ? MaxThreads / 2 : 1;
+
+	std::cout << "#Queue benchmark (" << ProducersCount << " producers):\n";
+
+	{
+		MutexDequeQueue* Baseline = new MutexDequeQueue();
+		TMPSCQueue<QueueMessage>* Queue = new TMPSCQueue<QueueMessage>();
+
+		const double BaselineRate = BenchmarkQueue(ProducersCount, 1, Iterations,
+			[Baseline](MPtr<QueueMessage>&& Node) { return Baseline->TryPush(std::move(Node)); },
+			[Baseline]() { return Baseline->TryPop(); }
+		);
+		const double Rate = BenchmarkQueue(ProducersCount, 1, Iterations,
+			[Queue](MPtr<QueueMessage>&& Node) { Queue->Push(std::move(Node)); return true; },
+			[Queue]() { return Queue->Pop(); }
+		);
+
+		std::cout << "\t1 consumer:\tstd::mutex+std::deque Messages/sec:" << static_cast<size_t>(BaselineRate)
+			<< "\tTMPSCQueue Messages/sec:" << static_cast<size_t>(Rate) << "\tSpeedup:" << Rate / BaselineRate << "x\n";
+
+		delete Baseline;
+		delete Queue;
+	}
+
+	{
+		MutexDequeQueue* Baseline = new MutexDequeQueue();
+		TMPMCQueue<QueueMessage, 4096>* Queue = new TMPMCQueue<QueueMessage, 4096>();
+
+		const double BaselineRate = BenchmarkQueue(ProducersCount, ProducersCount, Iterations,
+			[Baseline](MPtr<QueueMessage>&& Node) { return Baseline->TryPush(std::move(Node)); },
+			[Baseline]() { return Baseline->TryPop(); }
+		);
+		const double Rate = BenchmarkQueue(ProducersCount, ProducersCount, Iterations,
+			[Queue](MPtr<QueueMessage>&& Node) { return Queue->TryPush(std::move(Node)); },
+			[Queue]() { return Queue->TryPop(); }
+		);
+
+		std::cout << "\t" << ProducersCount << " consumers:\tstd::mutex+std::deque Messages/sec:" << static_cast<size_t>(BaselineRate)
+			<< "\tTMPMCQueue Messages/sec:" << static_cast<size_t>(Rate) << "\tSpeedup:" << Rate / BaselineRate << "x\n";
+
+		delete Baseline;
+		delete Queue;
+	}
+}
+
+//Read the first payload field of [Count] live blocks [Passes] times, returns the elapsed seconds and the cache misses
+template<typename TPool>
+double BenchmarkColoring(size_t Count, size_t Passes, uint64_t& OutCacheMisses) {
+	using TBlock = typename TPool::PoolTraits::MyPoolType;
+
+	TPool* Pool = new TPool();
+	Pool->Preallocate();
+
+	TBlock** Live = new TBlock*[Count];
+	for (size_t i = 0; i < Count; i++) {
+		Live[i] = new (Pool->AllocateRaw()) TBlock(sizeof(uint64_t));
+		*reinterpret_cast<uint64_t*>(Live[i]->FixedSizeBlock) = i;
+	}
+
+	CacheMissCounter Counter;
+	uint64_t Sum = 0;
+
+	const auto Start = std::chrono::steady_clock::now();
+	Counter.Start();
+
+	for (size_t Pass = 0; Pass < Passes; Pass++) {
+		for (size_t i = 0; i < Count; i++) {
+			Sum += *reinterpret_cast<const uint64_t*>(Live[i]->FixedSizeBlock);
+		}
+	}
+
+	OutCacheMisses = Counter.Stop();
+	const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+	BenchmarkSink.fetch_add(Sum, std::memory_order_relaxed);
+
+	for (size_t i = 0; i < Count; i++) {
+		Pool->DeallocateRaw(Live[i]);
+	}
+
+	delete[] Live;
+	Pool->Release();
+	delete Pool;
+
+	return Elapsed.count();
+}
+
+void RunColoringBenchmark() {
+	constexpr size_t Count = 512;
+	constexpr size_t Passes = 20000;
+
+	using PlainPool = TObjectPoolInstance<MemoryManager::LargeBlock, Count, true, 1, true, 1>;
+	using ColoredPool = TObjectPoolInstance<MemoryManager::LargeBlock, Count, true, 1, true, PoolCacheColorsCount>;
+
+	uint64_t PlainMisses = 0;
+	uint64_t ColoredMisses = 0;
+	const double PlainSeconds = BenchmarkColoring<PlainPool>(Count, Passes, PlainMisses);
+	const double ColoredSeconds = BenchmarkColoring<ColoredPool>(Count, Passes, ColoredMisses);
+
+	std::cout << "#Cache coloring benchmark (" << Count << " live blocks of " << sizeof(MemoryManager::LargeBlock) << " bytes):\n";
+	std::cout << "\t1 color:\tReads/sec:" << static_cast<size_t>(Count * Passes / PlainSeconds);
+	if (CacheMissCounter().IsAvailable()) {
+		std::cout << "\tCacheMisses:" << PlainMisses;
+	}
+	std::cout << "\n\t" << PoolCacheColorsCount << " colors:\tReads/sec:" << static_cast<size_t>(Count * Passes / ColoredSeconds);
+	if (CacheMissCounter().IsAvailable()) {
+		std::cout << "\tCacheMisses:" << ColoredMisses;
+	}
+	std::cout << "\n";
+}
+
+int main(int argc, const char** argv)
+{
+	if (MemoryManager::Initialize()) {
+		std::cout << "MemoryManager::Initialize() -> Failed";
+		return 1;
+	}
+
+	RunAllocationBenchmark();
+	RunCoroutineBenchmark();
+	RunReuseOrderBenchmark();
+	RunLargeObjectBenchmark();
+	RunQueueBenchmark();
+	RunColoringBenchmark();
+
+	return 0;
+}
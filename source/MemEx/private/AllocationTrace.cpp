@@ -0,0 +1,184 @@
+#include "../public/MemEx.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace MemEx {
+	//Events of a thread not yet copied into the trace file
+	struct alignas(MEMEX_CACHE_LINE_SIZE) ThreadTraceBuffer {
+		SpinLock				Lock;
+		uint32_t				Count{ 0 };
+		uint16_t				ThreadIndex{ 0 };
+		std::atomic<bool>		bInUse{ true };
+		ThreadTraceBuffer*		Next{ nullptr };
+		TraceEvent				Events[TraceBufferEventsCount];
+	};
+
+	//Buffers are never freed, the buffer of an exited thread is taken over by the next new thread
+	static std::atomic<ThreadTraceBuffer*>		GBuffersHead{ nullptr };
+	static std::atomic<uint16_t>				GNextThreadIndex{ 0 };
+	static thread_local ThreadTraceBuffer*		GLocalBuffer{ nullptr };
+	static thread_local bool					bBufferOwnerDestroyed{ false };
+
+	//Guards the trace file
+	static SpinLock								GTraceLock;
+	static MappedRegion							GTraceRegion;
+	static TraceFileHeader*						GTraceHeader{ nullptr };
+	static std::chrono::steady_clock::time_point	GTraceStart;
+
+	//Copy the events of [Buffer] into the trace file, the caller holds the buffer lock
+	static void FlushBuffer(ThreadTraceBuffer& Buffer) noexcept {
+		if (!Buffer.Count) {
+			return;
+		}
+
+		SpinLockScopeGuard Guard(&GTraceLock);
+
+		if (GTraceHeader) {
+			const uint64_t Free = GTraceHeader->Capacity - GTraceHeader->EventsCount;
+			const uint64_t Count = Buffer.Count < Free ? Buffer.Count : Free;
+
+			TraceEvent* Events = reinterpret_cast<TraceEvent*>(GTraceHeader + 1);
+			memcpy(Events + GTraceHeader->EventsCount, Buffer.Events, sizeof(TraceEvent) * Count);
+
+			GTraceHeader->EventsCount += Count;
+			GTraceHeader->DroppedEventsCount += Buffer.Count - Count;
+		}
+
+		Buffer.Count = 0;
+	}
+
+	//Flushes and releases the buffer of the thread on exit
+	struct ThreadTraceBufferOwner {
+		~ThreadTraceBufferOwner() noexcept {
+			if (GLocalBuffer) {
+				{
+					SpinLockScopeGuard Guard(&GLocalBuffer->Lock);
+					FlushBuffer(*GLocalBuffer);
+				}
+
+				GLocalBuffer->bInUse.store(false, std::memory_order_release);
+				GLocalBuffer = nullptr;
+			}
+
+			bBufferOwnerDestroyed = true;
+		}
+	};
+
+	static ThreadTraceBuffer* AcquireThreadBuffer() noexcept {
+		//Events recorded by thread_local destructors after the owner is gone are dropped
+		if (bBufferOwnerDestroyed) {
+			return nullptr;
+		}
+
+		ThreadTraceBuffer* Buffer = nullptr;
+
+		for (ThreadTraceBuffer* It = GBuffersHead.load(std::memory_order_acquire); It; It = It->Next) {
+			bool bExpected = false;
+			if (!It->bInUse.load(std::memory_order_relaxed) && It->bInUse.compare_exchange_strong(bExpected, true, std::memory_order_acquire)) {
+				Buffer = It;
+				break;
+			}
+		}
+
+		if (!Buffer) {
+			ptr_t Memory = GAllocate(sizeof(ThreadTraceBuffer), alignof(ThreadTraceBuffer));
+			if (!Memory) {
+				return nullptr;
+			}
+
+			Buffer = new (Memory) ThreadTraceBuffer();
+
+			Buffer->Next = GBuffersHead.load(std::memory_order_relaxed);
+			while (!GBuffersHead.compare_exchange_weak(Buffer->Next, Buffer, std::memory_order_release, std::memory_order_relaxed)) {}
+		}
+
+		Buffer->ThreadIndex = GNextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+
+		static thread_local ThreadTraceBufferOwner Owner;
+		(void)Owner;
+
+		GLocalBuffer = Buffer;
+
+		return Buffer;
+	}
+
+	bool AllocationTrace::Start(const char* Path, size_t MaxEvents) noexcept {
+		{
+			SpinLockScopeGuard Guard(&GTraceLock);
+
+			if (GTraceHeader || !MaxEvents) {
+				return false;
+			}
+
+			//MapFile maps an existing file whole, start from an empty file
+			std::remove(Path);
+
+			bool bCreated = false;
+			if (!GTraceRegion.MapFile(Path, sizeof(TraceFileHeader) + (sizeof(TraceEvent) * MaxEvents), nullptr, bCreated) || !bCreated) {
+				GTraceRegion.Unmap();
+				return false;
+			}
+
+			GTraceHeader = new (GTraceRegion.GetBase()) TraceFileHeader();
+			GTraceHeader->Magic = TraceMagic;
+			GTraceHeader->Version = TraceVersion;
+			GTraceHeader->EventSize = sizeof(TraceEvent);
+			GTraceHeader->Capacity = MaxEvents;
+			GTraceHeader->TimestampFrequency = 1000000000ULL;
+
+			GTraceStart = std::chrono::steady_clock::now();
+		}
+
+		//Discard the events left in the buffers by a previous recording
+		for (ThreadTraceBuffer* It = GBuffersHead.load(std::memory_order_acquire); It; It = It->Next) {
+			SpinLockScopeGuard Guard(&It->Lock);
+			It->Count = 0;
+		}
+
+		bRecording.store(true, std::memory_order_release);
+
+		return true;
+	}
+
+	void AllocationTrace::Stop() noexcept {
+		bRecording.store(false, std::memory_order_release);
+
+		for (ThreadTraceBuffer* It = GBuffersHead.load(std::memory_order_acquire); It; It = It->Next) {
+			SpinLockScopeGuard Guard(&It->Lock);
+			FlushBuffer(*It);
+		}
+
+		SpinLockScopeGuard Guard(&GTraceLock);
+
+		if (GTraceHeader) {
+			GTraceRegion.Flush();
+			GTraceRegion.Unmap();
+			GTraceHeader = nullptr;
+		}
+	}
+
+	void AllocationTrace::Record(ETraceEventType Type, uint64_t BlockId, size_t Tier, size_t Size) noexcept {
+		ThreadTraceBuffer* Buffer = GLocalBuffer ? GLocalBuffer : AcquireThreadBuffer();
+		if (!Buffer) {
+			return;
+		}
+
+		const uint64_t Timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - GTraceStart).count());
+
+		SpinLockScopeGuard Guard(&Buffer->Lock);
+
+		TraceEvent& Event = Buffer->Events[Buffer->Count++];
+		Event.Timestamp = Timestamp;
+		Event.BlockId = BlockId;
+		Event.Size = Size < UINT32_MAX ? static_cast<uint32_t>(Size) : UINT32_MAX;
+		Event.ThreadIndex = Buffer->ThreadIndex;
+		Event.Tier = static_cast<uint8_t>(Tier);
+		Event.Type = Type;
+
+		if (Buffer->Count == TraceBufferEventsCount) {
+			FlushBuffer(*Buffer);
+		}
+	}
+}
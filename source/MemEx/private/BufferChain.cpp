@@ -0,0 +1,22 @@
+#include "../public/MemEx.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <WinSock2.h>
+#else
+#include <sys/uio.h>
+#endif
+
+#include <cstddef>
+
+namespace MemEx {
+#ifdef _WIN32
+	static_assert(sizeof(MIOVec) == sizeof(WSABUF), "MIOVec must be layout compatible with WSABUF");
+	static_assert(offsetof(MIOVec, Base) == offsetof(WSABUF, buf), "MIOVec must be layout compatible with WSABUF");
+	static_assert(offsetof(MIOVec, Length) == offsetof(WSABUF, len), "MIOVec must be layout compatible with WSABUF");
+#else
+	static_assert(sizeof(MIOVec) == sizeof(iovec), "MIOVec must be layout compatible with iovec");
+	static_assert(offsetof(MIOVec, Base) == offsetof(iovec, iov_base), "MIOVec must be layout compatible with iovec");
+	static_assert(offsetof(MIOVec, Length) == offsetof(iovec, iov_len), "MIOVec must be layout compatible with iovec");
+#endif
+}
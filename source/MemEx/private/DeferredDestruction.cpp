@@ -0,0 +1,233 @@
+#include "../public/MemEx.h"
+
+#include <mutex>
+#include <thread>
+
+namespace MemEx {
+	//Bounded MPMC queue of blocks (per cell sequence numbers, see D. Vyukov's bounded MPMC queue)
+	class DeferredQueue {
+	public:
+		static constexpr size_t Capacity = DeferredQueueSize;
+		static constexpr size_t Mask = Capacity - 1;
+
+		static_assert(IsPowerOf2(Capacity), "DeferredQueueSize must be a power of 2");
+
+		DeferredQueue() noexcept {
+			for (size_t i = 0; i < Capacity; i++) {
+				Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		bool Push(IMemoryBlock* BlockObject) noexcept {
+			size_t Position = EnqueuePosition.load(std::memory_order_relaxed);
+
+			for (;;) {
+				//Backpressure
+				if (Position - DequeuePosition.load(std::memory_order_relaxed) >= MaxDepth.load(std::memory_order_relaxed)) {
+					return false;
+				}
+
+				Cell& TargetCell = Cells[Position & Mask];
+				const size_t Sequence = TargetCell.Sequence.load(std::memory_order_acquire);
+				const intptr_t Diff = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position);
+
+				if (Diff == 0) {
+					if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) {
+						TargetCell.BlockObject = BlockObject;
+						TargetCell.Sequence.store(Position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (Diff < 0) {
+					//Full
+					return false;
+				}
+				else {
+					Position = EnqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		IMemoryBlock* Pop() noexcept {
+			size_t Position = DequeuePosition.load(std::memory_order_relaxed);
+
+			for (;;) {
+				Cell& TargetCell = Cells[Position & Mask];
+				const size_t Sequence = TargetCell.Sequence.load(std::memory_order_acquire);
+				const intptr_t Diff = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position + 1);
+
+				if (Diff == 0) {
+					if (DequeuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) {
+						IMemoryBlock* BlockObject = TargetCell.BlockObject;
+						TargetCell.Sequence.store(Position + Capacity, std::memory_order_release);
+						return BlockObject;
+					}
+				}
+				else if (Diff < 0) {
+					//Empty
+					return nullptr;
+				}
+				else {
+					Position = DequeuePosition.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		FORCEINLINE size_t GetDepth() const noexcept {
+			const size_t Dequeued = DequeuePosition.load(std::memory_order_relaxed);
+			const size_t Enqueued = EnqueuePosition.load(std::memory_order_relaxed);
+
+			return Enqueued > Dequeued ? Enqueued - Dequeued : 0;
+		}
+
+		struct Cell {
+			std::atomic<size_t>	Sequence{ 0 };
+			IMemoryBlock*		BlockObject{ nullptr };
+		};
+
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>	EnqueuePosition{ 0 };
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>	DequeuePosition{ 0 };
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>	MaxDepth{ Capacity };
+
+		std::atomic<size_t>									HighWatermark{ 0 };
+		std::atomic<size_t>									TotalDeferred{ 0 };
+		std::atomic<size_t>									TotalDrained{ 0 };
+		std::atomic<size_t>									TotalInlineDestroys{ 0 };
+
+		//Reclaimer thread state
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<uint32_t>	WakeSignal{ 0 };
+		std::atomic<bool>										bReclaimerWaiting{ false };
+		std::atomic<bool>										bStopReclaimer{ false };
+		std::thread												Reclaimer;
+		std::mutex												ReclaimerLock;
+
+		alignas(MEMEX_CACHE_LINE_SIZE) Cell						Cells[Capacity];
+	};
+
+	static DeferredQueue GDeferredQueue;
+
+	static void WakeReclaimer() noexcept {
+		//Pairs with the fence in ReclaimerMain, either the reclaimer sees the new block or we see it waiting
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (GDeferredQueue.bReclaimerWaiting.load(std::memory_order_relaxed)) {
+			GDeferredQueue.WakeSignal.fetch_add(1, std::memory_order_release);
+			GDeferredQueue.WakeSignal.notify_one();
+		}
+	}
+
+	static void ReclaimerMain() noexcept {
+		while (!GDeferredQueue.bStopReclaimer.load(std::memory_order_acquire)) {
+			if (DeferredDestruction::Drain()) {
+				continue;
+			}
+
+			const uint32_t Signal = GDeferredQueue.WakeSignal.load(std::memory_order_acquire);
+			GDeferredQueue.bReclaimerWaiting.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (!GDeferredQueue.GetDepth() && !GDeferredQueue.bStopReclaimer.load(std::memory_order_acquire)) {
+				GDeferredQueue.WakeSignal.wait(Signal, std::memory_order_acquire);
+			}
+
+			GDeferredQueue.bReclaimerWaiting.store(false, std::memory_order_relaxed);
+		}
+
+		DeferredDestruction::Drain();
+	}
+
+	bool DeferredDestruction::Enqueue(IMemoryBlock* BlockObject) noexcept {
+		if (!GDeferredQueue.Push(BlockObject)) {
+			GDeferredQueue.TotalInlineDestroys.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		GDeferredQueue.TotalDeferred.fetch_add(1, std::memory_order_relaxed);
+
+		const size_t Depth = GDeferredQueue.GetDepth();
+		size_t HighWatermark = GDeferredQueue.HighWatermark.load(std::memory_order_relaxed);
+		while (Depth > HighWatermark && !GDeferredQueue.HighWatermark.compare_exchange_weak(HighWatermark, Depth, std::memory_order_relaxed)) {}
+
+		WakeReclaimer();
+
+		return true;
+	}
+
+	size_t DeferredDestruction::Drain(size_t MaxCount) noexcept {
+		//Blocks released by the destructors are destroyed inline, not queued again
+		DeferredDestroyScope Scope(false);
+
+		size_t Count = 0;
+		while (Count < MaxCount) {
+			IMemoryBlock* BlockObject = GDeferredQueue.Pop();
+			if (!BlockObject) {
+				break;
+			}
+
+			BlockObject->Destroy(BlockObject, true);
+			Count++;
+		}
+
+		if (Count) {
+			GDeferredQueue.TotalDrained.fetch_add(Count, std::memory_order_relaxed);
+		}
+
+		return Count;
+	}
+
+	bool DeferredDestruction::StartReclaimer() noexcept {
+		std::lock_guard<std::mutex> Guard(GDeferredQueue.ReclaimerLock);
+
+		if (GDeferredQueue.Reclaimer.joinable()) {
+			return true;
+		}
+
+		GDeferredQueue.bStopReclaimer.store(false, std::memory_order_release);
+
+		try {
+			GDeferredQueue.Reclaimer = std::thread(ReclaimerMain);
+		}
+		catch (...) {
+			return false;
+		}
+
+		return true;
+	}
+
+	void DeferredDestruction::StopReclaimer() noexcept {
+		std::lock_guard<std::mutex> Guard(GDeferredQueue.ReclaimerLock);
+
+		if (!GDeferredQueue.Reclaimer.joinable()) {
+			return;
+		}
+
+		GDeferredQueue.bStopReclaimer.store(true, std::memory_order_release);
+		GDeferredQueue.WakeSignal.fetch_add(1, std::memory_order_release);
+		GDeferredQueue.WakeSignal.notify_one();
+
+		GDeferredQueue.Reclaimer.join();
+	}
+
+	void DeferredDestruction::SetMaxDepth(size_t MaxDepth) noexcept {
+		if (MaxDepth < 1) {
+			MaxDepth = 1;
+		}
+		else if (MaxDepth > DeferredQueue::Capacity) {
+			MaxDepth = DeferredQueue::Capacity;
+		}
+
+		GDeferredQueue.MaxDepth.store(MaxDepth, std::memory_order_relaxed);
+	}
+
+	DeferredDestruction::Statistics DeferredDestruction::GetStatistics() noexcept {
+		Statistics Result;
+
+		Result.Depth = GDeferredQueue.GetDepth();
+		Result.MaxDepth = GDeferredQueue.HighWatermark.load(std::memory_order_relaxed);
+		Result.TotalDeferred = GDeferredQueue.TotalDeferred.load(std::memory_order_relaxed);
+		Result.TotalDrained = GDeferredQueue.TotalDrained.load(std::memory_order_relaxed);
+		Result.TotalInlineDestroys = GDeferredQueue.TotalInlineDestroys.load(std::memory_order_relaxed);
+
+		return Result;
+	}
+}
@@ -0,0 +1,432 @@
+#include "../public/MemEx.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <DbgHelp.h>
+#pragma comment(lib, "Dbghelp.lib")
+#else
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+namespace MemEx {
+	//Samples of one call stack, the counts and bytes are raw (not scaled by the sampling probability)
+	struct ProfileStack {
+		uint64_t	Hash{ 0 };
+		uint32_t	Depth{ 0 };			//0 if the slot is empty
+		uint64_t	AllocCount{ 0 };
+		uint64_t	AllocBytes{ 0 };
+		uint64_t	LiveCount{ 0 };
+		uint64_t	LiveBytes{ 0 };
+		ptr_t		Frames[HeapProfilerMaxFrames]{ };	//Innermost first
+	};
+
+	//Sampled block not yet freed
+	struct ProfileSample {
+		const IMemoryBlock*	Block{ nullptr };	//nullptr if the slot is empty
+		uint64_t			Size{ 0 };
+		uint32_t			StackIndex{ 0 };
+	};
+
+	//Both tables are open addressed with linear probing, allocated by the first Start and never freed
+	static SpinLock					GProfileLock;
+	static ProfileSample*			GSamples{ nullptr };
+	static ProfileStack*			GStacks{ nullptr };
+	static size_t					GSamplesCount{ 0 };
+	static size_t					GStacksCount{ 0 };
+	static size_t					GSampledCount{ 0 };
+	static size_t					GDroppedCount{ 0 };
+	static std::atomic<size_t>		GSamplingInterval{ HeapProfilerSamplingInterval };
+
+	//Set while the thread is taking a sample, allocations made by the stack capture are not sampled
+	static thread_local bool		bInSample{ false };
+
+	//Frames of the profiler itself (capture, SampleAllocation)
+	constexpr int SkippedFramesCount = 2;
+
+	static size_t HashBlock(const IMemoryBlock* Block) noexcept {
+		return static_cast<size_t>((reinterpret_cast<uint64_t>(Block) >> 6) * 0x9E3779B97F4A7C15ULL >> 20) & (HeapProfilerMaxSamples - 1);
+	}
+
+	static uint64_t HashFrames(ptr_t const* Frames, uint32_t Depth) noexcept {
+		//FNV-1a over the frame addresses
+		uint64_t Hash = 0xCBF29CE484222325ULL;
+		for (uint32_t i = 0; i < Depth; i++) {
+			Hash = (Hash ^ reinterpret_cast<uint64_t>(Frames[i])) * 0x100000001B3ULL;
+		}
+
+		return Hash;
+	}
+
+	//Geometric distribution of mean [Interval], the bytes between two samples
+	static int64_t NextSampleInterval(size_t Interval) noexcept {
+		static thread_local uint64_t State = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uint64_t>(&State);
+
+		//xorshift64
+		State ^= State << 13;
+		State ^= State >> 7;
+		State ^= State << 17;
+
+		//Uniform in (0, 1]
+		const double Uniform = (static_cast<double>(State >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+
+		return static_cast<int64_t>(-std::log(Uniform) * static_cast<double>(Interval)) + 1;
+	}
+
+	static uint32_t CaptureStack(ptr_t* OutFrames) noexcept {
+#ifdef _WIN32
+		return CaptureStackBackTrace(SkippedFramesCount, HeapProfilerMaxFrames, OutFrames, nullptr);
+#else
+		ptr_t Frames[HeapProfilerMaxFrames + SkippedFramesCount];
+		const int Depth = backtrace(Frames, HeapProfilerMaxFrames + SkippedFramesCount);
+		if (Depth <= SkippedFramesCount) {
+			return 0;
+		}
+
+		memcpy(OutFrames, Frames + SkippedFramesCount, sizeof(ptr_t) * (Depth - SkippedFramesCount));
+
+		return static_cast<uint32_t>(Depth - SkippedFramesCount);
+#endif
+	}
+
+	//Find or insert the stack [Frames], SIZE_MAX if the table is full, the caller holds GProfileLock
+	static size_t FindStack(ptr_t const* Frames, uint32_t Depth) noexcept {
+		const uint64_t Hash = HashFrames(Frames, Depth);
+
+		for (size_t Index = Hash & (HeapProfilerMaxStacks - 1);; Index = (Index + 1) & (HeapProfilerMaxStacks - 1)) {
+			ProfileStack& Stack = GStacks[Index];
+
+			if (!Stack.Depth) {
+				//Keep the table at most 3/4 full
+				if (GStacksCount >= (HeapProfilerMaxStacks / 4) * 3) {
+					return SIZE_MAX;
+				}
+
+				Stack.Hash = Hash;
+				Stack.Depth = Depth;
+				memcpy(Stack.Frames, Frames, sizeof(ptr_t) * Depth);
+				GStacksCount++;
+
+				return Index;
+			}
+
+			if (Stack.Hash == Hash && Stack.Depth == Depth && memcmp(Stack.Frames, Frames, sizeof(ptr_t) * Depth) == 0) {
+				return Index;
+			}
+		}
+	}
+
+	bool HeapProfiler::Start(size_t SamplingInterval) noexcept {
+		SpinLockScopeGuard Guard(&GProfileLock);
+
+		if (!GSamples) {
+			GSamples = reinterpret_cast<ProfileSample*>(GAllocate(sizeof(ProfileSample) * HeapProfilerMaxSamples, alignof(ProfileSample)));
+			GStacks = reinterpret_cast<ProfileStack*>(GAllocate(sizeof(ProfileStack) * HeapProfilerMaxStacks, alignof(ProfileStack)));
+
+			if (!GSamples || !GStacks) {
+				GFree(GSamples);
+				GFree(GStacks);
+				GSamples = nullptr;
+				GStacks = nullptr;
+				return false;
+			}
+		}
+
+		//Blocks sampled by a previous run are no longer found, their frees are ignored
+		for (size_t i = 0; i < HeapProfilerMaxSamples; i++) {
+			new (GSamples + i) ProfileSample();
+		}
+		for (size_t i = 0; i < HeapProfilerMaxStacks; i++) {
+			new (GStacks + i) ProfileStack();
+		}
+
+		GSamplesCount = 0;
+		GStacksCount = 0;
+		GSampledCount = 0;
+		GDroppedCount = 0;
+
+		GSamplingInterval.store(SamplingInterval ? SamplingInterval : 1, std::memory_order_relaxed);
+		bEnabled.store(true, std::memory_order_release);
+
+		return true;
+	}
+
+	void HeapProfiler::Stop() noexcept {
+		bEnabled.store(false, std::memory_order_release);
+	}
+
+	void HeapProfiler::SampleAllocation(IMemoryBlock* BlockObject, size_t Size) noexcept {
+		const size_t Interval = GSamplingInterval.load(std::memory_order_relaxed);
+
+		//While disabled the threads only come here once per interval
+		if (!IsEnabled()) {
+			BytesUntilSample = static_cast<int64_t>(Interval);
+			return;
+		}
+
+		BytesUntilSample = NextSampleInterval(Interval);
+
+		if (bInSample) {
+			return;
+		}
+
+		bInSample = true;
+
+		ptr_t Frames[HeapProfilerMaxFrames];
+		const uint32_t Depth = CaptureStack(Frames);
+
+		bInSample = false;
+
+		if (!Depth) {
+			return;
+		}
+
+		SpinLockScopeGuard Guard(&GProfileLock);
+
+		if (!GSamples) {
+			return;
+		}
+
+		const size_t StackIndex = GSamplesCount < (HeapProfilerMaxSamples / 4) * 3 ? FindStack(Frames, Depth) : SIZE_MAX;
+		if (StackIndex == SIZE_MAX) {
+			GDroppedCount++;
+			return;
+		}
+
+		size_t Index = HashBlock(BlockObject);
+		while (GSamples[Index].Block) {
+			Index = (Index + 1) & (HeapProfilerMaxSamples - 1);
+		}
+
+		GSamples[Index].Block = BlockObject;
+		GSamples[Index].Size = Size;
+		GSamples[Index].StackIndex = static_cast<uint32_t>(StackIndex);
+		GSamplesCount++;
+		GSampledCount++;
+
+		ProfileStack& Stack = GStacks[StackIndex];
+		Stack.AllocCount++;
+		Stack.AllocBytes += Size;
+		Stack.LiveCount++;
+		Stack.LiveBytes += Size;
+
+		BlockObject->bSampled = true;
+	}
+
+	void HeapProfiler::RemoveSample(const IMemoryBlock* BlockObject) noexcept {
+		SpinLockScopeGuard Guard(&GProfileLock);
+
+		if (!GSamples) {
+			return;
+		}
+
+		size_t Hole = HashBlock(BlockObject);
+		for (; GSamples[Hole].Block != BlockObject; Hole = (Hole + 1) & (HeapProfilerMaxSamples - 1)) {
+			//Sampled before the last Start
+			if (!GSamples[Hole].Block) {
+				return;
+			}
+		}
+
+		ProfileStack& Stack = GStacks[GSamples[Hole].StackIndex];
+		Stack.LiveCount--;
+		Stack.LiveBytes -= GSamples[Hole].Size;
+		GSamplesCount--;
+
+		//Backward shift deletion, move back the entries that would not be found past the hole
+		for (size_t Next = (Hole + 1) & (HeapProfilerMaxSamples - 1); GSamples[Next].Block; Next = (Next + 1) & (HeapProfilerMaxSamples - 1)) {
+			const size_t Home = HashBlock(GSamples[Next].Block);
+
+			if (((Next - Home) & (HeapProfilerMaxSamples - 1)) >= ((Next - Hole) & (HeapProfilerMaxSamples - 1))) {
+				GSamples[Hole] = GSamples[Next];
+				Hole = Next;
+			}
+		}
+
+		GSamples[Hole] = ProfileSample();
+	}
+
+	HeapProfiler::Statistics HeapProfiler::GetStatistics() noexcept {
+		SpinLockScopeGuard Guard(&GProfileLock);
+
+		Statistics Result;
+		Result.SampledAllocations = GSampledCount;
+		Result.LiveSamples = GSamplesCount;
+		Result.DroppedSamples = GDroppedCount;
+		Result.StacksCount = GStacksCount;
+
+		return Result;
+	}
+
+	//Copy the recorded stacks, the files are written without holding GProfileLock
+	static ProfileStack* SnapshotStacks(size_t& OutCount, size_t& OutInterval) noexcept {
+		SpinLockScopeGuard Guard(&GProfileLock);
+
+		OutCount = 0;
+		OutInterval = GSamplingInterval.load(std::memory_order_relaxed);
+
+		if (!GStacks) {
+			return nullptr;
+		}
+
+		ProfileStack* Snapshot = reinterpret_cast<ProfileStack*>(GAllocate(sizeof(ProfileStack) * (GStacksCount ? GStacksCount : 1), alignof(ProfileStack)));
+		if (!Snapshot) {
+			return nullptr;
+		}
+
+		for (size_t i = 0; i < HeapProfilerMaxStacks; i++) {
+			if (GStacks[i].Depth) {
+				Snapshot[OutCount++] = GStacks[i];
+			}
+		}
+
+		return Snapshot;
+	}
+
+	//Estimated bytes represented by [Count] samples of [Bytes] total (the probability to sample an allocation of
+	//Size bytes is 1 - exp(-Size / Interval), same unsampling as pprof)
+	static double UnsampleBytes(uint64_t Count, uint64_t Bytes, size_t Interval) noexcept {
+		if (!Count) {
+			return 0.0;
+		}
+
+		const double AverageSize = static_cast<double>(Bytes) / static_cast<double>(Count);
+		const double Probability = 1.0 - std::exp(-AverageSize / static_cast<double>(Interval));
+
+		return Probability > 0.0 ? static_cast<double>(Bytes) / Probability : static_cast<double>(Bytes);
+	}
+
+	static void WriteSymbol(FILE* File, ptr_t Address) noexcept {
+#ifdef _WIN32
+		static bool bSymbolsInitialized = SymInitialize(GetCurrentProcess(), nullptr, TRUE) != FALSE;
+
+		alignas(SYMBOL_INFO) char Buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+		SYMBOL_INFO* Symbol = reinterpret_cast<SYMBOL_INFO*>(Buffer);
+		Symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+		Symbol->MaxNameLen = MAX_SYM_NAME;
+
+		if (bSymbolsInitialized && SymFromAddr(GetCurrentProcess(), reinterpret_cast<DWORD64>(Address), nullptr, Symbol)) {
+			fprintf(File, "%s", Symbol->Name);
+			return;
+		}
+#else
+		Dl_info Info{ };
+		if (dladdr(Address, &Info) && Info.dli_sname) {
+			int Status = 0;
+			char* Demangled = abi::__cxa_demangle(Info.dli_sname, nullptr, nullptr, &Status);
+
+			fprintf(File, "%s", Status == 0 && Demangled ? Demangled : Info.dli_sname);
+			free(Demangled);
+			return;
+		}
+#endif
+
+		fprintf(File, "%p", Address);
+	}
+
+	bool HeapProfiler::WriteProfile(const char* Path) noexcept {
+		size_t Count = 0;
+		size_t Interval = 0;
+		ProfileStack* Stacks = SnapshotStacks(Count, Interval);
+		if (!Stacks) {
+			return false;
+		}
+
+		FILE* File = fopen(Path, "w");
+		if (!File) {
+			GFree(Stacks);
+			return false;
+		}
+
+		uint64_t LiveCount = 0, LiveBytes = 0, AllocCount = 0, AllocBytes = 0;
+		for (size_t i = 0; i < Count; i++) {
+			LiveCount += Stacks[i].LiveCount;
+			LiveBytes += Stacks[i].LiveBytes;
+			AllocCount += Stacks[i].AllocCount;
+			AllocBytes += Stacks[i].AllocBytes;
+		}
+
+		fprintf(File, "heap profile: %llu: %llu [%llu: %llu] @ heap_v2/%llu\n",
+			(unsigned long long)LiveCount, (unsigned long long)LiveBytes, (unsigned long long)AllocCount, (unsigned long long)AllocBytes, (unsigned long long)Interval);
+
+		for (size_t i = 0; i < Count; i++) {
+			const ProfileStack& Stack = Stacks[i];
+
+			fprintf(File, "%llu: %llu [%llu: %llu] @",
+				(unsigned long long)Stack.LiveCount, (unsigned long long)Stack.LiveBytes, (unsigned long long)Stack.AllocCount, (unsigned long long)Stack.AllocBytes);
+
+			for (uint32_t Frame = 0; Frame < Stack.Depth; Frame++) {
+				fprintf(File, " 0x%llx", (unsigned long long)reinterpret_cast<uint64_t>(Stack.Frames[Frame]));
+			}
+
+			fprintf(File, "\n");
+		}
+
+#ifndef _WIN32
+		//Lets pprof map the addresses back to the binaries
+		FILE* Maps = fopen("/proc/self/maps", "r");
+		if (Maps) {
+			fprintf(File, "\nMAPPED_LIBRARIES:\n");
+
+			char Buffer[4096];
+			size_t ReadCount;
+			while ((ReadCount = fread(Buffer, 1, sizeof(Buffer), Maps)) > 0) {
+				fwrite(Buffer, 1, ReadCount, File);
+			}
+
+			fclose(Maps);
+		}
+#endif
+
+		const bool bSuccess = ferror(File) == 0;
+		fclose(File);
+		GFree(Stacks);
+
+		return bSuccess;
+	}
+
+	bool HeapProfiler::WriteFoldedStacks(const char* Path, bool bLive) noexcept {
+		size_t Count = 0;
+		size_t Interval = 0;
+		ProfileStack* Stacks = SnapshotStacks(Count, Interval);
+		if (!Stacks) {
+			return false;
+		}
+
+		FILE* File = fopen(Path, "w");
+		if (!File) {
+			GFree(Stacks);
+			return false;
+		}
+
+		for (size_t i = 0; i < Count; i++) {
+			const ProfileStack& Stack = Stacks[i];
+
+			const double Bytes = bLive ? UnsampleBytes(Stack.LiveCount, Stack.LiveBytes, Interval) : UnsampleBytes(Stack.AllocCount, Stack.AllocBytes, Interval);
+			if (Bytes < 1.0) {
+				continue;
+			}
+
+			//Outermost frame first
+			for (uint32_t Frame = Stack.Depth; Frame > 0; Frame--) {
+				WriteSymbol(File, Stack.Frames[Frame - 1]);
+				fprintf(File, Frame > 1 ? ";" : " ");
+			}
+
+			fprintf(File, "%llu\n", (unsigned long long)Bytes);
+		}
+
+		const bool bSuccess = ferror(File) == 0;
+		fclose(File);
+		GFree(Stacks);
+
+		return bSuccess;
+	}
+}
@@ -0,0 +1,231 @@
+#include "../public/MemEx.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace MemEx {
+	//Cached span, the low bit is set if the span is known to be zero (spans are page aligned)
+	using CachedSpan = size_t;
+
+	constexpr CachedSpan KnownZeroBit = 1;
+
+	//Cached spans of a size class, [0, DecommittedCount) were returned to the OS, the top is the most recently freed
+	struct alignas(MEMEX_CACHE_LINE_SIZE) SpanBucket {
+		SpinLock	Lock;
+		uint32_t	Count{ 0 };
+		uint32_t	DecommittedCount{ 0 };
+		CachedSpan	Spans[LargeObjectCacheSpansPerBucket]{ };
+	};
+
+	static SpanBucket GSpanBuckets[LargeObjectCache::BucketsCount];
+
+	//Span size of the size class [Index] (see LargeObjectCache::GetBucketIndex)
+	static constexpr size_t GetBucketSpanSize(size_t Index) noexcept {
+		if (Index == 0) {
+			return LargeObjectCache::MinSpanSize;
+		}
+
+		const size_t Log = LargeObjectCache::MinSpanSizeLog + ((Index - 1) / LargeObjectCache::ClassesPerPowerOf2);
+		const size_t SubClass = ((Index - 1) % LargeObjectCache::ClassesPerPowerOf2) + 1;
+
+		return (size_t(1) << Log) + (SubClass * (size_t(1) << (Log - 2)));
+	}
+
+#ifdef _WIN32
+	static ptr_t MapSpan(size_t Size) noexcept {
+		return VirtualAlloc(nullptr, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+
+	static void UnmapSpan(ptr_t Span, size_t Size) noexcept {
+		VirtualFree(Span, 0, MEM_RELEASE);
+	}
+
+	//Return the pages of [Span] to the OS, the address range stays reserved, returns true if the span reads as zero
+	static bool DecommitSpan(ptr_t Span, size_t Size) noexcept {
+#if LargeObjectCacheLazyDecommit
+		VirtualAlloc(Span, Size, MEM_RESET, PAGE_READWRITE);
+		return false;
+#else
+		return VirtualFree(Span, Size, MEM_DECOMMIT) != FALSE;
+#endif
+	}
+
+	//Make the pages of a decommitted span usable again
+	static bool RecommitSpan([[maybe_unused]] ptr_t Span, [[maybe_unused]] size_t Size) noexcept {
+#if LargeObjectCacheLazyDecommit
+		return true;
+#else
+		return VirtualAlloc(Span, Size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#endif
+	}
+#else
+	static ptr_t MapSpan(size_t Size) noexcept {
+		ptr_t Span = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		return Span == MAP_FAILED ? nullptr : Span;
+	}
+
+	static void UnmapSpan(ptr_t Span, size_t Size) noexcept {
+		munmap(Span, Size);
+	}
+
+	//Return the pages of [Span] to the OS, the span stays mapped, returns true if the span reads as zero
+	static bool DecommitSpan(ptr_t Span, size_t Size) noexcept {
+#if LargeObjectCacheLazyDecommit && defined(MADV_FREE)
+		//The pages are reclaimed only under memory pressure, until then they keep their content
+		if (madvise(Span, Size, MADV_FREE) == 0) {
+			return false;
+		}
+#endif
+		//Private anonymous pages read as zero after MADV_DONTNEED
+		return madvise(Span, Size, MADV_DONTNEED) == 0;
+	}
+
+	//Touching a page recommits it
+	static bool RecommitSpan([[maybe_unused]] ptr_t Span, [[maybe_unused]] size_t Size) noexcept {
+		return true;
+	}
+#endif
+
+	//Decommit [Span] in place
+	static void DecommitCachedSpan(CachedSpan& Span, size_t Size) noexcept {
+		if (DecommitSpan(reinterpret_cast<ptr_t>(Span & ~KnownZeroBit), Size)) {
+			Span |= KnownZeroBit;
+		}
+	}
+
+	ptr_t LargeObjectCache::Allocate(size_t Size, bool bZeroed) noexcept {
+		size_t SpanSize = 0;
+		const size_t Index = GetBucketIndex(Size, SpanSize);
+
+		if (Index != SIZE_MAX) {
+			SpanBucket& Bucket = GSpanBuckets[Index];
+			CachedSpan Span = 0;
+			bool bHot = false;
+
+			{
+				SpinLockScopeGuard Guard(&Bucket.Lock);
+
+				if (Bucket.Count) {
+					Span = Bucket.Spans[--Bucket.Count];
+					bHot = Bucket.Count >= Bucket.DecommittedCount;
+
+					if (!bHot) {
+						Bucket.DecommittedCount = Bucket.Count;
+					}
+				}
+			}
+
+			if (Span) {
+				ptr_t SpanPtr = reinterpret_cast<ptr_t>(Span & ~KnownZeroBit);
+
+				CachedBytes.fetch_sub(SpanSize, std::memory_order_relaxed);
+				if (bHot) {
+					HotBytes.fetch_sub(SpanSize, std::memory_order_relaxed);
+				}
+
+				if (bHot || RecommitSpan(SpanPtr, SpanSize)) {
+					Hits.fetch_add(1, std::memory_order_relaxed);
+
+					if (bZeroed) {
+						if (Span & KnownZeroBit) {
+							ZeroFillsSkipped.fetch_add(1, std::memory_order_relaxed);
+						}
+						else {
+							MemZero(SpanPtr, Size);
+						}
+					}
+
+					return SpanPtr;
+				}
+
+				UnmapSpan(SpanPtr, SpanSize);
+				Releases.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		//Fresh pages are zero
+		ptr_t Span = MapSpan(SpanSize);
+		if (Span) {
+			Misses.fetch_add(1, std::memory_order_relaxed);
+
+			if (bZeroed) {
+				ZeroFillsSkipped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		return Span;
+	}
+
+	void LargeObjectCache::Free(ptr_t Span, size_t Size) noexcept {
+		size_t SpanSize = 0;
+		const size_t Index = GetBucketIndex(Size, SpanSize);
+
+		bool bCached = false;
+
+		if (Index != SIZE_MAX && CachedBytes.load(std::memory_order_relaxed) + SpanSize <= MaxCached.load(std::memory_order_relaxed)) {
+			SpanBucket& Bucket = GSpanBuckets[Index];
+
+			SpinLockScopeGuard Guard(&Bucket.Lock);
+
+			if (Bucket.Count < LargeObjectCacheSpansPerBucket) {
+				//The freed span is dirty
+				Bucket.Spans[Bucket.Count++] = reinterpret_cast<CachedSpan>(Span);
+				bCached = true;
+
+				CachedBytes.fetch_add(SpanSize, std::memory_order_relaxed);
+
+				//Over the hot limit return the oldest committed span of the class to the OS
+				//Done under the lock, the span can not be reused while its pages are discarded
+				if (HotBytes.fetch_add(SpanSize, std::memory_order_relaxed) + SpanSize > MaxHot.load(std::memory_order_relaxed)) {
+					DecommitCachedSpan(Bucket.Spans[Bucket.DecommittedCount++], SpanSize);
+
+					HotBytes.fetch_sub(SpanSize, std::memory_order_relaxed);
+					Decommits.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		if (!bCached) {
+			UnmapSpan(Span, SpanSize);
+			Releases.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void LargeObjectCache::Trim(bool bRelease) noexcept {
+		for (size_t Index = 0; Index < BucketsCount; Index++) {
+			SpanBucket& Bucket = GSpanBuckets[Index];
+			const size_t SpanSize = GetBucketSpanSize(Index);
+
+			SpinLockScopeGuard Guard(&Bucket.Lock);
+
+			const size_t HotCount = Bucket.Count - Bucket.DecommittedCount;
+
+			if (bRelease) {
+				for (uint32_t i = 0; i < Bucket.Count; i++) {
+					UnmapSpan(reinterpret_cast<ptr_t>(Bucket.Spans[i] & ~KnownZeroBit), SpanSize);
+				}
+
+				CachedBytes.fetch_sub(SpanSize * Bucket.Count, std::memory_order_relaxed);
+				Releases.fetch_add(Bucket.Count, std::memory_order_relaxed);
+
+				Bucket.Count = 0;
+				Bucket.DecommittedCount = 0;
+			}
+			else {
+				for (uint32_t i = Bucket.DecommittedCount; i < Bucket.Count; i++) {
+					DecommitCachedSpan(Bucket.Spans[i], SpanSize);
+				}
+
+				Decommits.fetch_add(HotCount, std::memory_order_relaxed);
+
+				Bucket.DecommittedCount = Bucket.Count;
+			}
+
+			HotBytes.fetch_sub(SpanSize * HotCount, std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,396 @@
+#include "../public/MemEx.h"
+
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MemEx {
+#ifdef _WIN32
+	bool MappedRegion::MapFile(const char* Path, size_t Size, ptr_t PreferredBase, bool& bOutCreated) noexcept {
+		Unmap();
+
+		HANDLE File = CreateFileA(Path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER FileSize{ };
+		if (!GetFileSizeEx(File, &FileSize)) {
+			CloseHandle(File);
+			return false;
+		}
+
+		bOutCreated = FileSize.QuadPart == 0;
+		if (!bOutCreated) {
+			Size = static_cast<size_t>(FileSize.QuadPart);
+		}
+
+		//The mapping extends the file to [Size] (zero filled)
+		return MapFileView(reinterpret_cast<intptr_t>(File), Size, PreferredBase);
+	}
+
+	bool MappedRegion::MapExistingFile(const char* Path, ptr_t PreferredBase) noexcept {
+		Unmap();
+
+		HANDLE File = CreateFileA(Path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER FileSize{ };
+		if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0) {
+			CloseHandle(File);
+			return false;
+		}
+
+		return MapFileView(reinterpret_cast<intptr_t>(File), static_cast<size_t>(FileSize.QuadPart), PreferredBase);
+	}
+
+	bool MappedRegion::MapFileView(intptr_t FileHandle, size_t Size, ptr_t PreferredBase) noexcept {
+		HANDLE File = reinterpret_cast<HANDLE>(FileHandle);
+
+		HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(Size) >> 32), static_cast<DWORD>(Size), nullptr);
+		if (!Mapping) {
+			CloseHandle(File);
+			return false;
+		}
+
+		ptr_t View = MapViewOfFileEx(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, Size, PreferredBase);
+		if (!View && PreferredBase) {
+			View = MapViewOfFileEx(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, Size, nullptr);
+		}
+
+		if (!View) {
+			CloseHandle(Mapping);
+			CloseHandle(File);
+			return false;
+		}
+
+		Base = reinterpret_cast<uint8_t*>(View);
+		this->Size = Size;
+		this->FileHandle = FileHandle;
+		MappingHandle = reinterpret_cast<intptr_t>(Mapping);
+
+		return true;
+	}
+
+	bool MappedRegion::MakeTempPath(const char* Path, char* OutPath, size_t OutPathSize) noexcept {
+		static std::atomic<uint32_t> Counter{ 0 };
+
+		const int Length = snprintf(OutPath, OutPathSize, "%s.tmp.%lu.%u", Path, static_cast<unsigned long>(GetCurrentProcessId()), Counter.fetch_add(1, std::memory_order_relaxed));
+
+		return Length > 0 && static_cast<size_t>(Length) < OutPathSize;
+	}
+
+	bool MappedRegion::PublishFile(const char* TempPath, const char* Path) noexcept {
+		//Without MOVEFILE_REPLACE_EXISTING the move fails if [Path] exists
+		return MoveFileExA(TempPath, Path, MOVEFILE_WRITE_THROUGH) != FALSE;
+	}
+
+	bool MappedRegion::Flush(size_t Offset, size_t Size) noexcept {
+		if (!Base) {
+			return false;
+		}
+
+		if (!FlushViewOfFile(Base + Offset, Size)) {
+			return false;
+		}
+
+		//Shared memory segments have no file
+		if (FileHandle == -1) {
+			return true;
+		}
+
+		return FlushFileBuffers(reinterpret_cast<HANDLE>(FileHandle)) != FALSE;
+	}
+
+	bool MappedRegion::MapShared(const char* Name, size_t Size, bool& bOutCreated) noexcept {
+		Unmap();
+
+		//Backed by the paging file
+		HANDLE Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(Size) >> 32), static_cast<DWORD>(Size), Name);
+		if (!Mapping) {
+			return false;
+		}
+
+		bOutCreated = GetLastError() != ERROR_ALREADY_EXISTS;
+
+		ptr_t View = MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		if (!View) {
+			CloseHandle(Mapping);
+			return false;
+		}
+
+		if (!bOutCreated) {
+			MEMORY_BASIC_INFORMATION Info{ };
+			if (!VirtualQuery(View, &Info, sizeof(Info))) {
+				UnmapViewOfFile(View);
+				CloseHandle(Mapping);
+				return false;
+			}
+
+			Size = Info.RegionSize;
+		}
+
+		Base = reinterpret_cast<uint8_t*>(View);
+		this->Size = Size;
+		MappingHandle = reinterpret_cast<intptr_t>(Mapping);
+
+		return true;
+	}
+
+	bool MappedRegion::UnlinkShared(const char* Name) noexcept {
+		return true;
+	}
+
+	bool MappedRegion::TryLockShared() noexcept {
+		return false;
+	}
+
+	void MappedRegion::UnlockShared() noexcept {}
+
+	bool MappedRegion::UnlinkSharedIfMapped([[maybe_unused]] const char* Name) noexcept {
+		return false;
+	}
+
+	void MappedRegion::Unmap() noexcept {
+		if (Base) {
+			UnmapViewOfFile(Base);
+			Base = nullptr;
+			Size = 0;
+		}
+
+		if (MappingHandle != -1) {
+			CloseHandle(reinterpret_cast<HANDLE>(MappingHandle));
+			MappingHandle = -1;
+		}
+
+		if (FileHandle != -1) {
+			CloseHandle(reinterpret_cast<HANDLE>(FileHandle));
+			FileHandle = -1;
+		}
+	}
+#else
+	bool MappedRegion::MapFile(const char* Path, size_t Size, ptr_t PreferredBase, bool& bOutCreated) noexcept {
+		Unmap();
+
+		const int File = open(Path, O_RDWR | O_CREAT, 0644);
+		if (File < 0) {
+			return false;
+		}
+
+		struct stat FileStat { };
+		if (fstat(File, &FileStat) != 0) {
+			close(File);
+			return false;
+		}
+
+		bOutCreated = FileStat.st_size == 0;
+		if (bOutCreated) {
+			//Extend the file to [Size] (zero filled)
+			if (ftruncate(File, static_cast<off_t>(Size)) != 0) {
+				close(File);
+				return false;
+			}
+		}
+		else {
+			Size = static_cast<size_t>(FileStat.st_size);
+		}
+
+		return MapFileView(File, Size, PreferredBase);
+	}
+
+	bool MappedRegion::MapExistingFile(const char* Path, ptr_t PreferredBase) noexcept {
+		Unmap();
+
+		const int File = open(Path, O_RDWR);
+		if (File < 0) {
+			return false;
+		}
+
+		struct stat FileStat { };
+		if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0) {
+			close(File);
+			return false;
+		}
+
+		return MapFileView(File, static_cast<size_t>(FileStat.st_size), PreferredBase);
+	}
+
+	bool MappedRegion::MapFileView(intptr_t FileHandle, size_t Size, ptr_t PreferredBase) noexcept {
+		const int File = static_cast<int>(FileHandle);
+
+		ptr_t View = MAP_FAILED;
+
+#ifdef MAP_FIXED_NOREPLACE
+		if (PreferredBase) {
+			View = mmap(PreferredBase, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE, File, 0);
+		}
+#endif
+
+		if (View == MAP_FAILED) {
+			//[PreferredBase] is only a hint here
+			View = mmap(PreferredBase, Size, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+		}
+
+		if (View == MAP_FAILED) {
+			close(File);
+			return false;
+		}
+
+		Base = reinterpret_cast<uint8_t*>(View);
+		this->Size = Size;
+		this->FileHandle = FileHandle;
+
+		return true;
+	}
+
+	bool MappedRegion::MakeTempPath(const char* Path, char* OutPath, size_t OutPathSize) noexcept {
+		static std::atomic<uint32_t> Counter{ 0 };
+
+		const int Length = snprintf(OutPath, OutPathSize, "%s.tmp.%ld.%u", Path, static_cast<long>(getpid()), Counter.fetch_add(1, std::memory_order_relaxed));
+
+		return Length > 0 && static_cast<size_t>(Length) < OutPathSize;
+	}
+
+	bool MappedRegion::PublishFile(const char* TempPath, const char* Path) noexcept {
+		//link() fails if [Path] exists, rename() would replace it
+		if (link(TempPath, Path) != 0) {
+			return false;
+		}
+
+		unlink(TempPath);
+
+		return true;
+	}
+
+	bool MappedRegion::Flush(size_t Offset, size_t Size) noexcept {
+		if (!Base) {
+			return false;
+		}
+
+		//msync requires a page aligned address
+		const size_t PageOffset = Offset & ~(static_cast<size_t>(MEMEX_PAGE_SIZE) - 1);
+
+		return msync(Base + PageOffset, Size + (Offset - PageOffset), MS_SYNC) == 0;
+	}
+
+	bool MappedRegion::MapShared(const char* Name, size_t Size, bool& bOutCreated) noexcept {
+		Unmap();
+
+		int File = shm_open(Name, O_RDWR | O_CREAT | O_EXCL, 0600);
+		bOutCreated = File >= 0;
+
+		if (!bOutCreated) {
+			if (errno != EEXIST) {
+				return false;
+			}
+
+			File = shm_open(Name, O_RDWR, 0600);
+			if (File < 0) {
+				return false;
+			}
+		}
+
+		if (bOutCreated) {
+			//Lock the segment before it is sized, the processes that can map it always find it locked until UnlockShared
+			//The lock is released if this process dies, unsupported locks are ignored (TryLockShared fails)
+			flock(File, LOCK_EX);
+
+			//Extend the segment to [Size] (zero filled)
+			if (ftruncate(File, static_cast<off_t>(Size)) != 0) {
+				close(File);
+				shm_unlink(Name);
+				return false;
+			}
+		}
+		else {
+			struct stat FileStat { };
+
+			//The creator has not sized the segment yet
+			if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0) {
+				close(File);
+				return false;
+			}
+
+			Size = static_cast<size_t>(FileStat.st_size);
+		}
+
+		ptr_t View = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+		if (View == MAP_FAILED) {
+			close(File);
+
+			if (bOutCreated) {
+				shm_unlink(Name);
+			}
+
+			return false;
+		}
+
+		Base = reinterpret_cast<uint8_t*>(View);
+		this->Size = Size;
+		FileHandle = File;
+
+		return true;
+	}
+
+	bool MappedRegion::UnlinkShared(const char* Name) noexcept {
+		return shm_unlink(Name) == 0;
+	}
+
+	bool MappedRegion::TryLockShared() noexcept {
+		return FileHandle != -1 && flock(static_cast<int>(FileHandle), LOCK_EX | LOCK_NB) == 0;
+	}
+
+	void MappedRegion::UnlockShared() noexcept {
+		if (FileHandle != -1) {
+			flock(static_cast<int>(FileHandle), LOCK_UN);
+		}
+	}
+
+	bool MappedRegion::UnlinkSharedIfMapped(const char* Name) noexcept {
+		if (FileHandle == -1) {
+			return false;
+		}
+
+		const int NamedFile = shm_open(Name, O_RDWR, 0600);
+		if (NamedFile < 0) {
+			return false;
+		}
+
+		struct stat MappedStat { };
+		struct stat NamedStat { };
+
+		const bool bSameSegment = fstat(static_cast<int>(FileHandle), &MappedStat) == 0 && fstat(NamedFile, &NamedStat) == 0 &&
+			MappedStat.st_dev == NamedStat.st_dev && MappedStat.st_ino == NamedStat.st_ino;
+
+		close(NamedFile);
+
+		return bSameSegment && shm_unlink(Name) == 0;
+	}
+
+	void MappedRegion::Unmap() noexcept {
+		if (Base) {
+			munmap(Base, Size);
+			Base = nullptr;
+			Size = 0;
+		}
+
+		if (FileHandle != -1) {
+			close(static_cast<int>(FileHandle));
+			FileHandle = -1;
+		}
+	}
+#endif
+}
@@ -1,4 +1,104 @@
 #include "../public/MemEx.h"
 
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sched.h>
+#endif
+
 namespace MemEx {
-}
\ No newline at end of file
+	//Stable index of the calling thread, assigned round robin on first use
+	static size_t GetCurrentThreadIndex() noexcept {
+		static std::atomic<size_t> NextThreadIndex{ 0 };
+		static thread_local size_t ThreadIndex = NextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+
+		return ThreadIndex;
+	}
+
+	size_t GetCurrentProcessorIndex() noexcept {
+#if defined(MEMEX_SHARD_BY_THREAD)
+		return GetCurrentThreadIndex();
+#elif defined(_WIN32)
+		return static_cast<size_t>(GetCurrentProcessorNumber());
+#else
+		const int Cpu = sched_getcpu();
+		if (Cpu < 0) {
+			return GetCurrentThreadIndex();
+		}
+
+		return static_cast<size_t>(Cpu);
+#endif
+	}
+
+	void MemFillPattern(ptr_t Dst, size_t Size, __m128i Pattern) noexcept {
+		uint8_t* Cursor = reinterpret_cast<uint8_t*>(Dst);
+		uint8_t* const End = Cursor + Size;
+
+		if (Size < sizeof(__m128i)) {
+			memcpy(Cursor, &Pattern, Size);
+			return;
+		}
+
+		//Unaligned head, then continue from the first 16 bytes aligned address (overlapping stores write the same bytes)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Cursor), Pattern);
+		Cursor = AlignPointer(Cursor + 1, sizeof(__m128i));
+
+		if (Size >= NonTemporalStoreThreshold) {
+			for (; Cursor + (4 * sizeof(__m128i)) <= End; Cursor += 4 * sizeof(__m128i)) {
+				_mm_stream_si128(reinterpret_cast<__m128i*>(Cursor), Pattern);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(Cursor) + 1, Pattern);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(Cursor) + 2, Pattern);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(Cursor) + 3, Pattern);
+			}
+
+			//Make the non-temporal stores visible before returning
+			_mm_sfence();
+		}
+		else {
+			for (; Cursor + (4 * sizeof(__m128i)) <= End; Cursor += 4 * sizeof(__m128i)) {
+				_mm_store_si128(reinterpret_cast<__m128i*>(Cursor), Pattern);
+				_mm_store_si128(reinterpret_cast<__m128i*>(Cursor) + 1, Pattern);
+				_mm_store_si128(reinterpret_cast<__m128i*>(Cursor) + 2, Pattern);
+				_mm_store_si128(reinterpret_cast<__m128i*>(Cursor) + 3, Pattern);
+			}
+		}
+
+		for (; Cursor + sizeof(__m128i) <= End; Cursor += sizeof(__m128i)) {
+			_mm_store_si128(reinterpret_cast<__m128i*>(Cursor), Pattern);
+		}
+
+		//Unaligned tail
+		if (Cursor != End) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(End - sizeof(__m128i)), Pattern);
+		}
+	}
+
+	void RunParallel(size_t ThreadsCount, const Delegate<void, size_t>& Work) noexcept {
+		std::vector<std::thread> Workers;
+
+		try {
+			Workers.reserve(ThreadsCount);
+
+			for (size_t ThreadIndex = 1; ThreadIndex < ThreadsCount; ThreadIndex++) {
+				Workers.emplace_back([&Work, ThreadIndex]() { Work(ThreadIndex); });
+			}
+		}
+		catch (...) {
+			//Run the work of the threads that could not be started on this thread
+			for (size_t ThreadIndex = Workers.size() + 1; ThreadIndex < ThreadsCount; ThreadIndex++) {
+				Work(ThreadIndex);
+			}
+		}
+
+		Work(0);
+
+		for (auto& Worker : Workers) {
+			Worker.join();
+		}
+	}
+}
@@ -0,0 +1,235 @@
+#include "../public/MemEx.h"
+
+#include <cstdio>
+
+namespace MemEx {
+	size_t PersistentHeap::ComputeHeapSize(const uint32_t(&TierBlocksCount)[PersistentTiersCount], uint64_t(&OutTierOffset)[PersistentTiersCount]) noexcept {
+		size_t Offset = AlignUp(sizeof(HeapHeader), MEMEX_PAGE_SIZE);
+
+		for (size_t i = 0; i < PersistentTiersCount; i++) {
+			OutTierOffset[i] = Offset;
+			Offset = AlignUp(Offset + (GetBlockStride(i) * TierBlocksCount[i]), MEMEX_PAGE_SIZE);
+		}
+
+		return Offset;
+	}
+
+	EPersistentHeapStatus PersistentHeap::Open(const char* Path, const uint32_t(&TierBlocksCount)[PersistentTiersCount], ptr_t PreferredBase) noexcept {
+		Close();
+
+		EPersistentHeapStatus Status = EPersistentHeapStatus::Attached;
+
+		if (!Region.MapExistingFile(Path, PreferredBase)) {
+			Status = Create(Path, TierBlocksCount, PreferredBase);
+			if (Status != EPersistentHeapStatus::Created && Status != EPersistentHeapStatus::Attached) {
+				return Status;
+			}
+		}
+
+		Header = reinterpret_cast<HeapHeader*>(Region.GetBase());
+
+		//Existing files are never modified or removed if they are not a compatible heap
+		if (!Validate()) {
+			Header = nullptr;
+			Region.Unmap();
+			return EPersistentHeapStatus::ErrorIncompatible;
+		}
+
+		return Status;
+	}
+
+	EPersistentHeapStatus PersistentHeap::Create(const char* Path, const uint32_t(&TierBlocksCount)[PersistentTiersCount], ptr_t PreferredBase) noexcept {
+		char TempPath[1024];
+		if (!MappedRegion::MakeTempPath(Path, TempPath, sizeof(TempPath))) {
+			return EPersistentHeapStatus::ErrorMap;
+		}
+
+		uint64_t TierOffset[PersistentTiersCount];
+		const size_t HeapSize = ComputeHeapSize(TierBlocksCount, TierOffset);
+
+		//The temporary name is ours, a file left there by a crashed process is garbage
+		std::remove(TempPath);
+
+		bool bCreated = false;
+		if (!Region.MapFile(TempPath, HeapSize, PreferredBase, bCreated) || !bCreated) {
+			Region.Unmap();
+			std::remove(TempPath);
+			return EPersistentHeapStatus::ErrorMap;
+		}
+
+		Header = reinterpret_cast<HeapHeader*>(Region.GetBase());
+
+		const bool bFormatted = Format(TierBlocksCount, true);
+
+		Header = nullptr;
+		Region.Unmap();
+
+		const bool bPublished = bFormatted && MappedRegion::PublishFile(TempPath, Path);
+		if (!bPublished) {
+			std::remove(TempPath);
+		}
+
+		if (!bFormatted) {
+			return EPersistentHeapStatus::ErrorMap;
+		}
+
+		//If another process published [Path] first, attach to its heap (validated by Open)
+		if (!Region.MapExistingFile(Path, PreferredBase)) {
+			return bPublished ? EPersistentHeapStatus::ErrorMap : EPersistentHeapStatus::ErrorIncompatible;
+		}
+
+		return bPublished ? EPersistentHeapStatus::Created : EPersistentHeapStatus::Attached;
+	}
+
+	void PersistentHeap::Close() noexcept {
+		if (Header) {
+			Checkpoint();
+			Header = nullptr;
+		}
+
+		Region.Unmap();
+	}
+
+	bool PersistentHeap::Checkpoint() noexcept {
+		return Region.Flush();
+	}
+
+	bool PersistentHeap::Format(const uint32_t(&TierBlocksCount)[PersistentTiersCount], bool bDurable) noexcept {
+		//The file is new (zero filled)
+		Header->Version = HeapVersion;
+		Header->HeapHeaderSize = static_cast<uint32_t>(sizeof(HeapHeader));
+		Header->BlockHeaderSize = static_cast<uint32_t>(sizeof(BlockHeader));
+		Header->PointerSize = static_cast<uint32_t>(sizeof(ptr_t));
+		Header->TiersCount = static_cast<uint32_t>(PersistentTiersCount);
+		Header->TotalSize = ComputeHeapSize(TierBlocksCount, Header->TierOffset);
+		Header->CreationBase = reinterpret_cast<uint64_t>(Region.GetBase());
+
+		for (size_t TierIndex = 0; TierIndex < PersistentTiersCount; TierIndex++) {
+			Header->TierBlockSize[TierIndex] = TierBlockSizes[TierIndex];
+			Header->TierBlocksCount[TierIndex] = TierBlocksCount[TierIndex];
+
+			//Link all the blocks in order, the heap is not shared yet
+			for (uint32_t BlockIndex = 0; BlockIndex < TierBlocksCount[TierIndex]; BlockIndex++) {
+				BlockHeader* Block = GetBlock(TierIndex, BlockIndex);
+				Block->TierIndex = static_cast<uint32_t>(TierIndex);
+				Block->BlockIndex = BlockIndex;
+				Block->NextFree.store(BlockIndex + 1 < TierBlocksCount[TierIndex] ? BlockIndex + 2 : 0, std::memory_order_relaxed);
+			}
+
+			Header->Tiers[TierIndex].FreeHead.store(TierBlocksCount[TierIndex] ? 1 : 0, std::memory_order_relaxed);
+		}
+
+		//The flushes do not order the page writes, the whole heap is persisted before the magic is written
+		if (bDurable && !Region.Flush()) {
+			return false;
+		}
+
+		//The magic is written last, a partially formatted file is never attached
+		std::atomic_ref<uint64_t>(Header->Magic).store(HeapMagic, std::memory_order_release);
+
+		return !bDurable || Region.Flush(0, sizeof(HeapHeader));
+	}
+
+	bool PersistentHeap::Validate() const noexcept {
+		if (Region.GetSize() < sizeof(HeapHeader)) {
+			return false;
+		}
+
+		if (Header->Magic != HeapMagic ||
+			Header->Version != HeapVersion ||
+			Header->HeapHeaderSize != sizeof(HeapHeader) ||
+			Header->BlockHeaderSize != sizeof(BlockHeader) ||
+			Header->PointerSize != sizeof(ptr_t) ||
+			Header->TiersCount != PersistentTiersCount ||
+			Header->TotalSize != Region.GetSize()) {
+			return false;
+		}
+
+		for (size_t TierIndex = 0; TierIndex < PersistentTiersCount; TierIndex++) {
+			if (Header->TierBlockSize[TierIndex] != TierBlockSizes[TierIndex]) {
+				return false;
+			}
+		}
+
+		//The tiers must be laid out exactly as this build would lay them out
+		uint64_t TierOffset[PersistentTiersCount];
+		if (ComputeHeapSize(Header->TierBlocksCount, TierOffset) != Header->TotalSize) {
+			return false;
+		}
+
+		for (size_t TierIndex = 0; TierIndex < PersistentTiersCount; TierIndex++) {
+			if (TierOffset[TierIndex] != Header->TierOffset[TierIndex]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	PersistentHeap::BlockHeader* PersistentHeap::PopFree(size_t TierIndex) noexcept {
+		std::atomic<uint64_t>& FreeHead = Header->Tiers[TierIndex].FreeHead;
+
+		uint64_t Head = FreeHead.load(std::memory_order_acquire);
+		for (;;) {
+			const uint32_t First = static_cast<uint32_t>(Head);
+			if (First == 0) {
+				return nullptr;
+			}
+
+			BlockHeader* Block = GetBlock(TierIndex, First - 1);
+
+			//Might be stale if the block was popped meanwhile, the tag makes the CAS fail in that case
+			const uint64_t Next = Block->NextFree.load(std::memory_order_relaxed);
+			const uint64_t NewHead = (((Head >> 32) + 1) << 32) | Next;
+
+			if (FreeHead.compare_exchange_weak(Head, NewHead, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				return Block;
+			}
+		}
+	}
+
+	void PersistentHeap::PushFree(BlockHeader* Block) noexcept {
+		std::atomic<uint64_t>& FreeHead = Header->Tiers[Block->TierIndex].FreeHead;
+
+		uint64_t Head = FreeHead.load(std::memory_order_relaxed);
+		uint64_t NewHead;
+		do {
+			Block->NextFree.store(static_cast<uint32_t>(Head), std::memory_order_relaxed);
+			NewHead = (((Head >> 32) + 1) << 32) | (Block->BlockIndex + 1);
+		} while (!FreeHead.compare_exchange_weak(Head, NewHead, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	ptr_t PersistentHeap::AllocateRaw(size_t Size) noexcept {
+		for (size_t TierIndex = 0; TierIndex < PersistentTiersCount; TierIndex++) {
+			if (Size > TierBlockSizes[TierIndex]) {
+				continue;
+			}
+
+			//Fall back to the larger tiers when a tier is exhausted
+			BlockHeader* Block = PopFree(TierIndex);
+			if (Block) {
+				Block->Size = static_cast<uint32_t>(Size);
+				Block->RefCount.store(1, std::memory_order_relaxed);
+				Header->Tiers[TierIndex].LiveBlocksCount.fetch_add(1, std::memory_order_relaxed);
+
+				return reinterpret_cast<uint8_t*>(Block) + sizeof(BlockHeader);
+			}
+		}
+
+		return nullptr;
+	}
+
+	void PersistentHeap::FreeRaw(ptr_t Ptr) noexcept {
+		if (!Ptr) {
+			return;
+		}
+
+		BlockHeader* Block = reinterpret_cast<BlockHeader*>(reinterpret_cast<uint8_t*>(Ptr) - sizeof(BlockHeader));
+
+		Block->Size = 0;
+		Block->RefCount.store(0, std::memory_order_relaxed);
+		Header->Tiers[Block->TierIndex].LiveBlocksCount.fetch_sub(1, std::memory_order_relaxed);
+
+		PushFree(Block);
+	}
+}
@@ -0,0 +1,110 @@
+#include "../public/MemEx.h"
+
+#include <chrono>
+#include <thread>
+
+namespace MemEx {
+	EPersistentHeapStatus SharedHeap::Open(const char* Name, const uint32_t(&TierBlocksCount)[PersistentTiersCount], uint32_t TimeoutMs) noexcept {
+		Close();
+
+		uint64_t TierOffset[PersistentTiersCount];
+		const size_t HeapSize = ComputeHeapSize(TierBlocksCount, TierOffset);
+
+		const auto Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TimeoutMs);
+
+		for (;;) {
+			//MapShared fails while the creator has not sized the segment yet
+			bool bCreated = false;
+			while (!Region.MapShared(Name, HeapSize, bCreated)) {
+				if (std::chrono::steady_clock::now() >= Deadline) {
+					return EPersistentHeapStatus::ErrorMap;
+				}
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			Header = reinterpret_cast<HeapHeader*>(Region.GetBase());
+
+			if (bCreated) {
+				//The segment is new (zero filled), no other process uses it until the magic is written
+				const bool bFormatted = Format(TierBlocksCount, false);
+
+				Region.UnlockShared();
+
+				if (!bFormatted) {
+					Header = nullptr;
+					Region.Unmap();
+					MappedRegion::UnlinkShared(Name);
+					return EPersistentHeapStatus::ErrorMap;
+				}
+
+				return EPersistentHeapStatus::Created;
+			}
+
+			//Wait for the creator to finish formatting the heap
+			bool bAbandoned = false;
+			while (std::atomic_ref<uint64_t>(Header->Magic).load(std::memory_order_acquire) != HeapMagic) {
+				//The creator holds the segment lock until the magic is written, a free lock without the magic means the
+				//creator died while creating the heap, remove the segment and create it again
+				if (Region.TryLockShared()) {
+					bAbandoned = std::atomic_ref<uint64_t>(Header->Magic).load(std::memory_order_acquire) != HeapMagic;
+					if (bAbandoned) {
+						Region.UnlinkSharedIfMapped(Name);
+					}
+
+					Region.UnlockShared();
+					break;
+				}
+
+				if (std::chrono::steady_clock::now() >= Deadline) {
+					break;
+				}
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			if (!bAbandoned) {
+				break;
+			}
+
+			//The name is free or refers to the heap created by another process by now
+			Header = nullptr;
+			Region.Unmap();
+		}
+
+		if (!Validate()) {
+			Header = nullptr;
+			Region.Unmap();
+			return EPersistentHeapStatus::ErrorIncompatible;
+		}
+
+		return EPersistentHeapStatus::Attached;
+	}
+
+	bool SharedHeap::IsLiveBlockOffset(uint64_t Offset) const noexcept {
+		if (!Header || Offset < sizeof(BlockHeader)) {
+			return false;
+		}
+
+		const uint64_t BlockOffset = Offset - sizeof(BlockHeader);
+
+		for (size_t TierIndex = 0; TierIndex < PersistentTiersCount; TierIndex++) {
+			const uint64_t TierOffset = Header->TierOffset[TierIndex];
+			const uint64_t Stride = GetBlockStride(TierIndex);
+
+			if (BlockOffset < TierOffset || BlockOffset >= TierOffset + (Stride * Header->TierBlocksCount[TierIndex])) {
+				continue;
+			}
+
+			if ((BlockOffset - TierOffset) % Stride != 0) {
+				return false;
+			}
+
+			const BlockHeader* Block = reinterpret_cast<const BlockHeader*>(Region.GetBase() + BlockOffset);
+
+			return Block->RefCount.load(std::memory_order_relaxed) != 0;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+/**
+ * @file AllocationTrace.h
+ *
+ * @brief AllocationTrace: Recording of the MemoryManager allocations into a memory mapped trace file
+			Each thread appends events to its own buffer, full buffers are copied into the file.
+			Each event records the requested size, the tier, the thread, a timestamp and a block id (the block header address,
+			ids are reused after the block is freed).
+			The trace is replayed offline by the TraceReplay tool.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	enum class ETraceEventType : uint8_t {
+		Alloc,
+		Free
+	};
+
+	struct TraceEvent {
+		uint64_t			Timestamp;		//Nanoseconds since the start of the recording
+		uint64_t			BlockId;
+		uint32_t			Size;			//Requested bytes (clamped to UINT32_MAX)
+		uint16_t			ThreadIndex;	//Order in which the threads recorded their first event
+		uint8_t				Tier;			//See FragmentationStats tiers
+		ETraceEventType		Type;
+	};
+
+	static_assert(sizeof(TraceEvent) == 24, "TraceEvent must be 24 bytes");
+
+	//Placed at the begining of the trace file, followed by Capacity events (EventsCount valid, unordered across threads)
+	struct alignas(MEMEX_CACHE_LINE_SIZE) TraceFileHeader {
+		uint64_t	Magic;
+		uint32_t	Version;
+		uint32_t	EventSize;
+		uint64_t	Capacity;
+		uint64_t	EventsCount;
+		uint64_t	DroppedEventsCount;			//Events lost because the file was full
+		uint64_t	TimestampFrequency;			//Timestamp ticks per second
+	};
+
+	class AllocationTrace {
+	public:
+		static constexpr uint64_t	TraceMagic = 0x31434152544D4D58ULL; //"XMMTRAC1"
+		static constexpr uint32_t	TraceVersion = 1;
+
+		//Start recording into a new trace file at [Path] (replaced if it exists) with room for [MaxEvents] events
+		static bool Start(const char* Path, size_t MaxEvents = TraceDefaultMaxEvents) noexcept;
+
+		//Stop recording, the buffers of all the threads are flushed and the file is closed
+		static void Stop() noexcept;
+
+		FORCEINLINE static bool IsRecording() noexcept {
+			return bRecording.load(std::memory_order_acquire);
+		}
+
+		FORCEINLINE static void OnAllocate(const IMemoryBlock* BlockObject, size_t Tier, size_t Size) noexcept {
+			if (IsRecording()) {
+				Record(ETraceEventType::Alloc, reinterpret_cast<uint64_t>(BlockObject), Tier, Size);
+			}
+		}
+
+		FORCEINLINE static void OnFree(const IMemoryBlock* BlockObject, size_t Tier, size_t Size) noexcept {
+			if (IsRecording()) {
+				Record(ETraceEventType::Free, reinterpret_cast<uint64_t>(BlockObject), Tier, Size);
+			}
+		}
+
+		//Raw allocations (see MemoryManager::AllocRaw) have no header, the pointer is the id
+		FORCEINLINE static void OnAllocateRaw(const void* Ptr, size_t Tier, size_t Size) noexcept {
+			if (IsRecording()) {
+				Record(ETraceEventType::Alloc, reinterpret_cast<uint64_t>(Ptr), Tier, Size);
+			}
+		}
+
+		FORCEINLINE static void OnFreeRaw(const void* Ptr, size_t Tier, size_t Size) noexcept {
+			if (IsRecording()) {
+				Record(ETraceEventType::Free, reinterpret_cast<uint64_t>(Ptr), Tier, Size);
+			}
+		}
+
+	private:
+		static void Record(ETraceEventType Type, uint64_t BlockId, size_t Tier, size_t Size) noexcept;
+
+		static inline std::atomic<bool> bRecording{ false };
+	};
+}
@@ -0,0 +1,266 @@
+#pragma once
+/**
+ * @file BufferChain.h
+ *
+ * @brief MSlice: Reference counted view [Offset, Offset + Size) into a shared byte buffer
+			Slices share the ownership of the buffer's block, sub-ranges can be parsed and forwarded without copying.
+		  MBufferChain: Ordered list of slices for scatter/gather I/O
+			FillIOVecs produces the platform I/O vector (iovec on POSIX, WSABUF on Windows) for readv/writev/sendmsg/WSASend.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//Layout compatible with struct iovec (POSIX) and WSABUF (Windows)
+	struct MIOVec {
+#ifdef _WIN32
+		unsigned long	Length;
+		ptr_t			Base;
+#else
+		ptr_t			Base;
+		size_t			Length;
+#endif
+	};
+
+	class MSlice {
+	public:
+		MSlice() noexcept {}
+
+		//The whole capacity of [Buffer]
+		explicit MSlice(const MSharedPtr<uint8_t>& Buffer) noexcept
+			: MSlice(Buffer, 0, Buffer.GetCapacity())
+		{}
+
+		//[Length] bytes of [Buffer] starting at [Offset], clamped to the buffer capacity
+		MSlice(const MSharedPtr<uint8_t>& Buffer, size_t Offset, size_t Length) noexcept {
+			const size_t Capacity = Buffer.GetCapacity();
+			if (Offset >= Capacity) {
+				return;
+			}
+
+			BlockObject = const_cast<IMemoryBlock*>(Buffer.GetMemoryBlock());
+			BlockObject->AddReference();
+
+			Data = const_cast<uint8_t*>(Buffer.Get()) + Offset;
+			Size = Length < Capacity - Offset ? Length : Capacity - Offset;
+		}
+
+		~MSlice() noexcept {
+			Reset();
+		}
+
+		//Copy, shares the ownership
+		MSlice(const MSlice& Other) noexcept
+			: BlockObject(Other.BlockObject)
+			, Data(Other.Data)
+			, Size(Other.Size)
+		{
+			if (BlockObject) {
+				BlockObject->AddReference();
+			}
+		}
+		MSlice& operator=(const MSlice& Other) noexcept {
+			if (this == &Other) {
+				return *this;
+			}
+
+			if (Other.BlockObject) {
+				Other.BlockObject->AddReference();
+			}
+
+			Reset();
+
+			BlockObject = Other.BlockObject;
+			Data = Other.Data;
+			Size = Other.Size;
+
+			return *this;
+		}
+
+		//Move
+		MSlice(MSlice&& Other) noexcept
+			: BlockObject(Other.BlockObject)
+			, Data(Other.Data)
+			, Size(Other.Size)
+		{
+			Other.BlockObject = nullptr;
+			Other.Data = nullptr;
+			Other.Size = 0;
+		}
+		MSlice& operator=(MSlice&& Other) noexcept {
+			if (this == &Other) {
+				return *this;
+			}
+
+			Reset();
+
+			BlockObject = Other.BlockObject;
+			Data = Other.Data;
+			Size = Other.Size;
+
+			Other.BlockObject = nullptr;
+			Other.Data = nullptr;
+			Other.Size = 0;
+
+			return *this;
+		}
+
+		//Slice of this slice sharing the same buffer, [Offset] and [Length] are clamped to this slice
+		MSlice SubSlice(size_t Offset, size_t Length = SIZE_MAX) const noexcept {
+			MSlice Result;
+			if (!BlockObject || Offset > Size) {
+				return Result;
+			}
+
+			BlockObject->AddReference();
+
+			Result.BlockObject = BlockObject;
+			Result.Data = Data + Offset;
+			Result.Size = Length < Size - Offset ? Length : Size - Offset;
+
+			return Result;
+		}
+
+		//Drop [Count] bytes from the front of the slice
+		FORCEINLINE void RemovePrefix(size_t Count) noexcept {
+			Count = Count < Size ? Count : Size;
+			Data += Count;
+			Size -= Count;
+		}
+
+		FORCEINLINE void Reset() noexcept {
+			if (BlockObject && BlockObject->ReleaseReference()) {
+				DeferredDestruction::DestroyBlock(BlockObject);
+			}
+
+			BlockObject = nullptr;
+			Data = nullptr;
+			Size = 0;
+		}
+
+		FORCEINLINE uint8_t* GetData() noexcept {
+			return Data;
+		}
+		FORCEINLINE const uint8_t* GetData() const noexcept {
+			return Data;
+		}
+
+		FORCEINLINE size_t GetSize() const noexcept {
+			return Size;
+		}
+
+		FORCEINLINE bool IsEmpty() const noexcept {
+			return Size == 0;
+		}
+
+		FORCEINLINE bool IsNull() const noexcept {
+			return BlockObject == nullptr;
+		}
+
+	private:
+		IMemoryBlock*	BlockObject{ nullptr };
+		uint8_t*		Data{ nullptr };
+		size_t			Size{ 0 };
+	};
+
+	class MBufferChain {
+	public:
+		//Append [Slice], returns false if the chain is full (BufferChainMaxSlices)
+		bool Append(MSlice Slice) noexcept {
+			if (SlicesCount == BufferChainMaxSlices) {
+				return false;
+			}
+
+			if (FirstSlice + SlicesCount == BufferChainMaxSlices) {
+				Compact();
+			}
+
+			TotalSize += Slice.GetSize();
+			Slices[FirstSlice + SlicesCount++] = std::move(Slice);
+
+			return true;
+		}
+
+		//Drop [Count] bytes from the front of the chain (eg. after a partial writev), emptied slices are released
+		void Consume(size_t Count) noexcept {
+			size_t First = 0;
+
+			while (Count && First < SlicesCount) {
+				MSlice& Slice = Slices[FirstSlice + First];
+
+				const size_t Removed = Count < Slice.GetSize() ? Count : Slice.GetSize();
+				Slice.RemovePrefix(Removed);
+				Count -= Removed;
+				TotalSize -= Removed;
+
+				if (!Slice.IsEmpty()) {
+					break;
+				}
+
+				Slice.Reset();
+				First++;
+			}
+
+			FirstSlice += First;
+			SlicesCount -= First;
+		}
+
+		void Clear() noexcept {
+			for (size_t i = 0; i < SlicesCount; i++) {
+				Slices[FirstSlice + i].Reset();
+			}
+
+			FirstSlice = 0;
+			SlicesCount = 0;
+			TotalSize = 0;
+		}
+
+		//Fill [OutVecs] with up to [MaxCount] I/O vectors (one per non empty slice), returns the count
+		size_t FillIOVecs(MIOVec* OutVecs, size_t MaxCount) noexcept {
+			size_t Count = 0;
+
+			for (size_t i = 0; i < SlicesCount && Count < MaxCount; i++) {
+				MSlice& Slice = Slices[FirstSlice + i];
+				if (Slice.IsEmpty()) {
+					continue;
+				}
+
+				OutVecs[Count].Base = Slice.GetData();
+				OutVecs[Count].Length = static_cast<decltype(MIOVec::Length)>(Slice.GetSize());
+				Count++;
+			}
+
+			return Count;
+		}
+
+		FORCEINLINE MSlice& operator[](size_t Index) noexcept {
+			return Slices[FirstSlice + Index];
+		}
+
+		FORCEINLINE size_t GetSlicesCount() const noexcept {
+			return SlicesCount;
+		}
+
+		//Sum of the slice sizes
+		FORCEINLINE size_t GetTotalSize() const noexcept {
+			return TotalSize;
+		}
+
+	private:
+		//Move the live slices to the begining
+		void Compact() noexcept {
+			for (size_t i = 0; i < SlicesCount; i++) {
+				Slices[i] = std::move(Slices[FirstSlice + i]);
+			}
+
+			FirstSlice = 0;
+		}
+
+		MSlice	Slices[BufferChainMaxSlices];
+		size_t	FirstSlice{ 0 };
+		size_t	SlicesCount{ 0 };
+		size_t	TotalSize{ 0 };
+	};
+}
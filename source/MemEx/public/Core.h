@@ -15,6 +15,7 @@
 #include <type_traits>
 #include <intrin.h>
 #include <memory>
+#include <thread>
 
 #define MEMEX_STATISTICS
 
@@ -22,6 +23,16 @@
 #define ALIGNMENT alignof(size_t)
 #endif
 
+//Cache line size of the target, blocks and their payloads are aligned to this
+#ifndef MEMEX_CACHE_LINE_SIZE
+#define MEMEX_CACHE_LINE_SIZE 64
+#endif
+
+//Page size of the target, upper bound for the alignment of allocated types
+#ifndef MEMEX_PAGE_SIZE
+#define MEMEX_PAGE_SIZE 4096
+#endif
+
 #ifndef FORCEINLINE
 #define FORCEINLINE __forceinline
 #endif
@@ -37,6 +48,25 @@ namespace MemEx {
 
 	using long_t = long;
 
+	//Is [Value] a power of 2
+	constexpr bool IsPowerOf2(size_t Value) noexcept {
+		return Value != 0 && (Value & (Value - 1)) == 0;
+	}
+
+	//Round [Value] up to the next multiple of [Alignment] (must be a power of 2)
+	constexpr size_t AlignUp(size_t Value, size_t Alignment) noexcept {
+		return (Value + (Alignment - 1)) & ~(Alignment - 1);
+	}
+
+	//Round [Ptr] up to the next address multiple of [Alignment] (must be a power of 2)
+	template<typename T>
+	FORCEINLINE T* AlignPointer(T* Ptr, size_t Alignment) noexcept {
+		return reinterpret_cast<T*>(AlignUp(reinterpret_cast<size_t>(Ptr), Alignment));
+	}
+
+	// Index of the CPU the calling thread is running on (or a stable per thread index if not available)
+	extern size_t GetCurrentProcessorIndex() noexcept;
+
 	// Global allocate block of memory
 	extern ptr_t GAllocate(size_t BlockSize, size_t BlockAlignment) noexcept;
 
@@ -0,0 +1,39 @@
+#pragma once
+/**
+ * @file CoroutineAllocator.h
+ *
+ * @brief MemExCoroutineAllocator: Promise type mixin, coroutine frames are allocated from the MemoryManager tier pools
+			struct promise_type : MemEx::MemExCoroutineAllocator { ... };
+			Frames are headerless, the sized operator delete selects the tier from the frame size.
+			No exceptions are thrown: if the promise type declares get_return_object_on_allocation_failure() the nothrow
+			operator new is used and a failed frame allocation returns that object, otherwise the failure terminates.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+#include <new>
+#include <exception>
+
+namespace MemEx {
+	struct MemExCoroutineAllocator {
+		//The coroutine cant report the failure (no get_return_object_on_allocation_failure()), fail fast
+		static void* operator new(size_t Size) noexcept {
+			ptr_t Frame = MemoryManager::AllocRaw(Size);
+			if (!Frame) {
+				std::terminate();
+			}
+
+			return Frame;
+		}
+
+		static void* operator new(size_t Size, const std::nothrow_t&) noexcept {
+			return MemoryManager::AllocRaw(Size);
+		}
+
+		static void operator delete(void* Frame, size_t Size) noexcept {
+			MemoryManager::FreeRaw(Frame, Size);
+		}
+	};
+}
@@ -0,0 +1,138 @@
+#pragma once
+/**
+ * @file CowPtr.h
+ *
+ * @brief MCowPtr: Copy-on-write shared pointer to a MemoryManager (or MHeap) object or buffer
+ *			Copies share the block like MSharedPtr, reads never copy. Write() mutates in place while the pointer is the
+ *			only owner of the block (RefCount == 1) and otherwise clones the payload into a new block of the same heap
+ *			and memory tag first, the other owners keep reading the old block.
+ *			Buffers (see AllocSharedBuffer) are cloned whole, trivially copyable T's with a single memcpy.
+ *			Write() on a pointer that is not copied concurrently, like any MSharedPtr the pointer itself is not thread safe.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//[Align] - alignment the payload was allocated with, the clones are allocated with the same alignment
+	template<typename T, size_t Align = alignof(T)>
+	class MCowPtr {
+	public:
+		MCowPtr() noexcept {}
+		MCowPtr(std::nullptr_t) noexcept {}
+
+		MCowPtr(MSharedPtr<T>&& Shared) noexcept : Shared(std::move(Shared)) {}
+		MCowPtr(MPtr<T>&& Unique) noexcept : Shared(std::move(Unique)) {}
+
+		//Copy (shares the block)
+		MCowPtr(const MCowPtr& Other) noexcept = default;
+		MCowPtr& operator=(const MCowPtr& Other) noexcept = default;
+
+		//Move
+		MCowPtr(MCowPtr&& Other) noexcept = default;
+		MCowPtr& operator=(MCowPtr&& Other) noexcept = default;
+
+		FORCEINLINE const T* Read() const noexcept {
+			return Shared.Get();
+		}
+
+		FORCEINLINE const T& operator*() const noexcept {
+			return *Shared;
+		}
+		FORCEINLINE const T* operator->() const noexcept {
+			return Shared.Get();
+		}
+		FORCEINLINE const T& operator[](size_t Index) const noexcept {
+			return Shared[Index];
+		}
+
+		//Get the payload for writing, cloned first if the block is shared
+		//Returns nullptr if the clone could not be allocated (the pointer still refers to the shared block)
+		T* Write() noexcept requires(std::is_copy_constructible_v<T>) {
+			IMemoryBlock* BlockObject = Shared.GetMemoryBlock();
+			if (!BlockObject) {
+				return nullptr;
+			}
+
+			if (BlockObject->GetReferenceCount() == 1) {
+				return Shared.Get();
+			}
+
+			T* Clone = CloneBlock(BlockObject);
+			if (!Clone) {
+				return nullptr;
+			}
+
+			Shared = MSharedPtr<T>(Clone);
+
+			return Clone;
+		}
+
+		//Number of elements (1 for a single object)
+		FORCEINLINE size_t GetCount() const noexcept {
+			return Shared.IsNull() ? 0 : Shared.GetMemoryBlock()->ElementsCount;
+		}
+
+		//The next Write() mutates in place
+		FORCEINLINE bool IsUnique() const noexcept {
+			return !Shared.IsNull() && Shared.GetMemoryBlock()->GetReferenceCount() == 1;
+		}
+
+		explicit operator bool() const noexcept {
+			return !Shared.IsNull();
+		}
+		FORCEINLINE bool IsNull() const noexcept {
+			return Shared.IsNull();
+		}
+
+		FORCEINLINE void Reset() noexcept {
+			Shared.Reset();
+		}
+
+	private:
+		//Copy the payload of [BlockObject] into a new block of the same heap and tag, returns the new payload (RefCount 1)
+		static T* CloneBlock(IMemoryBlock* BlockObject) noexcept {
+			const size_t Count = BlockObject->ElementsCount;
+			const T* Source = reinterpret_cast<const T*>(BlockObject->Block);
+
+			IMemoryBlock* NewBlockObject;
+			{
+				MemoryTagScope Scope(static_cast<MemoryTag>(BlockObject->Tag));
+
+				NewBlockObject = BlockObject->Heap
+					? BlockObject->Heap->AllocBlock<T, Align>(Count)
+					: MemoryManager::AllocBlock<T, Align>(Count);
+			}
+
+			if (!NewBlockObject) {
+				return nullptr;
+			}
+
+			T* Destination = reinterpret_cast<T*>(NewBlockObject->Block);
+
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				memcpy(Destination, Source, sizeof(T) * Count);
+
+				NewBlockObject->bDontDestruct = BlockObject->bDontDestruct;
+			}
+			else if (BlockObject->bDontDestruct) {
+				//Buffers allocated without constructing the elements are copied as raw bytes
+				memcpy(static_cast<void*>(Destination), static_cast<const void*>(Source), sizeof(T) * Count);
+
+				NewBlockObject->bDontDestruct = true;
+			}
+			else {
+				for (size_t i = 0; i < Count; i++) {
+					new (Destination + i) T(Source[i]);
+				}
+			}
+
+			return Destination;
+		}
+
+		MSharedPtr<T> Shared;
+	};
+
+	static_assert(sizeof(MCowPtr<int>) == sizeof(int*), "MCowPtr<T> must be a single pointer");
+}
@@ -0,0 +1,88 @@
+#pragma once
+/**
+ * @file DeferredDestruction.h
+ *
+ * @brief DeferredDestruction: Opt-in "destroy later" mode for latency critical threads
+			While a thread is in deferred mode (see DeferredDestroyScope) the blocks released by its MPtr's,
+			MSharedPtr's and MIntrusivePtr's are pushed on a bounded lock-free queue instead of being destroyed inline.
+			The queue is drained by the reclaimer thread (StartReclaimer) or by MemoryManager::DrainDeferred().
+			Backpressure: when the queue holds MaxDepth blocks the block is destroyed inline on the releasing thread.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	class DeferredDestruction {
+	public:
+		struct Statistics {
+			size_t Depth{ 0 };					//Blocks currently queued
+			size_t MaxDepth{ 0 };				//High watermark of Depth
+			size_t TotalDeferred{ 0 };			//Blocks queued
+			size_t TotalDrained{ 0 };			//Blocks destroyed by the drain
+			size_t TotalInlineDestroys{ 0 };	//Blocks destroyed inline because the queue was full
+		};
+
+		//Destroy [BlockObject], deferred if the calling thread is in deferred mode and the queue is not full
+		FORCEINLINE static void DestroyBlock(IMemoryBlock* BlockObject) noexcept {
+			if (bThreadDeferred && Enqueue(BlockObject)) {
+				return;
+			}
+
+			BlockObject->Destroy(BlockObject, true);
+		}
+
+		FORCEINLINE static bool IsThreadDeferred() noexcept {
+			return bThreadDeferred;
+		}
+
+		FORCEINLINE static void SetThreadDeferred(bool bDeferred) noexcept {
+			bThreadDeferred = bDeferred;
+		}
+
+		//Destroy up to [MaxCount] queued blocks on the calling thread, returns the number of blocks destroyed
+		static size_t Drain(size_t MaxCount = SIZE_MAX) noexcept;
+
+		//Start the reclaimer thread, it drains the queue as soon as blocks are queued
+		static bool StartReclaimer() noexcept;
+
+		//Stop the reclaimer thread, the queue is drained before it exits
+		static void StopReclaimer() noexcept;
+
+		//Backpressure limit, clamped to [1, DeferredQueueSize]
+		static void SetMaxDepth(size_t MaxDepth) noexcept;
+
+		static Statistics GetStatistics() noexcept;
+
+	private:
+		//Returns false if the queue is full
+		static bool Enqueue(IMemoryBlock* BlockObject) noexcept;
+
+		static inline thread_local bool bThreadDeferred{ false };
+	};
+
+	//RAII deferred mode for the calling thread, the previous mode is restored on exit
+	class DeferredDestroyScope {
+	public:
+		explicit DeferredDestroyScope(bool bDeferred = true) noexcept
+			: bPreviousDeferred(DeferredDestruction::IsThreadDeferred())
+		{
+			DeferredDestruction::SetThreadDeferred(bDeferred);
+		}
+
+		~DeferredDestroyScope() noexcept {
+			DeferredDestruction::SetThreadDeferred(bPreviousDeferred);
+		}
+
+		DeferredDestroyScope(const DeferredDestroyScope&) = delete;
+		DeferredDestroyScope& operator=(const DeferredDestroyScope&) = delete;
+
+	private:
+		bool bPreviousDeferred;
+	};
+
+	FORCEINLINE void MemoryBlockBase::DestroyPayload(ptr_t Payload) noexcept {
+		DeferredDestruction::DestroyBlock(GetBlockFromPayload(Payload));
+	}
+}
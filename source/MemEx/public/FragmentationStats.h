@@ -0,0 +1,195 @@
+#pragma once
+/**
+ * @file FragmentationStats.h
+ *
+ * @brief FragmentationStats: Internal fragmentation (waste) accounting of the MemoryManager blocks
+			For each tier the live block bytes are tracked against the requested bytes (ElementSize * ElementsCount)
+			and the header bytes, per type the live wasted bytes are tracked to find the worst offenders.
+			Types are named by typeid(T).name() unless a name is registered with SetTypeName<T>().
+			Counters are per thread (see TThreadCounters), up to FragmentationTypesCount types are tracked, the rest are reported as "Other types".
+			Only active with MEMEX_STATISTICS.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+#include <typeinfo>
+
+namespace MemEx {
+	class FragmentationStats {
+	public:
+		//SmallBlock, MediumBlock, LargeBlock, ExtraLargeBlock, Custom (OS blocks)
+		static constexpr size_t TiersCount = 5;
+		static constexpr size_t CustomTier = 4;
+
+		//Index of the types not tracked individually (FragmentationTypesCount exceeded)
+		static constexpr size_t OtherTypesIndex = 0;
+
+		static_assert(FragmentationTypesCount > 1, "FragmentationTypesCount must be greater than 1");
+
+		struct TierStatistics {
+			size_t LiveBlocks{ 0 };
+			size_t BlockBytes{ 0 };			//Bytes held by the live blocks (headers included)
+			size_t RequestedBytes{ 0 };		//Bytes requested by the live allocations
+			size_t HeaderBytes{ 0 };		//Bytes used by the block headers
+
+			//Bytes neither requested nor used by headers
+			FORCEINLINE size_t GetWastedBytes() const noexcept {
+				return BlockBytes - RequestedBytes - HeaderBytes;
+			}
+
+			//Fraction of the block bytes not holding requested data (headers included)
+			FORCEINLINE double GetFragmentationRatio() const noexcept {
+				return BlockBytes ? static_cast<double>(BlockBytes - RequestedBytes) / static_cast<double>(BlockBytes) : 0.0;
+			}
+		};
+
+		struct TypeStatistics {
+			const char* Name{ nullptr };
+			size_t LiveBlocks{ 0 };
+			size_t RequestedBytes{ 0 };
+			size_t WastedBytes{ 0 };		//Live block bytes not requested (headers included)
+			size_t TotalAllocations{ 0 };
+		};
+
+		//Index of the counters of T, assigned on first use
+		template<typename T>
+		FORCEINLINE static size_t GetTypeIndex() noexcept {
+			static const size_t Index = RegisterType(typeid(T).name());
+			return Index;
+		}
+
+		//Name T in the reports instead of typeid(T).name()
+		template<typename T>
+		static void SetTypeName(const char* Name) noexcept {
+			const size_t Index = GetTypeIndex<T>();
+			if (Index != OtherTypesIndex) {
+				TypeNames[Index].store(Name, std::memory_order_relaxed);
+			}
+		}
+
+		FORCEINLINE static void OnAllocate(size_t Tier, size_t TypeIndex, size_t BlockBytes, size_t RequestedBytes, size_t HeaderBytes) noexcept {
+			ThreadStatsCounters& Counters = ThreadCounters::Local();
+
+			TierCounters& TierStats = Counters.Tiers[Tier];
+			AddLocalCounter(TierStats.LiveBlocks, 1);
+			AddLocalCounter(TierStats.BlockBytes, BlockBytes);
+			AddLocalCounter(TierStats.RequestedBytes, RequestedBytes);
+			AddLocalCounter(TierStats.HeaderBytes, HeaderBytes);
+
+			TypeCounters& TypeStats = Counters.Types[TypeIndex];
+			AddLocalCounter(TypeStats.LiveBlocks, 1);
+			AddLocalCounter(TypeStats.RequestedBytes, RequestedBytes);
+			AddLocalCounter(TypeStats.WastedBytes, BlockBytes - RequestedBytes);
+			AddLocalCounter(TypeStats.TotalAllocations, 1);
+		}
+
+		FORCEINLINE static void OnFree(size_t Tier, size_t TypeIndex, size_t BlockBytes, size_t RequestedBytes, size_t HeaderBytes) noexcept {
+			//Blocks may be freed by another thread, the counters of all the threads are summed so the per thread values can wrap
+			ThreadStatsCounters& Counters = ThreadCounters::Local();
+
+			TierCounters& TierStats = Counters.Tiers[Tier];
+			AddLocalCounter(TierStats.LiveBlocks, size_t(0) - 1);
+			AddLocalCounter(TierStats.BlockBytes, size_t(0) - BlockBytes);
+			AddLocalCounter(TierStats.RequestedBytes, size_t(0) - RequestedBytes);
+			AddLocalCounter(TierStats.HeaderBytes, size_t(0) - HeaderBytes);
+
+			TypeCounters& TypeStats = Counters.Types[TypeIndex];
+			AddLocalCounter(TypeStats.LiveBlocks, size_t(0) - 1);
+			AddLocalCounter(TypeStats.RequestedBytes, size_t(0) - RequestedBytes);
+			AddLocalCounter(TypeStats.WastedBytes, size_t(0) - (BlockBytes - RequestedBytes));
+		}
+
+		static TierStatistics GetTierStatistics(size_t Tier) noexcept {
+			TierStatistics Result;
+			if (Tier >= TiersCount) {
+				return Result;
+			}
+
+			ThreadCounters::ForEach([&Result, Tier](const ThreadStatsCounters& Counters) {
+				const TierCounters& TierStats = Counters.Tiers[Tier];
+				Result.LiveBlocks += TierStats.LiveBlocks.load(std::memory_order_relaxed);
+				Result.BlockBytes += TierStats.BlockBytes.load(std::memory_order_relaxed);
+				Result.RequestedBytes += TierStats.RequestedBytes.load(std::memory_order_relaxed);
+				Result.HeaderBytes += TierStats.HeaderBytes.load(std::memory_order_relaxed);
+			});
+
+			return Result;
+		}
+
+		//Fill [OutTypes] with up to [MaxCount] types ordered by live wasted bytes (descending), returns the count
+		static size_t GetWorstOffenders(TypeStatistics* OutTypes, size_t MaxCount) noexcept {
+			size_t Count = 0;
+
+			const size_t TypesCount = NextTypeIndex.load(std::memory_order_acquire);
+			for (size_t Index = 0; Index < TypesCount && Index < FragmentationTypesCount; Index++) {
+				TypeStatistics Type;
+				Type.Name = TypeNames[Index].load(std::memory_order_relaxed);
+
+				ThreadCounters::ForEach([&Type, Index](const ThreadStatsCounters& Counters) {
+					const TypeCounters& TypeStats = Counters.Types[Index];
+					Type.LiveBlocks += TypeStats.LiveBlocks.load(std::memory_order_relaxed);
+					Type.RequestedBytes += TypeStats.RequestedBytes.load(std::memory_order_relaxed);
+					Type.WastedBytes += TypeStats.WastedBytes.load(std::memory_order_relaxed);
+					Type.TotalAllocations += TypeStats.TotalAllocations.load(std::memory_order_relaxed);
+				});
+
+				if (!Type.WastedBytes || !Type.Name) {
+					continue;
+				}
+
+				//Insertion into the sorted top [MaxCount]
+				size_t Position = Count < MaxCount ? Count++ : MaxCount;
+				while (Position > 0 && OutTypes[Position - 1].WastedBytes < Type.WastedBytes) {
+					if (Position < MaxCount) {
+						OutTypes[Position] = OutTypes[Position - 1];
+					}
+					Position--;
+				}
+
+				if (Position < MaxCount) {
+					OutTypes[Position] = Type;
+				}
+			}
+
+			return Count;
+		}
+
+	private:
+		struct TierCounters {
+			std::atomic<size_t> LiveBlocks{ 0 };
+			std::atomic<size_t> BlockBytes{ 0 };
+			std::atomic<size_t> RequestedBytes{ 0 };
+			std::atomic<size_t> HeaderBytes{ 0 };
+		};
+
+		struct TypeCounters {
+			std::atomic<size_t> LiveBlocks{ 0 };
+			std::atomic<size_t> RequestedBytes{ 0 };
+			std::atomic<size_t> WastedBytes{ 0 };
+			std::atomic<size_t> TotalAllocations{ 0 };
+		};
+
+		struct ThreadStatsCounters {
+			TierCounters Tiers[TiersCount];
+			TypeCounters Types[FragmentationTypesCount];
+		};
+
+		using ThreadCounters = TThreadCounters<ThreadStatsCounters>;
+
+		static size_t RegisterType(const char* Name) noexcept {
+			const size_t Index = NextTypeIndex.fetch_add(1, std::memory_order_relaxed);
+			if (Index >= FragmentationTypesCount) {
+				return OtherTypesIndex;
+			}
+
+			TypeNames[Index].store(Name, std::memory_order_release);
+
+			return Index;
+		}
+
+		static inline std::atomic<const char*>	TypeNames[FragmentationTypesCount]{ "Other types" };
+		static inline std::atomic<size_t>		NextTypeIndex{ 1 };
+	};
+}
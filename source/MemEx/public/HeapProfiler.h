@@ -0,0 +1,73 @@
+#pragma once
+/**
+ * @file HeapProfiler.h
+ *
+ * @brief HeapProfiler: Sampling heap profiler of the MemoryManager (and MHeap) allocations
+			About every HeapProfilerSamplingInterval allocated bytes (geometric sampling, per thread) the allocation
+			captures its call stack (backtrace / CaptureStackBackTrace). The sample is kept in a side table keyed by block
+			until the block is freed, the block header is flagged so the frees of unsampled blocks never look it up.
+			Unsampled allocations only decrement a thread local byte counter.
+			Per call stack the profiler keeps the live (in use) and the cumulative (allocated) samples, written as a
+			pprof legacy heap profile (heap_v2, see WriteProfile) or as folded stacks (see WriteFoldedStacks).
+			Raw allocations (see MemoryManager::AllocRaw) have no header and are not sampled.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	class HeapProfiler {
+	public:
+		struct Statistics {
+			size_t SampledAllocations{ 0 };	//Samples taken since Start
+			size_t LiveSamples{ 0 };		//Sampled blocks not yet freed
+			size_t DroppedSamples{ 0 };		//Samples lost because the samples or the stacks table was full
+			size_t StacksCount{ 0 };		//Distinct call stacks recorded
+		};
+
+		static_assert(IsPowerOf2(HeapProfilerMaxSamples) && IsPowerOf2(HeapProfilerMaxStacks), "HeapProfilerMaxSamples and HeapProfilerMaxStacks must be powers of 2");
+
+		//Start sampling about every [SamplingInterval] allocated bytes, the samples of a previous run are discarded
+		static bool Start(size_t SamplingInterval = HeapProfilerSamplingInterval) noexcept;
+
+		//Stop sampling new allocations, the frees of the sampled blocks are still tracked (the live profile stays valid)
+		static void Stop() noexcept;
+
+		FORCEINLINE static bool IsEnabled() noexcept {
+			return bEnabled.load(std::memory_order_relaxed);
+		}
+
+		FORCEINLINE static void OnAllocate(IMemoryBlock* BlockObject, size_t Size) noexcept {
+			BytesUntilSample -= static_cast<int64_t>(Size);
+
+			if (BytesUntilSample < 0) {
+				SampleAllocation(BlockObject, Size);
+			}
+		}
+
+		FORCEINLINE static void OnFree(const IMemoryBlock* BlockObject) noexcept {
+			if (BlockObject->bSampled) {
+				RemoveSample(BlockObject);
+			}
+		}
+
+		//Write the live and cumulative samples in the pprof legacy heap profile format (heap_v2), the addresses are
+		//symbolized by pprof from the binary (the mapped libraries are appended on Linux)
+		static bool WriteProfile(const char* Path) noexcept;
+
+		//Write one symbolized "Outer;...;Inner Bytes" line per call stack (flame graph input)
+		//[bLive] - estimated bytes in use, otherwise estimated bytes allocated since Start
+		static bool WriteFoldedStacks(const char* Path, bool bLive = true) noexcept;
+
+		static Statistics GetStatistics() noexcept;
+
+	private:
+		static void SampleAllocation(IMemoryBlock* BlockObject, size_t Size) noexcept;
+		static void RemoveSample(const IMemoryBlock* BlockObject) noexcept;
+
+		//Bytes left until the next sample of the calling thread
+		static inline thread_local int64_t	BytesUntilSample{ 0 };
+		static inline std::atomic<bool>		bEnabled{ false };
+	};
+}
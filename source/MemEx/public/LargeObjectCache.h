@@ -0,0 +1,109 @@
+#pragma once
+/**
+ * @file LargeObjectCache.h
+ *
+ * @brief LargeObjectCache: Cache of the page spans backing the allocations above ExtraLargeMemBlockSize
+			Spans are mapped directly from the OS (mmap/VirtualAlloc) in size classes (4 classes per power of 2, page multiples)
+			and freed spans are kept in per class stacks, the most recently freed span is reused first.
+			Cached spans above the hot limit are returned to the OS with MADV_DONTNEED (MEM_DECOMMIT) but stay mapped, the oldest
+			span of the class first (see LargeObjectCacheLazyDecommit). Spans above the cached bytes limit (or above
+			LargeObjectCacheMaxSpanSize) are unmapped.
+			Fresh and decommitted spans are known to be zero, zeroed allocations of such spans skip the fill.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+#include <bit>
+
+namespace MemEx {
+	class LargeObjectCache {
+	public:
+		static constexpr size_t MinSpanSizeLog = std::bit_width(size_t(ExtraLargeMemBlockSize));
+		static constexpr size_t MinSpanSize = size_t(1) << MinSpanSizeLog;
+		static constexpr size_t MaxSpanSizeLog = std::bit_width(size_t(LargeObjectCacheMaxSpanSize) - 1);
+		static constexpr size_t ClassesPerPowerOf2 = 4;
+		static constexpr size_t BucketsCount = ((MaxSpanSizeLog - MinSpanSizeLog) * ClassesPerPowerOf2) + 1;
+
+		static_assert((size_t(1) << (MinSpanSizeLog - 2)) % MEMEX_PAGE_SIZE == 0, "LargeObjectCache size classes must be page multiples");
+		static_assert(IsPowerOf2(LargeObjectCacheMaxSpanSize) && LargeObjectCacheMaxSpanSize > MinSpanSize, "LargeObjectCacheMaxSpanSize must be a power of 2 greater than ExtraLargeMemBlockSize");
+
+		struct Statistics {
+			size_t Hits{ 0 };				//Allocations served by a cached span
+			size_t Misses{ 0 };				//Allocations that mapped a new span
+			size_t Decommits{ 0 };			//Cached spans returned to the OS (still mapped)
+			size_t Releases{ 0 };			//Spans unmapped
+			size_t CachedBytes{ 0 };
+			size_t HotBytes{ 0 };			//Cached bytes not returned to the OS
+			size_t ZeroFillsSkipped{ 0 };	//Zeroed allocations served by spans known to be zero
+		};
+
+		//Allocations of more than ExtraLargeMemBlockSize bytes (header included) use the cache
+		FORCEINLINE static constexpr bool IsLargeSize(size_t Size) noexcept {
+			return Size > ExtraLargeMemBlockSize;
+		}
+
+		//Allocate a page aligned span of at least [Size] bytes
+		//[bZeroed] - the first [Size] bytes are zero (cleared only if the span is not known to be zero), otherwise the content is undefined
+		static ptr_t Allocate(size_t Size, bool bZeroed = false) noexcept;
+
+		//Free [Span] obtained from Allocate([Size])
+		static void Free(ptr_t Span, size_t Size) noexcept;
+
+		//Set the cached bytes limit (spans over it are unmapped) and the hot bytes limit (spans over it are decommitted)
+		static void SetLimits(size_t MaxCachedBytes, size_t MaxHotBytes) noexcept {
+			MaxCached.store(MaxCachedBytes, std::memory_order_relaxed);
+			MaxHot.store(MaxHotBytes, std::memory_order_relaxed);
+		}
+
+		//Decommit all the cached spans, [bRelease] - unmap them instead
+		static void Trim(bool bRelease = false) noexcept;
+
+		static Statistics GetStatistics() noexcept {
+			Statistics Result;
+			Result.Hits = Hits.load(std::memory_order_relaxed);
+			Result.Misses = Misses.load(std::memory_order_relaxed);
+			Result.Decommits = Decommits.load(std::memory_order_relaxed);
+			Result.Releases = Releases.load(std::memory_order_relaxed);
+			Result.CachedBytes = CachedBytes.load(std::memory_order_relaxed);
+			Result.HotBytes = HotBytes.load(std::memory_order_relaxed);
+			Result.ZeroFillsSkipped = ZeroFillsSkipped.load(std::memory_order_relaxed);
+
+			return Result;
+		}
+
+		//Size class of [Size] bytes, SIZE_MAX if the span is not cached (above LargeObjectCacheMaxSpanSize)
+		static constexpr size_t GetBucketIndex(size_t Size, size_t& OutSpanSize) noexcept {
+			if (Size <= MinSpanSize) {
+				OutSpanSize = MinSpanSize;
+				return 0;
+			}
+
+			if (Size > LargeObjectCacheMaxSpanSize) {
+				OutSpanSize = AlignUp(Size, MEMEX_PAGE_SIZE);
+				return SIZE_MAX;
+			}
+
+			//Size is in (2^Log, 2^(Log + 1)], split in ClassesPerPowerOf2 steps
+			const size_t Log = std::bit_width(Size - 1) - 1;
+			const size_t Step = size_t(1) << (Log - 2);
+			const size_t SubClass = ((Size - (size_t(1) << Log)) + Step - 1) / Step;
+
+			OutSpanSize = (size_t(1) << Log) + (SubClass * Step);
+
+			return ((Log - MinSpanSizeLog) * ClassesPerPowerOf2) + SubClass;
+		}
+
+	private:
+		static inline std::atomic<size_t> MaxCached{ LargeObjectCacheMaxBytes };
+		static inline std::atomic<size_t> MaxHot{ LargeObjectCacheHotBytes };
+		static inline std::atomic<size_t> CachedBytes{ 0 };
+		static inline std::atomic<size_t> HotBytes{ 0 };
+		static inline std::atomic<size_t> Hits{ 0 };
+		static inline std::atomic<size_t> Misses{ 0 };
+		static inline std::atomic<size_t> Decommits{ 0 };
+		static inline std::atomic<size_t> Releases{ 0 };
+		static inline std::atomic<size_t> ZeroFillsSkipped{ 0 };
+	};
+}
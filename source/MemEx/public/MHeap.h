@@ -0,0 +1,421 @@
+#pragma once
+/**
+ * @file MHeap.h
+ *
+ * @brief MHeap: Instanceable heap with its own tier pools, limits and statistics
+ *			The MemoryManager tiers are process wide, each MHeap holds its own instance of the four tier pools
+ *			(see TObjectPoolInstance), heaps never share blocks, locks or counters so they never contend with each other.
+ *			Use one heap per shard, per tenant or per test.
+ *			The owning heap is stored in the block header, the MPtr/MSharedPtr returned by a heap are destroyed like any
+ *			other MemoryManager pointer and the block returns to its heap. Allocations above ExtraLargeMemBlockSize get a
+ *			dedicated OS block (see LargeObjectCache) accounted by the heap.
+ *			Heap blocks are tagged like the MemoryManager blocks (see MemoryTagScope), they count against the budget of
+ *			their tag and against the limit of their heap.
+ *			Release() frees the free blocks held by the tier pools of the heap, it does not touch the live blocks.
+ *			The heap does not track its live blocks, all the allocations of the heap must be destroyed before the heap
+ *			is destroyed (the live blocks point to their heap), destroying a heap with live blocks aborts.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+#include <cstdlib>
+
+namespace MemEx {
+	struct HeapStatistics {
+		size_t LiveBlocks{ 0 };
+		size_t LiveBytes{ 0 };				//Bytes held by the live blocks (block headers included)
+		size_t MaxBytes{ 0 };				//Limit of LiveBytes, SIZE_MAX - no limit
+		size_t TotalAllocations{ 0 };
+		size_t TotalRejected{ 0 };			//Allocations failed by the limit or by the tier exhaustion policy
+	};
+
+	class alignas(MEMEX_CACHE_LINE_SIZE) MHeap {
+	public:
+		using SmallPool = TObjectPoolInstance<MemoryManager::SmallBlock, SmallMemBlockCount>;
+		using MediumPool = TObjectPoolInstance<MemoryManager::MediumBlock, MediumMemBlockCount>;
+		using LargePool = TObjectPoolInstance<MemoryManager::LargeBlock, LargeMemBlockCount>;
+		using ExtraLargePool = TObjectPoolInstance<MemoryManager::ExtraLargeBlock, ExtraLargeMemBlockCount>;
+
+		MHeap() noexcept = default;
+
+		//All the blocks allocated by the heap must be destroyed first
+		~MHeap() noexcept {
+			//A live block would return to a destroyed heap
+			if (LiveBlocks.load(std::memory_order_acquire) != 0) {
+				std::abort();
+			}
+
+			Release();
+		}
+
+		//Cant copy
+		MHeap(const MHeap&) = delete;
+		MHeap& operator=(const MHeap&) = delete;
+
+		//Cant move, the blocks point to their heap
+		MHeap(MHeap&&) = delete;
+		MHeap& operator=(MHeap&&) = delete;
+
+		//Fill the tier pools of the heap (see MemoryManager::Initialize), returns 0 on success or the index + 1 of the tier that failed
+		int Preallocate() noexcept {
+			if (!Small.Preallocate()) {
+				return 1;
+			}
+			if (!Medium.Preallocate()) {
+				return 2;
+			}
+			if (!Large.Preallocate()) {
+				return 3;
+			}
+			if (!ExtraLarge.Preallocate()) {
+				return 4;
+			}
+
+			return 0;
+		}
+
+		//Free the free blocks held by the tier pools of the heap, the live blocks are not freed
+		//No other thread may use the heap during the call
+		void Release() noexcept {
+			Small.Release();
+			Medium.Release();
+			Large.Release();
+			ExtraLarge.Release();
+		}
+
+		//Limit the bytes held by the live blocks of the heap, allocations over it fail (SIZE_MAX - no limit)
+		FORCEINLINE void SetLimit(size_t MaxBytes) noexcept {
+			Limit.store(MaxBytes, std::memory_order_relaxed);
+		}
+
+		//Set the exhaustion policy of all the tier pools of the heap (see TObjectPoolInstance::SetExhaustionPolicy)
+		bool SetExhaustionPolicy(EPoolExhaustionPolicy Policy, uint32_t WaitTimeoutMs = 0) noexcept {
+			return Small.SetExhaustionPolicy(Policy, WaitTimeoutMs)
+				&& Medium.SetExhaustionPolicy(Policy, WaitTimeoutMs)
+				&& Large.SetExhaustionPolicy(Policy, WaitTimeoutMs)
+				&& ExtraLarge.SetExhaustionPolicy(Policy, WaitTimeoutMs);
+		}
+
+		HeapStatistics GetStatistics() const noexcept {
+			HeapStatistics Result;
+
+			Result.LiveBlocks = LiveBlocks.load(std::memory_order_relaxed);
+			Result.LiveBytes = LiveBytes.load(std::memory_order_relaxed);
+			Result.MaxBytes = Limit.load(std::memory_order_relaxed);
+			Result.TotalAllocations = TotalAllocations.load(std::memory_order_relaxed);
+			Result.TotalRejected = TotalRejected.load(std::memory_order_relaxed);
+
+			return Result;
+		}
+
+		//Heap that owns the block of [Payload], nullptr for the MemoryManager blocks
+		FORCEINLINE static MHeap* GetOwner(const void* Payload) noexcept {
+			return GetBlockFromPayload(Payload)->Heap;
+		}
+
+		// Allocate T aligned to [Align] (power of 2, alignof(T) <= Align <= MEMEX_PAGE_SIZE)
+		template<typename T, size_t Align, typename ...Types>
+		MPtr<T> AllocAligned(Types... Args) noexcept {
+			static_assert(!std::is_reference_v<T>, "Alloc<T> Cant allocate T reference!");
+			static_assert(!std::is_array_v<T>, "Use AllocBuffer(Count) to allocate arrays!");
+
+			IMemoryBlock* NewBlockObject = AllocBlock<T, Align>(1);
+			if (!NewBlockObject) {
+				return { };
+			}
+
+			ptr_t Ptr = NewBlockObject->Block;
+
+			MemoryManager::Construct<T>(Ptr, std::forward<Types>(Args)...);
+
+			return MPtr<T>(reinterpret_cast<T*>(Ptr));
+		}
+
+		template<typename T, typename ...Types>
+		FORCEINLINE MPtr<T> Alloc(Types... Args) noexcept {
+			return AllocAligned<T, alignof(T)>(std::forward<Types>(Args)...);
+		}
+
+		template<typename T, typename ...Types>
+		MSharedPtr<T> AllocShared(Types... Args) noexcept {
+			MPtr<T> Unique = AllocAligned<T, alignof(T)>(std::forward<Types>(Args)...);
+			if (Unique.IsNull()) {
+				return { };
+			}
+
+			return MSharedPtr<T>(std::move(Unique));
+		}
+
+		// Allocate T[Size] buffer (see MemoryManager::AllocBuffer)
+		template<typename T, bool bDontConstructElements = false, size_t Align = alignof(T)>
+		MPtr<T> AllocBuffer(const size_t Count) noexcept {
+			static_assert(!std::is_array_v<T>, "Dont use AllocBuffer<T[]>(size) but use AllocBuffer<T>(size)!");
+
+			//Value initialization of trivial T's is zero initialization
+			constexpr bool bZeroed = std::is_trivially_default_constructible_v<T> && !bDontConstructElements;
+
+			IMemoryBlock* NewBlockObject = AllocBlock<T, Align>(Count, bZeroed);
+			if (!NewBlockObject) {
+				return { };
+			}
+
+			//if we dont construct, we dont destruct
+			if constexpr (bDontConstructElements && std::is_destructible_v<T>) {
+				NewBlockObject->bDontDestruct = true;
+			}
+
+			T* Ptr = reinterpret_cast<T*>(NewBlockObject->Block);
+
+			if constexpr (std::is_default_constructible_v<T> && !bDontConstructElements && !std::is_trivially_default_constructible_v<T>) {
+				for (size_t i = 0; i < Count; i++) {
+					new (Ptr + i) T();
+				}
+			}
+
+			return MPtr<T>(Ptr);
+		}
+
+		template<typename T, size_t Align = alignof(T)>
+		MSharedPtr<T> AllocSharedBuffer(size_t Count) noexcept {
+			MPtr<T> Unique = AllocBuffer<T, false, Align>(Count);
+			if (Unique.IsNull()) {
+				return { };
+			}
+
+			return MSharedPtr<T>(std::move(Unique));
+		}
+
+		//Allocate a block for T[Count] from the tiers of the heap (see MemoryManager::AllocBlock)
+		//[bZeroed] - the payload (sizeof(T) * Count bytes) is zero filled
+		template<typename T, size_t Align = alignof(T)>
+		IMemoryBlock* AllocBlock(size_t Count, bool bZeroed = false) noexcept {
+			MemoryManager::ValidateAlignment<T, Align>();
+
+			if (!MemoryManager::IsValidCount<T>(Count)) {
+				return nullptr;
+			}
+
+			const size_t Size = sizeof(T) * Count;
+
+			if constexpr (Align > MEMEX_CACHE_LINE_SIZE)
+			{
+				return AllocCustomBlock<T, Align>(Size, (ulong_t)Count, bZeroed);
+			}
+			else {
+				if (Size <= SmallMemBlockSize)
+				{
+					return AllocTierBlock<T>(Small, (ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
+				}
+				else if (Size <= MediumMemBlockSize)
+				{
+					return AllocTierBlock<T>(Medium, (ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
+				}
+				else if (Size <= LargeMemBlockSize)
+				{
+					return AllocTierBlock<T>(Large, (ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
+				}
+				else if (Size <= ExtraLargeMemBlockSize)
+				{
+					return AllocTierBlock<T>(ExtraLarge, (ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
+				}
+
+				return AllocCustomBlock<T, Align>(Size, (ulong_t)Count, bZeroed);
+			}
+		}
+
+	private:
+		//Account [Bytes] for a new block, returns false if the limit rejects it
+		FORCEINLINE bool OnAllocate(size_t Bytes) noexcept {
+			if (LiveBytes.fetch_add(Bytes, std::memory_order_relaxed) + Bytes > Limit.load(std::memory_order_relaxed)) {
+				LiveBytes.fetch_sub(Bytes, std::memory_order_relaxed);
+				TotalRejected.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			LiveBlocks.fetch_add(1, std::memory_order_relaxed);
+			TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+			return true;
+		}
+
+		FORCEINLINE void OnFree(size_t Bytes) noexcept {
+			LiveBytes.fetch_sub(Bytes, std::memory_order_relaxed);
+			LiveBlocks.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		//Undo OnAllocate for a block that could not be allocated
+		FORCEINLINE void OnAllocateFailed(size_t Bytes) noexcept {
+			OnFree(Bytes);
+			TotalAllocations.fetch_sub(1, std::memory_order_relaxed);
+			TotalRejected.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		//Pool of the heap for the tier block TBlock
+		template<typename TBlock>
+		FORCEINLINE auto& GetPool() noexcept {
+			if constexpr (std::is_same_v<TBlock, MemoryManager::SmallBlock>) {
+				return Small;
+			}
+			else if constexpr (std::is_same_v<TBlock, MemoryManager::MediumBlock>) {
+				return Medium;
+			}
+			else if constexpr (std::is_same_v<TBlock, MemoryManager::LargeBlock>) {
+				return Large;
+			}
+			else {
+				return ExtraLarge;
+			}
+		}
+
+		//Allocate a block from the tier pool [Pool] of the heap
+		template<typename T, typename TPool>
+		IMemoryBlock* AllocTierBlock(TPool& Pool, ulong_t ElementSize, ulong_t ElementsCount, bool bZeroed) noexcept {
+			using TBlock = typename TPool::PoolTraits::MyPoolType;
+
+			if (!OnAllocate(sizeof(TBlock))) {
+				return nullptr;
+			}
+
+			const MemoryTag Tag = MemoryTags::GetThreadTag();
+			if (!MemoryTags::OnAllocate(Tag, sizeof(TBlock))) {
+				OnAllocateFailed(sizeof(TBlock));
+				return nullptr;
+			}
+
+			ptr_t Storage = Pool.AllocateRaw();
+			if (!Storage) {
+				MemoryTags::OnFree(Tag, sizeof(TBlock));
+				OnAllocateFailed(sizeof(TBlock));
+				return nullptr;
+			}
+
+			IMemoryBlock* NewBlockObject = new (Storage) TBlock(ElementSize, ElementsCount);
+
+			if (bZeroed) {
+				MemZero(NewBlockObject->Block, static_cast<size_t>(ElementSize) * ElementsCount);
+			}
+
+			NewBlockObject->Tag = Tag;
+			NewBlockObject->Heap = this;
+			NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) -> void {
+				IMemoryBlock* BlockObject = reinterpret_cast<IMemoryBlock*>(Object);
+				MHeap* Heap = BlockObject->Heap;
+
+#ifdef MEMEX_STATISTICS
+				FragmentationStats::OnFree(TBlock::TierIndex, FragmentationStats::GetTypeIndex<T>(), sizeof(TBlock),
+					static_cast<size_t>(BlockObject->ElementSize) * BlockObject->ElementsCount, sizeof(TBlock) - BlockObject->BlockSize);
+#endif
+
+				AllocationTrace::OnFree(BlockObject, TBlock::TierIndex, static_cast<size_t>(BlockObject->ElementSize) * BlockObject->ElementsCount);
+				HeapProfiler::OnFree(BlockObject);
+
+				MemoryManager::DestroyElements<T>(BlockObject, bCallDestructor);
+				MemoryTags::OnFree(static_cast<MemoryTag>(BlockObject->Tag), sizeof(TBlock));
+
+				static_cast<TBlock*>(BlockObject)->~TBlock();
+				Heap->GetPool<TBlock>().DeallocateRaw(BlockObject);
+				Heap->OnFree(sizeof(TBlock));
+			};
+
+#ifdef MEMEX_STATISTICS
+			FragmentationStats::OnAllocate(TBlock::TierIndex, FragmentationStats::GetTypeIndex<T>(), sizeof(TBlock),
+				static_cast<size_t>(ElementSize) * ElementsCount, sizeof(TBlock) - NewBlockObject->BlockSize);
+#endif
+
+			AllocationTrace::OnAllocate(NewBlockObject, TBlock::TierIndex, static_cast<size_t>(ElementSize) * ElementsCount);
+			HeapProfiler::OnAllocate(NewBlockObject, static_cast<size_t>(ElementSize) * ElementsCount);
+
+			return NewBlockObject;
+		}
+
+		//Allocate a dedicated OS block of [Size] bytes accounted by the heap (see MemoryManager::AllocCustomBlock)
+		template<typename T, size_t Align>
+		IMemoryBlock* AllocCustomBlock(size_t Size, ulong_t ElementsCount, bool bZeroed) noexcept {
+			constexpr size_t HeaderSize = CustomBlockHeader::GetHeaderSize(Align);
+			constexpr size_t BlockAlignment = Align < MEMEX_CACHE_LINE_SIZE ? MEMEX_CACHE_LINE_SIZE : Align;
+
+			if (!OnAllocate(HeaderSize + Size)) {
+				return nullptr;
+			}
+
+			const MemoryTag Tag = MemoryTags::GetThreadTag();
+			if (!MemoryTags::OnAllocate(Tag, HeaderSize + Size)) {
+				OnAllocateFailed(HeaderSize + Size);
+				return nullptr;
+			}
+
+			uint8_t* OSBlock;
+
+			if (LargeObjectCache::IsLargeSize(HeaderSize + Size)) {
+				OSBlock = (uint8_t*)LargeObjectCache::Allocate(HeaderSize + Size, bZeroed);
+			}
+			else {
+				OSBlock = (uint8_t*)GAllocate(HeaderSize + Size, BlockAlignment);
+
+				if (OSBlock && bZeroed) {
+					MemZero(OSBlock + HeaderSize, Size);
+				}
+			}
+
+			if (!OSBlock) {
+				MemoryTags::OnFree(Tag, HeaderSize + Size);
+				OnAllocateFailed(HeaderSize + Size);
+				return nullptr;
+			}
+
+			IMemoryBlock* NewBlockObject = new (OSBlock + HeaderSize - BlockHeaderOffset) CustomBlockHeader((ulong_t)Size, (ulong_t)sizeof(T), ElementsCount);
+
+			NewBlockObject->Tag = Tag;
+			NewBlockObject->Heap = this;
+			NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) -> void {
+				IMemoryBlock* BlockObject = reinterpret_cast<IMemoryBlock*>(Object);
+				MHeap* Heap = BlockObject->Heap;
+				const size_t BlockBytes = HeaderSize + BlockObject->BlockSize;
+
+#ifdef MEMEX_STATISTICS
+				FragmentationStats::OnFree(FragmentationStats::CustomTier, FragmentationStats::GetTypeIndex<T>(), BlockBytes,
+					static_cast<size_t>(BlockObject->ElementSize) * BlockObject->ElementsCount, HeaderSize);
+#endif
+
+				AllocationTrace::OnFree(BlockObject, FragmentationStats::CustomTier, BlockObject->BlockSize);
+				HeapProfiler::OnFree(BlockObject);
+
+				MemoryManager::DestroyElements<T>(BlockObject, bCallDestructor);
+				MemoryTags::OnFree(static_cast<MemoryTag>(BlockObject->Tag), BlockBytes);
+
+				uint8_t* OSBlock = reinterpret_cast<uint8_t*>(BlockObject) + BlockHeaderOffset - HeaderSize;
+				if (LargeObjectCache::IsLargeSize(BlockBytes)) {
+					LargeObjectCache::Free(OSBlock, BlockBytes);
+				}
+				else {
+					GFree(OSBlock);
+				}
+
+				Heap->OnFree(BlockBytes);
+			};
+
+#ifdef MEMEX_STATISTICS
+			FragmentationStats::OnAllocate(FragmentationStats::CustomTier, FragmentationStats::GetTypeIndex<T>(), HeaderSize + Size,
+				static_cast<size_t>(sizeof(T)) * ElementsCount, HeaderSize);
+#endif
+
+			AllocationTrace::OnAllocate(NewBlockObject, FragmentationStats::CustomTier, Size);
+			HeapProfiler::OnAllocate(NewBlockObject, Size);
+
+			return NewBlockObject;
+		}
+
+		SmallPool								Small{ };
+		MediumPool								Medium{ };
+		LargePool								Large{ };
+		ExtraLargePool							ExtraLarge{ };
+
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>	LiveBytes{ 0 };
+		std::atomic<size_t>									LiveBlocks{ 0 };
+		std::atomic<size_t>									TotalAllocations{ 0 };
+		std::atomic<size_t>									TotalRejected{ 0 };
+		std::atomic<size_t>									Limit{ SIZE_MAX };
+	};
+}
@@ -0,0 +1,90 @@
+#pragma once
+/**
+ * @file MappedRegion.h
+ *
+ * @brief MemEx memory mapped region (file backed)
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//Read-write shared mapping of a file or of a named shared memory segment
+	class MappedRegion {
+	public:
+		MappedRegion() noexcept = default;
+		~MappedRegion() noexcept {
+			Unmap();
+		}
+
+		//Cant copy
+		MappedRegion(const MappedRegion&) = delete;
+		MappedRegion& operator=(const MappedRegion&) = delete;
+
+		//Map the file at [Path], creating it with [Size] bytes if it does not exist (or is empty)
+		//If the file exists it is mapped whole and [Size] is ignored
+		//[PreferredBase] - address to map the file at (nullptr for any), if not available the file is mapped elsewhere
+		//[bOutCreated] - true if the file was created (its content is zero)
+		bool MapFile(const char* Path, size_t Size, ptr_t PreferredBase, bool& bOutCreated) noexcept;
+
+		//Map the existing file at [Path] whole, fails if the file does not exist or is empty (the file is never created)
+		bool MapExistingFile(const char* Path, ptr_t PreferredBase) noexcept;
+
+		//Write to [OutPath] a name next to [Path] that no other process or thread uses, eg. to prepare a file published with PublishFile
+		//Returns false if [OutPath] is too small
+		static bool MakeTempPath(const char* Path, char* OutPath, size_t OutPathSize) noexcept;
+
+		//Rename the file [TempPath] to [Path] in one step, fails if [Path] already exists (it is never replaced)
+		static bool PublishFile(const char* TempPath, const char* Path) noexcept;
+
+		//Map the shared memory segment [Name] (shm_open, named file mapping on Windows), creating it with [Size] bytes if it does not exist
+		//If the segment exists it is mapped whole and [Size] is ignored, fails if the segment is not sized yet by its creator
+		//[bOutCreated] - true if the segment was created (its content is zero), the creator holds the segment lock until
+		//UnlockShared, Unmap or its death, the other processes use it to know if the creator is still initializing the segment
+		bool MapShared(const char* Name, size_t Size, bool& bOutCreated) noexcept;
+
+		//Remove the name of the shared memory segment [Name], the segment lives until unmapped by all the processes
+		//No-op on Windows (the segment is removed when the last process unmaps it)
+		static bool UnlinkShared(const char* Name) noexcept;
+
+		//Take the lock of the mapped shared memory segment without waiting, false if another process holds it
+		//Always false on Windows (a segment abandoned by its creator is removed when the last process unmaps it)
+		bool TryLockShared() noexcept;
+		void UnlockShared() noexcept;
+
+		//Remove the name [Name] only if it still refers to the mapped shared memory segment (and not to a newer one)
+		bool UnlinkSharedIfMapped(const char* Name) noexcept;
+
+		//Write the dirty pages in [Offset, Offset + Size) back to the file and wait for completion
+		bool Flush(size_t Offset, size_t Size) noexcept;
+
+		//Write all the dirty pages back to the file and wait for completion
+		FORCEINLINE bool Flush() noexcept {
+			return Flush(0, Size);
+		}
+
+		void Unmap() noexcept;
+
+		FORCEINLINE uint8_t* GetBase() const noexcept {
+			return Base;
+		}
+
+		FORCEINLINE size_t GetSize() const noexcept {
+			return Size;
+		}
+
+		FORCEINLINE bool IsMapped() const noexcept {
+			return Base != nullptr;
+		}
+
+	private:
+		//Map [Size] bytes of the open file [FileHandle], the region owns the handle (closed on failure)
+		bool MapFileView(intptr_t FileHandle, size_t Size, ptr_t PreferredBase) noexcept;
+
+		uint8_t* PTR	Base{ nullptr };
+		size_t			Size{ 0 };
+		intptr_t		FileHandle{ -1 };
+		intptr_t		MappingHandle{ -1 };
+	};
+}
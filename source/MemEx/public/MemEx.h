@@ -9,7 +9,27 @@ namespace MemEx {
 
 #include "Core.h"
 #include "Tunning.h"
+#include "MemoryOps.h"
 #include "Memory.h"
+#include "ThreadCounters.h"
+#include "MemoryTags.h"
+#include "FragmentationStats.h"
+#include "AllocationTrace.h"
+#include "HeapProfiler.h"
+#include "LargeObjectCache.h"
+#include "DeferredDestruction.h"
 #include "Ptr.h"
 #include "TObjectPool.h"
-#include "MemoryManager.h"
\ No newline at end of file
+#include "MemoryManager.h"
+#include "MHeap.h"
+#include "CowPtr.h"
+#include "THandlePool.h"
+#include "TRecyclingPool.h"
+#include "TMPSCQueue.h"
+#include "TMPMCQueue.h"
+#include "BufferChain.h"
+#include "MappedRegion.h"
+#include "OffsetPtr.h"
+#include "PersistentHeap.h"
+#include "SharedHeap.h"
+#include "CoroutineAllocator.h"
\ No newline at end of file
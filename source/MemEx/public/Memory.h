@@ -11,6 +11,7 @@
 
 namespace MemEx {
 	class MemoryResourceBase;
+	class MHeap;
 
 	//typedef void (*MemoryBlockDestroyCallback)(MemoryResourceBase*);
 	using MemoryBlockDestroyCallback = Delegate<void, ptr_t, bool>;
@@ -26,6 +27,15 @@ namespace MemEx {
 
 			struct {
 				unsigned bDontDestruct : 1;
+
+				//If > 1 the elements are destroyed on this many threads (see MemoryManager::AllocBufferParallel)
+				unsigned DestroyThreadsCount : 8;
+
+				//Memory tag of the block (see MemoryTags)
+				unsigned Tag : 8;
+
+				//The allocation of the block was sampled by the HeapProfiler
+				unsigned bSampled : 1;
 			};
 
 			uint32_t MemoryResourceFlags{ 0 };
@@ -34,9 +44,16 @@ namespace MemEx {
 		//Destroy callback (deleter)
 		MemoryBlockDestroyCallback	Destroy{  };
 
-		template<typename T>
-		friend class MemoryResourcePtrBase;
+		template<typename T, bool bShared>
+		friend class _MPtr;
 		friend class MemoryManager;
+		friend class MHeap;
+		friend class HeapProfiler;
+		friend class DeferredDestruction;
+		template<typename T, size_t MaxWarm>
+		friend class TRecyclingPool;
+		template<typename T, size_t Align>
+		friend class MCowPtr;
 	};
 
 	template<bool bAtomicRef = true>
@@ -78,9 +95,21 @@ namespace MemEx {
 			return false;
 		}
 
-		template<typename T, typename Base>
-		friend class _TSharedPtr;
+		FORCEINLINE uint32_t GetReferenceCount() const noexcept {
+			if constexpr (bAtomicRef) {
+				return static_cast<uint32_t>(__iso_volatile_load32(reinterpret_cast<volatile int*>(&this->RefCount)));
+			}
+			else {
+				return RefCount;
+			}
+		}
+
+		template<typename T, bool bShared>
+		friend class _MPtr;
 		friend class MemoryManager;
+		friend class MSlice;
+		template<typename T, size_t Align>
+		friend class MCowPtr;
 	};
 
 	class MemoryBlockBase : public MemoryResource<true> {
@@ -92,6 +121,9 @@ namespace MemEx {
 		ulong_t					const	ElementsCount{ 1 };
 		uint8_t* PTR					Block{ nullptr };
 
+		//Heap that owns the block, nullptr for the process wide MemoryManager pools
+		MHeap* PTR						Heap{ nullptr };
+
 		MemoryBlockBase(ulong_t BlockSize, uint8_t* Block, ulong_t ElementSize) noexcept
 			:Base()
 			, BlockSize(BlockSize)
@@ -131,10 +163,12 @@ namespace MemEx {
 			return Block + BlockSize;
 		}
 
+		//Destroy the block that owns [Payload] (see GetBlockFromPayload)
+		FORCEINLINE static void DestroyPayload(ptr_t Payload) noexcept;
+
 		FORCEINLINE void ZeroBlockMemory() noexcept {
-			memset(
+			MemZero(
 				Block,
-				0,
 				BlockSize
 			);
 		}
@@ -142,12 +176,22 @@ namespace MemEx {
 
 	using IMemoryBlock = MemoryBlockBase;
 
+	//Distance from a block header to its payload, the same for all the blocks (tier blocks and OS blocks)
+	constexpr size_t BlockHeaderOffset = AlignUp(sizeof(IMemoryBlock), MEMEX_CACHE_LINE_SIZE);
+
+	//Get the block that owns [Payload] (the begining of the block's payload)
+	FORCEINLINE IMemoryBlock* GetBlockFromPayload(const void* Payload) noexcept {
+		return reinterpret_cast<IMemoryBlock*>(reinterpret_cast<size_t>(Payload) - BlockHeaderOffset);
+	}
+
 	template<ulong_t Size>
 	class MemoryBlock : public IMemoryBlock {
-		static_assert(Size% ALIGNMENT == 0, "Size of MemoryBlock<Size> must be a multiple of ALIGNMENT");
+		static_assert(Size% MEMEX_CACHE_LINE_SIZE == 0, "Size of MemoryBlock<Size> must be a multiple of MEMEX_CACHE_LINE_SIZE");
 
 	public:
-		uint8_t		FixedSizeBlock[Size];
+		//Cache line aligned, objects aligned up to MEMEX_CACHE_LINE_SIZE are placed at the begining of the block
+		//without padding and never share a cache line with the header or with a neighbouring block
+		alignas(MEMEX_CACHE_LINE_SIZE) uint8_t		FixedSizeBlock[Size];
 
 		MemoryBlock(ulong_t ElementSize) noexcept
 			: IMemoryBlock(Size, FixedSizeBlock, ElementSize)
@@ -158,35 +202,44 @@ namespace MemEx {
 		{}
 	};
 
+	static_assert(BlockHeaderOffset == MEMEX_CACHE_LINE_SIZE, "The block header must fit in one cache line");
+	static_assert(sizeof(MemoryBlock<MEMEX_CACHE_LINE_SIZE>) == BlockHeaderOffset + MEMEX_CACHE_LINE_SIZE, "MemoryBlock<Size> payload must be at BlockHeaderOffset");
+
 	class CustomBlock : public IMemoryBlock {
 	public:
 		CustomBlock(ulong_t Size, ulong_t ElementSize) noexcept
 			: IMemoryBlock(Size, nullptr, ElementSize)
 		{
-			Block = (uint8_t*)GAllocate(sizeof(uint8_t) * Size, ALIGNMENT);
+			Block = (uint8_t*)GAllocate(sizeof(uint8_t) * Size, MEMEX_CACHE_LINE_SIZE);
 		}
 
 		CustomBlock(ulong_t Size, ulong_t ElementSize, ulong_t ElementsCount) noexcept
 			: IMemoryBlock(Size, nullptr, ElementSize, ElementsCount)
 		{
-			Block = (uint8_t*)GAllocate(sizeof(uint8_t) * Size, ALIGNMENT);
+			Block = (uint8_t*)GAllocate(sizeof(uint8_t) * Size, MEMEX_CACHE_LINE_SIZE);
 		}
 	};
 
+	//Header of an OS block, placed at BlockHeaderOffset before the payload
+	//	[Padding to the payload alignment][CustomBlockHeader][Payload]
 	class CustomBlockHeader : public IMemoryBlock {
 	public:
+		//Size of the header and padding before the payload so that the payload is aligned to [Alignment]
+		static constexpr size_t GetHeaderSize(size_t Alignment) noexcept {
+			return AlignUp(BlockHeaderOffset, Alignment < MEMEX_CACHE_LINE_SIZE ? MEMEX_CACHE_LINE_SIZE : Alignment);
+		}
+
 		CustomBlockHeader(ulong_t Size, ulong_t ElementSize)
 			: IMemoryBlock(Size, nullptr, ElementSize)
 		{
-			Block = (reinterpret_cast<uint8_t*>(this) + sizeof(CustomBlockHeader));
+			Block = (reinterpret_cast<uint8_t*>(this) + BlockHeaderOffset);
 		}
 
 		CustomBlockHeader(ulong_t Size, ulong_t ElementSize, ulong_t ElementsCount)
 			: IMemoryBlock(Size, nullptr, ElementSize, ElementsCount)
 		{
-			Block = (reinterpret_cast<uint8_t*>(this) + sizeof(CustomBlockHeader));
+			Block = (reinterpret_cast<uint8_t*>(this) + BlockHeaderOffset);
 		}
 	};
 
 }
-
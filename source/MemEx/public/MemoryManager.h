@@ -18,6 +18,8 @@ namespace MemEx {
 		using TObjectStore = TObjectPool<T, PoolSize>;
 
 		struct SmallBlock : MemoryBlock<SmallMemBlockSize>, TObjectStore<SmallBlock, SmallMemBlockCount> {
+			static constexpr size_t TierIndex = 0;
+
 			SmallBlock(ulong_t ElementSize) noexcept
 				: MemoryBlock(ElementSize)
 			{}
@@ -27,6 +29,8 @@ namespace MemEx {
 			{}
 		};
 		struct MediumBlock : MemoryBlock<MediumMemBlockSize>, TObjectStore<MediumBlock, MediumMemBlockCount> {
+			static constexpr size_t TierIndex = 1;
+
 			MediumBlock(ulong_t ElementSize) noexcept
 				: MemoryBlock(ElementSize)
 			{}
@@ -36,6 +40,8 @@ namespace MemEx {
 			{}
 		};
 		struct LargeBlock : MemoryBlock<LargeMemBlockSize>, TObjectStore<LargeBlock, LargeMemBlockCount> {
+			static constexpr size_t TierIndex = 2;
+
 			LargeBlock(ulong_t ElementSize) noexcept
 				: MemoryBlock(ElementSize)
 			{}
@@ -45,6 +51,8 @@ namespace MemEx {
 			{}
 		};
 		struct ExtraLargeBlock : MemoryBlock<ExtraLargeMemBlockSize>, TObjectStore<ExtraLargeBlock, ExtraLargeMemBlockCount> {
+			static constexpr size_t TierIndex = 3;
+
 			ExtraLargeBlock(ulong_t ElementSize) noexcept
 				: MemoryBlock(ElementSize)
 			{}
@@ -71,9 +79,21 @@ namespace MemEx {
 			return 0;
 		}
 		static bool Shutdown() noexcept {
+			AllocationTrace::Stop();
+			HeapProfiler::Stop();
+			DeferredDestruction::StopReclaimer();
+			DeferredDestruction::Drain();
+			LargeObjectCache::Trim(true);
+
 			return true;
 		}
 
+		//Destroy up to [MaxCount] blocks queued by threads in deferred mode (see DeferredDestroyScope)
+		//returns the number of blocks destroyed
+		static size_t DrainDeferred(size_t MaxCount = SIZE_MAX) noexcept {
+			return DeferredDestruction::Drain(MaxCount);
+		}
+
 #ifdef MEMEX_STATISTICS
 		static inline std::atomic<size_t> CustomSizeAllocations{ 0 };
 		static inline std::atomic<size_t> CustomSizeDeallocations{ 0 };
@@ -114,90 +134,290 @@ namespace MemEx {
 				SmallBlock::GetTotalOSAllocations() + MediumBlock::GetTotalOSAllocations() + LargeBlock::GetTotalOSAllocations() + ExtraLargeBlock::GetTotalOSAllocations(),
 				SmallBlock::GetTotalOSDeallocations() + MediumBlock::GetTotalOSDeallocations() + LargeBlock::GetTotalOSDeallocations() + ExtraLargeBlock::GetTotalOSDeallocations()
 			);
+			const char* TierNames[FragmentationStats::TiersCount] = { "SmallBlock", "MediumBlock", "LargeBlock", "ExtraLargeBlock", "CustomSize" };
+			for (size_t Tier = 0; Tier < FragmentationStats::TiersCount; Tier++) {
+				const FragmentationStats::TierStatistics TierStats = FragmentationStats::GetTierStatistics(Tier);
+
+				printf("\n\t%s fragmentation:\n\t\tLiveBlocks:%lld\n\t\tBlockBytes:%lld\n\t\tRequestedBytes:%lld\n\t\tHeaderBytes:%lld\n\t\tWastedBytes:%lld\n\t\tRatio:%.3f",
+					TierNames[Tier],
+					TierStats.LiveBlocks,
+					TierStats.BlockBytes,
+					TierStats.RequestedBytes,
+					TierStats.HeaderBytes,
+					TierStats.GetWastedBytes(),
+					TierStats.GetFragmentationRatio()
+				);
+			}
+
+			FragmentationStats::TypeStatistics WorstOffenders[5];
+			const size_t WorstOffendersCount = FragmentationStats::GetWorstOffenders(WorstOffenders, 5);
+			printf("\n\tWorst offenders:");
+			for (size_t i = 0; i < WorstOffendersCount; i++) {
+				printf("\n\t\t%s: LiveBlocks:%lld RequestedBytes:%lld WastedBytes:%lld",
+					WorstOffenders[i].Name,
+					WorstOffenders[i].LiveBlocks,
+					WorstOffenders[i].RequestedBytes,
+					WorstOffenders[i].WastedBytes
+				);
+			}
+
+			for (size_t Tag = 0; Tag < MemoryTagsCount; Tag++) {
+				const MemoryTags::TagStatistics TagStats = MemoryTags::GetStatistics(static_cast<MemoryTag>(Tag));
+				if (!TagStats.TotalAllocations) {
+					continue;
+				}
+
+				printf("\n\tTag[%lld] %s:\n\t\tBytes:%lld\n\t\tBlocks:%lld\n\t\tAllocations:%lld\n\t\tRejected:%lld",
+					Tag,
+					TagStats.Name ? TagStats.Name : "",
+					TagStats.Bytes,
+					TagStats.BlocksCount,
+					TagStats.TotalAllocations,
+					TagStats.TotalRejected
+				);
+			}
+
+			const LargeObjectCache::Statistics LargeObjects = LargeObjectCache::GetStatistics();
+			printf("\n\tLargeObjectCache:\n\t\tHits:%lld\n\t\tMisses:%lld\n\t\tDecommits:%lld\n\t\tReleases:%lld\n\t\tCachedBytes:%lld\n\t\tHotBytes:%lld\n\t\tZeroFillsSkipped:%lld",
+				LargeObjects.Hits,
+				LargeObjects.Misses,
+				LargeObjects.Decommits,
+				LargeObjects.Releases,
+				LargeObjects.CachedBytes,
+				LargeObjects.HotBytes,
+				LargeObjects.ZeroFillsSkipped
+			);
+
+			const DeferredDestruction::Statistics Deferred = DeferredDestruction::GetStatistics();
+			printf("\n\tDeferredDestruction:\n\t\tDepth:%lld\n\t\tMaxDepth:%lld\n\t\tDeferred:%lld\n\t\tDrained:%lld\n\t\tInlineDestroys:%lld",
+				Deferred.Depth,
+				Deferred.MaxDepth,
+				Deferred.TotalDeferred,
+				Deferred.TotalDrained,
+				Deferred.TotalInlineDestroys
+			);
+
+			const HeapProfiler::Statistics Profiler = HeapProfiler::GetStatistics();
+			printf("\n\tHeapProfiler:\n\t\tSampledAllocations:%lld\n\t\tLiveSamples:%lld\n\t\tDroppedSamples:%lld\n\t\tStacks:%lld",
+				Profiler.SampledAllocations,
+				Profiler.LiveSamples,
+				Profiler.DroppedSamples,
+				Profiler.StacksCount
+			);
 			printf("\nMemoryManager ###############################################################\n");
 		}
 #endif
 
-#undef MEMORY_MANAGER_CALL_DESTRUCTOR
-#define MEMORY_MANAGER_CALL_DESTRUCTOR																		\
-			IMemoryBlock* NewBlockObject = (IMemoryBlock*)Object; 											\
-			if constexpr (std::is_destructible_v<T>) {														\
-				if(bCallDestructor && !NewBlockObject->bDontDestruct)	{									\
-					auto Ptr = reinterpret_cast<ptr_t>(NewBlockObject->Block);								\
-																											\
-					size_t Space = sizeof(T) + alignof(T);													\
-					std::align(alignof(T), sizeof(T), Ptr, Space);											\
-																											\
-					/*call destructor*/																		\
-					reinterpret_cast<T*>(Ptr)->~T();														\
-				}																							\
-			}
-
-#undef MEMORY_MANAGER_CALL_DESTRUCTOR_BUFFER
-#define MEMORY_MANAGER_CALL_DESTRUCTOR_BUFFER																\
-			IMemoryBlock* NewBlockObject = (IMemoryBlock*)Object; 											\
-			if constexpr (std::is_destructible_v<T>) {														\
-				if(bCallDestructor && !NewBlockObject->bDontDestruct)	{									\
-					auto Ptr = reinterpret_cast<ptr_t>(NewBlockObject->Block);								\
-																											\
-					size_t Space = NewBlockObject->BlockSize;												\
-					std::align(alignof(T), sizeof(T), Ptr, Space);											\
-																											\
-					for(size_t i = 0; i < NewBlockObject->ElementsCount; i ++) {							\
-						/*call destructor*/																	\
-						T* IPtr = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(Ptr) + (sizeof(T) * i));	\
-						/*call destructor*/																	\
-						IPtr->~T();																			\
-					}																						\
-				}																							\
+		//Validate [Align] as the alignment of T
+		template<typename T, size_t Align>
+		static constexpr void ValidateAlignment() noexcept {
+			static_assert(IsPowerOf2(Align), "Alignment must be a power of 2!");
+			static_assert(Align >= alignof(T), "Alignment must be at least alignof(T)!");
+			static_assert(Align <= MEMEX_PAGE_SIZE, "Alignment must be at most MEMEX_PAGE_SIZE!");
+		}
+
+		//Largest payload of a block, the sizes are stored as ulong_t (32 bits on Windows)
+		static constexpr size_t MaxBlockSize = sizeof(ulong_t) < sizeof(size_t) ? static_cast<size_t>(static_cast<ulong_t>(-1)) : SIZE_MAX / 2;
+
+		//False if T[Count] does not fit a block (sizeof(T) * Count overflows or exceeds MaxBlockSize)
+		template<typename T>
+		FORCEINLINE static constexpr bool IsValidCount(size_t Count) noexcept {
+			return Count <= MaxBlockSize / sizeof(T);
+		}
+
+		//Call T destructor for each element in the block, nothing to do for trivially destructible T's
+		template<typename T>
+		FORCEINLINE static void DestroyElements(IMemoryBlock* BlockObject, bool bCallDestructor) noexcept {
+			if constexpr (std::is_destructible_v<T> && !std::is_trivially_destructible_v<T>) {
+				if (bCallDestructor && !BlockObject->bDontDestruct) {
+					//The payload is always placed at the begining of the block (see AllocBlock)
+					T* Ptr = reinterpret_cast<T*>(BlockObject->Block);
+
+					if (BlockObject->DestroyThreadsCount > 1) {
+						ParallelForPages(Ptr, BlockObject->ElementsCount, BlockObject->DestroyThreadsCount, [](T* Begin, T* End) {
+							for (; Begin != End; ++Begin) {
+								//call destructor
+								Begin->~T();
+							}
+						});
+						return;
+					}
+
+					for (size_t i = 0; i < BlockObject->ElementsCount; i++) {
+						//call destructor
+						Ptr[i].~T();
+					}
+				}
 			}
+		}
 
-#pragma region Compiletime
+		//Split T[Count] at the page aligned [Ptr] into [ThreadsCount] contiguous ranges with page aligned boundaries
+		//and run [Work](Begin, End) for each range on its own thread
+		template<typename T, typename TWork>
+		static void ParallelForPages(T* Ptr, size_t Count, size_t ThreadsCount, const TWork& Work) noexcept {
+			const size_t PagesCount = AlignUp(sizeof(T) * Count, MEMEX_PAGE_SIZE) / MEMEX_PAGE_SIZE;
+			const size_t PagesPerThread = (PagesCount + ThreadsCount - 1) / ThreadsCount;
+
+			//Index of the first element that starts in or after [Page]
+			auto FirstElementOfPage = [Count](size_t Page) -> size_t {
+				const size_t Index = ((Page * MEMEX_PAGE_SIZE) + sizeof(T) - 1) / sizeof(T);
+				return Index < Count ? Index : Count;
+			};
+
+			RunParallel(ThreadsCount, [&](size_t ThreadIndex) {
+				const size_t Begin = FirstElementOfPage(ThreadIndex * PagesPerThread);
+				const size_t End = FirstElementOfPage((ThreadIndex + 1) * PagesPerThread);
+
+				if (Begin < End) {
+					Work(Ptr + Begin, Ptr + End);
+				}
+			});
+		}
 
+		//Construct T at [Ptr]
 		template<typename T, typename ...Types>
-		inline static MSharedPtr<T> AllocShared(Types... Args) noexcept {
-			if constexpr (std::is_reference_v<T>) {
-				static_assert(false, "Alloc<T> Cant allocate T reference!");
-			}
+		FORCEINLINE static void Construct(ptr_t Ptr, Types&&... Args) noexcept {
+			if constexpr (sizeof...(Types) == 0) {
+				if constexpr (std::is_default_constructible_v<std::decay_t<T>>) {
 
-			if constexpr (std::is_array_v<T>) {
-				static_assert(false, "Use AllocBuffer(Count) to allocate arrays!");
+					//Call default constructor manually
+					new (Ptr) T();
+				}
 			}
+			else {
+				//Call constructor manually
+				new (Ptr) T(std::forward<Types>(Args)...);
+			}
+		}
 
-			constexpr size_t Size = sizeof(T) + alignof(T);
+		//Allocate a block from the tier pool TBlock
+		//[bZeroed] - the payload (ElementSize * ElementsCount bytes) is zero filled, tier blocks are recycled and always dirty
+		template<typename TBlock, typename T>
+		static IMemoryBlock* AllocTierBlock(ulong_t ElementSize, ulong_t ElementsCount, bool bZeroed = false) noexcept {
+			const MemoryTag Tag = MemoryTags::GetThreadTag();
+			if (!MemoryTags::OnAllocate(Tag, sizeof(TBlock))) {
+				return nullptr;
+			}
 
-			MemoryBlockBase* NewBlockObject = MemoryManager::AllocBlock<T>();
+			IMemoryBlock* NewBlockObject = TBlock::NewRaw(ElementSize, ElementsCount);
 			if (!NewBlockObject) {
-				return { nullptr , nullptr };
+				//LogFatal("MemoryManager::Alloc() TBlock::NewRaw() Failed!");
+				MemoryTags::OnFree(Tag, sizeof(TBlock));
+				return nullptr;
 			}
 
-			ptr_t Ptr = NewBlockObject->Block;
+			if (bZeroed) {
+				MemZero(NewBlockObject->Block, static_cast<size_t>(ElementSize) * ElementsCount);
+			}
+
+			NewBlockObject->Tag = Tag;
+			NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) -> void {
+				IMemoryBlock* BlockObject = reinterpret_cast<IMemoryBlock*>(Object);
+
+#ifdef MEMEX_STATISTICS
+				FragmentationStats::OnFree(TBlock::TierIndex, FragmentationStats::GetTypeIndex<T>(), sizeof(TBlock),
+					static_cast<size_t>(BlockObject->ElementSize) * BlockObject->ElementsCount, sizeof(TBlock) - BlockObject->BlockSize);
+#endif
+
+				AllocationTrace::OnFree(BlockObject, TBlock::TierIndex, static_cast<size_t>(BlockObject->ElementSize) * BlockObject->ElementsCount);
+				HeapProfiler::OnFree(BlockObject);
+
+				DestroyElements<T>(BlockObject, bCallDestructor);
+				MemoryTags::OnFree(static_cast<MemoryTag>(BlockObject->Tag), sizeof(TBlock));
+				TBlock::Deallocate(static_cast<TBlock*>(BlockObject));
+			};
+
+#ifdef MEMEX_STATISTICS
+			FragmentationStats::OnAllocate(TBlock::TierIndex, FragmentationStats::GetTypeIndex<T>(), sizeof(TBlock),
+				static_cast<size_t>(ElementSize) * ElementsCount, sizeof(TBlock) - NewBlockObject->BlockSize);
+#endif
 
-			//Align pointer
-			size_t Space = Size;
-			if (!std::align(alignof(T), sizeof(T), Ptr, Space)) {
-				NewBlockObject->Destroy((ptr_t)NewBlockObject, false);
-				//LogFatal("MemoryManager::Alloc(...) Failed to std::align({}, {}, ptr, {})!", alignof(T), sizeof(T), Size);
-				return { nullptr , nullptr };
+			AllocationTrace::OnAllocate(NewBlockObject, TBlock::TierIndex, static_cast<size_t>(ElementSize) * ElementsCount);
+			HeapProfiler::OnAllocate(NewBlockObject, static_cast<size_t>(ElementSize) * ElementsCount);
+
+			return NewBlockObject;
+		}
+
+		//Allocate a dedicated OS block of [Size] bytes, the payload is aligned to [Align]
+		//[bZeroed] - the payload is zero filled, skipped for large blocks known to be zero (see LargeObjectCache)
+		template<typename T, size_t Align>
+		static IMemoryBlock* AllocCustomBlock(size_t Size, ulong_t ElementsCount, bool bZeroed = false) noexcept {
+			constexpr size_t HeaderSize = CustomBlockHeader::GetHeaderSize(Align);
+			constexpr size_t BlockAlignment = Align < MEMEX_CACHE_LINE_SIZE ? MEMEX_CACHE_LINE_SIZE : Align;
+
+			const MemoryTag Tag = MemoryTags::GetThreadTag();
+			if (!MemoryTags::OnAllocate(Tag, HeaderSize + Size)) {
+				return nullptr;
 			}
 
-			if constexpr (sizeof...(Types) == 0) {
-				if constexpr (std::is_default_constructible_v<std::decay<T>::type>) {
+			uint8_t* OSBlock;
 
-					//Call default constructor manually
-					new (Ptr) T();
-				}
+			//Large blocks are served by the LargeObjectCache (page aligned spans)
+			if (LargeObjectCache::IsLargeSize(HeaderSize + Size)) {
+				OSBlock = (uint8_t*)LargeObjectCache::Allocate(HeaderSize + Size, bZeroed);
 			}
 			else {
-				//Call constructor manually
-				new (Ptr) T(std::forward<Types...>(Args)...);
+				OSBlock = (uint8_t*)GAllocate(HeaderSize + Size, BlockAlignment);
+
+				if (OSBlock && bZeroed) {
+					MemZero(OSBlock + HeaderSize, Size);
+				}
+			}
+
+			if (!OSBlock) {
+				//LogFatal("MemoryManager::Alloc() Failed to get memory from OS!");
+				MemoryTags::OnFree(Tag, HeaderSize + Size);
+				return nullptr;
 			}
 
-			return { NewBlockObject, reinterpret_cast<T*>(Ptr) };
+			//Construct the CustomBlockHeader right before the payload
+			IMemoryBlock* NewBlockObject = new (OSBlock + HeaderSize - BlockHeaderOffset) CustomBlockHeader((ulong_t)Size, (ulong_t)sizeof(T), ElementsCount);
+			NewBlockObject->Tag = Tag;
+
+			//Set the destruction handler
+			NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) -> void {
+				IMemoryBlock* BlockObject = reinterpret_cast<IMemoryBlock*>(Object);
+
+#ifdef MEMEX_STATISTICS
+				FragmentationStats::OnFree(FragmentationStats::CustomTier, FragmentationStats::GetTypeIndex<T>(), HeaderSize + BlockObject->BlockSize,
+					static_cast<size_t>(BlockObject->ElementSize) * BlockObject->ElementsCount, HeaderSize);
+#endif
+
+				AllocationTrace::OnFree(BlockObject, FragmentationStats::CustomTier, BlockObject->BlockSize);
+				HeapProfiler::OnFree(BlockObject);
+
+				DestroyElements<T>(BlockObject, bCallDestructor);
+				MemoryTags::OnFree(static_cast<MemoryTag>(BlockObject->Tag), HeaderSize + BlockObject->BlockSize);
+
+#ifdef MEMEX_STATISTICS
+				CustomSizeDeallocations++;
+#endif
+				uint8_t* OSBlock = reinterpret_cast<uint8_t*>(BlockObject) + BlockHeaderOffset - HeaderSize;
+				if (LargeObjectCache::IsLargeSize(HeaderSize + BlockObject->BlockSize)) {
+					LargeObjectCache::Free(OSBlock, HeaderSize + BlockObject->BlockSize);
+				}
+				else {
+					GFree(OSBlock);
+				}
+			};
+
+#ifdef MEMEX_STATISTICS
+			CustomSizeAllocations++;
+
+			FragmentationStats::OnAllocate(FragmentationStats::CustomTier, FragmentationStats::GetTypeIndex<T>(), HeaderSize + Size,
+				static_cast<size_t>(sizeof(T)) * ElementsCount, HeaderSize);
+#endif
+
+			AllocationTrace::OnAllocate(NewBlockObject, FragmentationStats::CustomTier, Size);
+			HeapProfiler::OnAllocate(NewBlockObject, Size);
+
+			return NewBlockObject;
 		}
 
-		template<typename T, typename ...Types>
-		inline static MPtr<T> Alloc(Types... Args) noexcept {
+#pragma region Compiletime
+
+		template<typename T, size_t Align, typename ...Types>
+		inline static MSharedPtr<T> AllocSharedAligned(Types... Args) noexcept {
 			if constexpr (std::is_reference_v<T>) {
 				static_assert(false, "Alloc<T> Cant allocate T reference!");
 			}
@@ -206,226 +426,167 @@ namespace MemEx {
 				static_assert(false, "Use AllocBuffer(Count) to allocate arrays!");
 			}
 
-			constexpr size_t Size = sizeof(T) + alignof(T);
-
-			MemoryBlockBase* NewBlockObject = AllocBlock<T>();
+			MemoryBlockBase* NewBlockObject = MemoryManager::AllocBlock<T, Align>();
 			if (!NewBlockObject) {
-				return { nullptr , nullptr };
+				return { };
 			}
 
 			ptr_t Ptr = NewBlockObject->Block;
 
-			//Align pointer
-			size_t Space = Size;
-			if (!std::align(alignof(T), sizeof(T), Ptr, Space)) {
-				NewBlockObject->Destroy((ptr_t)NewBlockObject, false);
-				//LogFatal("MemoryManager::Alloc(...) Failed to std::align({}, {}, ptr, {})!", alignof(T), sizeof(T), Size);
-				return { nullptr , nullptr };
+			Construct<T>(Ptr, std::forward<Types>(Args)...);
+
+			return MSharedPtr<T>(reinterpret_cast<T*>(Ptr));
+		}
+
+		template<typename T, typename ...Types>
+		inline static MSharedPtr<T> AllocShared(Types... Args) noexcept {
+			return AllocSharedAligned<T, alignof(T)>(std::forward<Types>(Args)...);
+		}
+
+		// Allocate T aligned to [Align] (power of 2, alignof(T) <= Align <= MEMEX_PAGE_SIZE)
+		template<typename T, size_t Align, typename ...Types>
+		inline static MPtr<T> AllocAligned(Types... Args) noexcept {
+			if constexpr (std::is_reference_v<T>) {
+				static_assert(false, "Alloc<T> Cant allocate T reference!");
 			}
 
-			if constexpr (sizeof...(Types) == 0) {
-				if constexpr (std::is_default_constructible_v<std::decay<T>::type>) {
+			if constexpr (std::is_array_v<T>) {
+				static_assert(false, "Use AllocBuffer(Count) to allocate arrays!");
+			}
 
-					//Call default constructor manually
-					new (Ptr) T();
-				}
+			MemoryBlockBase* NewBlockObject = AllocBlock<T, Align>();
+			if (!NewBlockObject) {
+				return { };
 			}
-			else {
-				//Call constructor manually
-				new (Ptr) T(std::forward<Types...>(Args)...);
+
+			ptr_t Ptr = NewBlockObject->Block;
+
+			Construct<T>(Ptr, std::forward<Types>(Args)...);
+
+			return MPtr<T>(reinterpret_cast<T*>(Ptr));
+		}
+
+		template<typename T, typename ...Types>
+		inline static MPtr<T> Alloc(Types... Args) noexcept {
+			return AllocAligned<T, alignof(T)>(std::forward<Types>(Args)...);
+		}
+
+		// Allocate T on zero filled storage, a non trivial default constructor is then called on the zeroed storage
+		template<typename T, size_t Align = alignof(T)>
+		inline static MPtr<T> AllocZeroed() noexcept {
+			if constexpr (std::is_array_v<T>) {
+				static_assert(false, "Use AllocBufferZeroed(Count) to allocate arrays!");
 			}
 
-			return { NewBlockObject, reinterpret_cast<T*>(Ptr) };
+			IMemoryBlock* NewBlockObject = AllocBlock<T, Align>(1, true);
+			if (!NewBlockObject) {
+				return { };
+			}
+
+			ptr_t Ptr = NewBlockObject->Block;
+
+			if constexpr (!std::is_trivially_default_constructible_v<T>) {
+				Construct<T>(Ptr);
+			}
+
+			return MPtr<T>(reinterpret_cast<T*>(Ptr));
 		}
 
-		template<typename T>
+		// Allocate T accounted under [Tag] instead of the calling thread's tag (see MemoryTagScope)
+		template<typename T, typename ...Types>
+		inline static MPtr<T> AllocTagged(MemoryTag Tag, Types... Args) noexcept {
+			MemoryTagScope Scope(Tag);
+			return AllocAligned<T, alignof(T)>(std::forward<Types>(Args)...);
+		}
+
+		//Allocate a block for T
+		//	Align <= MEMEX_CACHE_LINE_SIZE: the smallest tier that fits sizeof(T), the payload is at the begining of the block
+		//	Align >  MEMEX_CACHE_LINE_SIZE: a dedicated OS block with the header padded to [Align]
+		template<typename T, size_t Align = alignof(T)>
 		static IMemoryBlock* AllocBlock() noexcept {
-			constexpr size_t Size = sizeof(T) + alignof(T);
+			ValidateAlignment<T, Align>();
 
-			IMemoryBlock* NewBlockObject = nullptr;
+			constexpr size_t Size = sizeof(T);
 
-			if constexpr (Size <= SmallMemBlockSize)
+			if constexpr (Align > MEMEX_CACHE_LINE_SIZE)
 			{
-				NewBlockObject = SmallBlock::NewRaw((ulong_t)Size);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() SmallBlock::NewRaw() Failed!");
-					return nullptr;
-				}
-
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true)  -> void {
-					MEMORY_MANAGER_CALL_DESTRUCTOR;
-					SmallBlock::Deallocate(reinterpret_cast<SmallBlock*>(NewBlockObject));
-				};
+				return AllocCustomBlock<T, Align>(Size, 1);
+			}
+			else if constexpr (Size <= SmallMemBlockSize)
+			{
+				return AllocTierBlock<SmallBlock, T>((ulong_t)Size, 1);
 			}
 			else if constexpr (Size <= MediumMemBlockSize)
 			{
-				NewBlockObject = MediumBlock::NewRaw((ulong_t)Size);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() MediumBlock::NewRaw() Failed!");
-					return nullptr;
-				}
-
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-					MEMORY_MANAGER_CALL_DESTRUCTOR;
-					MediumBlock::Deallocate(reinterpret_cast<MediumBlock*>(NewBlockObject));
-				};
+				return AllocTierBlock<MediumBlock, T>((ulong_t)Size, 1);
 			}
 			else if constexpr (Size <= LargeMemBlockSize)
 			{
-				NewBlockObject = LargeBlock::NewRaw((ulong_t)Size);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() LargeBlock::NewRaw() Failed!");
-					return nullptr;
-				}
-
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-					MEMORY_MANAGER_CALL_DESTRUCTOR;
-					LargeBlock::Deallocate(reinterpret_cast<LargeBlock*>(NewBlockObject));
-				};
+				return AllocTierBlock<LargeBlock, T>((ulong_t)Size, 1);
 			}
 			else if constexpr (Size <= ExtraLargeMemBlockSize)
 			{
-				NewBlockObject = ExtraLargeBlock::NewRaw((ulong_t)Size);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() ExtraLargeBlock::NewRaw() Failed!");
-					return nullptr;
-				}
-
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-					MEMORY_MANAGER_CALL_DESTRUCTOR;
-					ExtraLargeBlock::Deallocate(reinterpret_cast<ExtraLargeBlock*>(NewBlockObject));
-				};
+				return AllocTierBlock<ExtraLargeBlock, T>((ulong_t)Size, 1);
 			}
 			else {
-				NewBlockObject = (IMemoryBlock*)GAllocate(sizeof(CustomBlockHeader) + Size, ALIGNMENT);
-				if (NewBlockObject)
-				{
-					//Construct the CustomBlockHeader at the begining of the block
-					new (reinterpret_cast<CustomBlockHeader*>(NewBlockObject)) CustomBlockHeader(Size, Size);
-
-					//Set the destruction handler
-					NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-						MEMORY_MANAGER_CALL_DESTRUCTOR;
-
-#ifdef MEMORY_STATISTICS
-						CustomSizeDeallocations++;
-#endif
-						GFree(NewBlockObject);
-					};
-
-#ifdef MEMORY_STATISTICS
-					CustomSizeAllocations++;
-#endif
-				}
-				else {
-					//LogFatal("MemoryManager::Alloc() Failed to get memory from OS!");
-					return nullptr;
-				}
+				return AllocCustomBlock<T, Align>(Size, 1);
 			}
-
-			return NewBlockObject;
 		}
 #pragma endregion
 
 #pragma region Runtime
-		template<typename T>
-		static IMemoryBlock* AllocBlock(size_t Count) noexcept {
-			const size_t Size = (sizeof(T) * Count) + alignof(T);
+		//[bZeroed] - the payload (sizeof(T) * Count bytes) is zero filled
+		template<typename T, size_t Align = alignof(T)>
+		static IMemoryBlock* AllocBlock(size_t Count, bool bZeroed = false) noexcept {
+			ValidateAlignment<T, Align>();
 
-			IMemoryBlock* NewBlockObject = nullptr;
-
-			if (Size <= SmallMemBlockSize)
-			{
-				NewBlockObject = SmallBlock::NewRaw((ulong_t)sizeof(T), (ulong_t)Count);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() SmallBlock::NewRaw() Failed!");
-					return nullptr;
-				}
-
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-					MEMORY_MANAGER_CALL_DESTRUCTOR_BUFFER;
-					SmallBlock::Deallocate(reinterpret_cast<SmallBlock*>(NewBlockObject));
-				};
+			if (!IsValidCount<T>(Count)) {
+				return nullptr;
 			}
-			else if (Size <= MediumMemBlockSize)
-			{
-				NewBlockObject = MediumBlock::NewRaw((ulong_t)sizeof(T), (ulong_t)Count);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() MediumBlock::NewRaw() Failed!");
-					return nullptr;
-				}
 
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-					MEMORY_MANAGER_CALL_DESTRUCTOR_BUFFER;
-					MediumBlock::Deallocate(reinterpret_cast<MediumBlock*>(NewBlockObject));
-				};
-			}
-			else if (Size <= LargeMemBlockSize)
-			{
-				NewBlockObject = LargeBlock::NewRaw((ulong_t)sizeof(T), (ulong_t)Count);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() LargeBlock::NewRaw() Failed!");
-					return nullptr;
-				}
+			const size_t Size = sizeof(T) * Count;
 
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-					MEMORY_MANAGER_CALL_DESTRUCTOR_BUFFER;
-					LargeBlock::Deallocate(reinterpret_cast<LargeBlock*>(NewBlockObject));
-				};
-			}
-			else if (Size <= ExtraLargeMemBlockSize)
+			if constexpr (Align > MEMEX_CACHE_LINE_SIZE)
 			{
-				NewBlockObject = ExtraLargeBlock::NewRaw((ulong_t)sizeof(T), (ulong_t)Count);
-				if (!NewBlockObject) {
-					//LogFatal("MemoryManager::Alloc() ExtraLargeBlock::NewRaw() Failed!");
-					return nullptr;
-				}
-
-				NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-					MEMORY_MANAGER_CALL_DESTRUCTOR_BUFFER;
-					ExtraLargeBlock::Deallocate(reinterpret_cast<ExtraLargeBlock*>(NewBlockObject));
-				};
+				return AllocCustomBlock<T, Align>(Size, (ulong_t)Count, bZeroed);
 			}
 			else {
-				NewBlockObject = (IMemoryBlock*)GAllocate(sizeof(CustomBlockHeader) + Size, ALIGNMENT);
-				if (NewBlockObject)
+				if (Size <= SmallMemBlockSize)
 				{
-					//Construct the CustomBlockHeader at the begining of the block
-					new (reinterpret_cast<CustomBlockHeader*>(NewBlockObject)) CustomBlockHeader((ulong_t)Size, (ulong_t)sizeof(T), (ulong_t)Count);
-
-					NewBlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) {
-						MEMORY_MANAGER_CALL_DESTRUCTOR_BUFFER;
-
-#ifdef MEMORY_STATISTICS
-						CustomSizeDeallocations++;
-#endif
-						GFree(NewBlockObject);
-					};
-
-#ifdef MEMORY_STATISTICS
-					CustomSizeAllocations++;
-#endif
+					return AllocTierBlock<SmallBlock, T>((ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
 				}
-				else {
-					//LogFatal("MemoryManager::Alloc() Failed to get memory from OS!");
-					return nullptr;
+				else if (Size <= MediumMemBlockSize)
+				{
+					return AllocTierBlock<MediumBlock, T>((ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
+				}
+				else if (Size <= LargeMemBlockSize)
+				{
+					return AllocTierBlock<LargeBlock, T>((ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
+				}
+				else if (Size <= ExtraLargeMemBlockSize)
+				{
+					return AllocTierBlock<ExtraLargeBlock, T>((ulong_t)sizeof(T), (ulong_t)Count, bZeroed);
 				}
-			}
 
-			return NewBlockObject;
+				return AllocCustomBlock<T, Align>(Size, (ulong_t)Count, bZeroed);
+			}
 		}
 
 		// Allocate T[Size] buffer
 		// bDontConstructElements - if true the call to T default constructor (for each element) wont be made
-		template<typename T, bool bDontConstructElements = false>
+		// Align - alignment of the first element (power of 2, alignof(T) <= Align <= MEMEX_PAGE_SIZE)
+		template<typename T, bool bDontConstructElements = false, size_t Align = alignof(T)>
 		static MPtr<T> AllocBuffer(const size_t Count) noexcept {
 			if constexpr (std::is_array_v<T>) {
 				static_assert(false, "Dont use AllocBuffer<T[]>(size) but use AllocBuffer<T>(size)!");
 			}
 
-			IMemoryBlock* NewBlockObject = AllocBlock<T>(Count);
+			//Value initialization of trivial T's is zero initialization
+			constexpr bool bZeroed = std::is_trivially_default_constructible_v<T> && !bDontConstructElements;
+
+			IMemoryBlock* NewBlockObject = AllocBlock<T, Align>(Count, bZeroed);
 			if (!NewBlockObject) {
-				return { nullptr , nullptr };
+				return { };
 			}
 
 			//if we dont construct, we dont destruct 
@@ -433,56 +594,217 @@ namespace MemEx {
 				NewBlockObject->bDontDestruct = true;
 			}
 
-			//Change to size in bytes
-			const size_t Size = (sizeof(T) * Count) + alignof(T);
-
 			ptr_t Ptr = reinterpret_cast<ptr_t>(NewBlockObject->Block);
 
-			//Align pointer
-			size_t Space = Size;
-			if (!std::align(alignof(T), sizeof(T), Ptr, Space)) {
-				if constexpr (!bDontConstructElements && std::is_destructible_v<T>) {
-					NewBlockObject->Destroy((ptr_t)NewBlockObject, false);
+			if constexpr (std::is_default_constructible_v<T> && !bDontConstructElements) {
+				if constexpr (!std::is_trivially_default_constructible_v<T>) {
+					//Call default constructor manually for each object of the array
+					for (size_t i = 0; i < Count; i++)
+					{
+						new (reinterpret_cast<uint8_t*>(Ptr) + (sizeof(T) * i)) T();
+					}
 				}
+			}
+
+			return MPtr<T>(reinterpret_cast<T*>(Ptr));
+		}
 
-				//LogFatal("MemoryManager::AllocBuffer({}) Failed to std::align({}, {}, ptr, {})!", Count, alignof(T), sizeof(T), Size);
-				return { nullptr , nullptr };
+		// Allocate T[Size] buffer, the elements are constructed on [ThreadsCount] threads (0 - hardware concurrency)
+		// The buffer is page aligned and split in contiguous page aligned ranges, one per thread, so the pages are faulted
+		// concurrently and first-touch places each range on the memory node of the thread that initialized it
+		// bParallelDestroy - if true the elements are also destroyed on [ThreadsCount] threads
+		// Buffers smaller than ParallelInitThreshold are constructed on the calling thread
+		template<typename T>
+		static MPtr<T> AllocBufferParallel(const size_t Count, size_t ThreadsCount = 0, bool bParallelDestroy = false) noexcept {
+			if constexpr (std::is_array_v<T>) {
+				static_assert(false, "Dont use AllocBufferParallel<T[]>(size) but use AllocBufferParallel<T>(size)!");
 			}
 
-			if constexpr (std::is_default_constructible_v<T> && !bDontConstructElements) {
-				//Call default constructor manually for each object of the array
-				for (size_t i = 0; i < Count; i++)
-				{
-					new (reinterpret_cast<uint8_t*>(Ptr) + (sizeof(T) * i)) T();
+			if (sizeof(T) * Count < ParallelInitThreshold) {
+				return AllocBuffer<T>(Count);
+			}
+
+			if (ThreadsCount == 0) {
+				ThreadsCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+			}
+			if (ThreadsCount > 255) {
+				ThreadsCount = 255;
+			}
+
+			constexpr size_t Align = alignof(T) > MEMEX_PAGE_SIZE ? alignof(T) : MEMEX_PAGE_SIZE;
+
+			IMemoryBlock* NewBlockObject = AllocBlock<T, Align>(Count);
+			if (!NewBlockObject) {
+				return { };
+			}
+
+			T* Ptr = reinterpret_cast<T*>(NewBlockObject->Block);
+
+			if constexpr (std::is_default_constructible_v<T>) {
+				ParallelForPages(Ptr, Count, ThreadsCount, [](T* Begin, T* End) {
+					if constexpr (std::is_trivially_default_constructible_v<T>) {
+						//Value initialization of trivial T's is zero initialization
+						MemZero(Begin, sizeof(T) * (End - Begin));
+					}
+					else {
+						for (; Begin != End; ++Begin) {
+							new (Begin) T();
+						}
+					}
+				});
+			}
+
+			if (bParallelDestroy && ThreadsCount > 1) {
+				NewBlockObject->DestroyThreadsCount = static_cast<unsigned>(ThreadsCount);
+			}
+
+			return MPtr<T>(Ptr);
+		}
+
+		// Allocate T[Size] buffer with each element copy constructed from [Value]
+		// Trivially copyable T's of size 1, 2, 4, 8 or 16 are filled with vector stores
+		template<typename T, size_t Align = alignof(T)>
+		static MPtr<T> AllocBufferFilled(const size_t Count, const T& Value) noexcept {
+			if constexpr (std::is_array_v<T>) {
+				static_assert(false, "Dont use AllocBufferFilled<T[]>(size, value) but use AllocBufferFilled<T>(size, value)!");
+			}
+
+			IMemoryBlock* NewBlockObject = AllocBlock<T, Align>(Count);
+			if (!NewBlockObject) {
+				return { };
+			}
+
+			T* Ptr = reinterpret_cast<T*>(NewBlockObject->Block);
+
+			MemFill(Ptr, Count, Value);
+
+			return MPtr<T>(Ptr);
+		}
+
+		// Allocate T[Size] buffer on zero filled storage, a non trivial default constructor is then called for each element
+		// The fill is skipped for large buffers on pages known to be zero (fresh or decommitted, see LargeObjectCache),
+		// recycled blocks are cleared with vector stores
+		template<typename T, size_t Align = alignof(T)>
+		static MPtr<T> AllocBufferZeroed(const size_t Count) noexcept {
+			if constexpr (std::is_array_v<T>) {
+				static_assert(false, "Dont use AllocBufferZeroed<T[]>(size) but use AllocBufferZeroed<T>(size)!");
+			}
+
+			IMemoryBlock* NewBlockObject = AllocBlock<T, Align>(Count, true);
+			if (!NewBlockObject) {
+				return { };
+			}
+
+			T* Ptr = reinterpret_cast<T*>(NewBlockObject->Block);
+
+			if constexpr (!std::is_trivially_default_constructible_v<T>) {
+				for (size_t i = 0; i < Count; i++) {
+					new (Ptr + i) T();
 				}
 			}
 
-			return { NewBlockObject, reinterpret_cast<T*>(Ptr) };
+			return MPtr<T>(Ptr);
 		}
 
-		template<typename T>
+		// Allocate T[Size] buffer accounted under [Tag] instead of the calling thread's tag (see MemoryTagScope)
+		template<typename T, bool bDontConstructElements = false, size_t Align = alignof(T)>
+		static MPtr<T> AllocBufferTagged(MemoryTag Tag, const size_t Count) noexcept {
+			MemoryTagScope Scope(Tag);
+			return AllocBuffer<T, bDontConstructElements, Align>(Count);
+		}
+
+		template<typename T, size_t Align = alignof(T)>
 		static MSharedPtr<T> AllocSharedBuffer(size_t Count) noexcept {
-			MPtr<T> Unique = AllocBuffer<T>(Count);
+			MPtr<T> Unique = AllocBuffer<T, false, Align>(Count);
 			if (Unique.IsNull()) {
-				return { nullptr, nullptr };
+				return { };
+			}
+
+			return MSharedPtr<T>(std::move(Unique));
+		}
+
+		// Allocate [Size] raw bytes (MEMEX_CACHE_LINE_SIZE aligned) from the smallest tier pool that fits
+		// No block header is written, the whole tier block is usable storage, FreeRaw must be given the same [Size]
+		static ptr_t AllocRaw(size_t Size) noexcept {
+			ptr_t Ptr;
+			size_t Tier;
+
+			if (Size <= sizeof(SmallBlock)) {
+				Ptr = SmallBlock::AllocateRaw();
+				Tier = SmallBlock::TierIndex;
+			}
+			else if (Size <= sizeof(MediumBlock)) {
+				Ptr = MediumBlock::AllocateRaw();
+				Tier = MediumBlock::TierIndex;
+			}
+			else if (Size <= sizeof(LargeBlock)) {
+				Ptr = LargeBlock::AllocateRaw();
+				Tier = LargeBlock::TierIndex;
+			}
+			else if (Size <= sizeof(ExtraLargeBlock)) {
+				Ptr = ExtraLargeBlock::AllocateRaw();
+				Tier = ExtraLargeBlock::TierIndex;
+			}
+			else {
+#ifdef MEMEX_STATISTICS
+				CustomSizeAllocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+				Ptr = LargeObjectCache::Allocate(Size);
+				Tier = FragmentationStats::CustomTier;
+			}
+
+			if (Ptr) {
+				AllocationTrace::OnAllocateRaw(Ptr, Tier, Size);
 			}
 
-			T* Ptr = Unique.Get();
-			return { Unique.BlockObject.Release(), Ptr };
+			return Ptr;
+		}
+
+		// Free [Ptr] obtained from AllocRaw([Size]), the tier is selected by [Size]
+		static void FreeRaw(ptr_t Ptr, size_t Size) noexcept {
+			if (Size <= sizeof(SmallBlock)) {
+				AllocationTrace::OnFreeRaw(Ptr, SmallBlock::TierIndex, Size);
+				SmallBlock::DeallocateRaw(Ptr);
+			}
+			else if (Size <= sizeof(MediumBlock)) {
+				AllocationTrace::OnFreeRaw(Ptr, MediumBlock::TierIndex, Size);
+				MediumBlock::DeallocateRaw(Ptr);
+			}
+			else if (Size <= sizeof(LargeBlock)) {
+				AllocationTrace::OnFreeRaw(Ptr, LargeBlock::TierIndex, Size);
+				LargeBlock::DeallocateRaw(Ptr);
+			}
+			else if (Size <= sizeof(ExtraLargeBlock)) {
+				AllocationTrace::OnFreeRaw(Ptr, ExtraLargeBlock::TierIndex, Size);
+				ExtraLargeBlock::DeallocateRaw(Ptr);
+			}
+			else {
+				AllocationTrace::OnFreeRaw(Ptr, FragmentationStats::CustomTier, Size);
+				LargeObjectCache::Free(Ptr, Size);
+
+#ifdef MEMEX_STATISTICS
+				CustomSizeDeallocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+			}
 		}
 #pragma endregion
 	};
 
-	template<typename TUpper>
+	//Intrusive API for types allocated by the MemoryManager
+	//	bIntrusive: [false] NewShared returns MSharedPtr (reference count in the block header)
+	//	            [true]  the reference count and the deleter index are stored inside the object,
+	//	                    NewShared returns MIntrusivePtr and SharedFromThis() is available
+	template<typename TUpper, bool bIntrusive = false>
 	struct IResource {
 		template<typename ...Types>
 		FORCEINLINE static MPtr<TUpper> New(Types... Args) noexcept {
-			return MemoryManager::Alloc<TUpper>(std::forward<Types...>(Args)...);
+			return MemoryManager::Alloc<TUpper>(std::forward<Types>(Args)...);
 		}
 
 		template<typename ...Types>
 		FORCEINLINE static MSharedPtr<TUpper> NewShared(Types... Args) noexcept {
-			return MemoryManager::AllocShared<TUpper>(std::forward<Types...>(Args)...);
+			return MemoryManager::AllocShared<TUpper>(std::forward<Types>(Args)...);
 		}
 
 		FORCEINLINE static MPtr<TUpper> NewArray(size_t Count) noexcept {
@@ -493,4 +815,56 @@ namespace MemEx {
 			return MemoryManager::AllocSharedBuffer<TUpper>(Count);
 		}
 	};
-}
\ No newline at end of file
+
+	template<typename TUpper>
+	struct IResource<TUpper, true> : IResource<TUpper, false> {
+		IResource() noexcept {}
+
+		//The reference count is not copied, the copy is a new object
+		IResource(const IResource&) noexcept {}
+		IResource& operator=(const IResource&) noexcept {
+			return *this;
+		}
+
+		template<typename ...Types>
+		FORCEINLINE static MIntrusivePtr<TUpper> NewShared(Types... Args) noexcept {
+			MPtr<TUpper> Unique = MemoryManager::Alloc<TUpper>(std::forward<Types>(Args)...);
+
+			//The object starts with one reference, adopted by the MIntrusivePtr
+			return MIntrusivePtr<TUpper>(Unique.Release());
+		}
+
+		//Get a new shared pointer to this object, the object must be owned by a MIntrusivePtr
+		FORCEINLINE MIntrusivePtr<TUpper> SharedFromThis() noexcept {
+			AddReference();
+			return MIntrusivePtr<TUpper>(static_cast<TUpper*>(this));
+		}
+
+		FORCEINLINE void AddReference() const noexcept {
+			RefCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		//Returns true if this was the last reference
+		FORCEINLINE bool ReleaseReference() const noexcept {
+			return RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+		}
+
+		FORCEINLINE uint32_t GetReferenceCount() const noexcept {
+			return RefCount.load(std::memory_order_relaxed);
+		}
+
+		FORCEINLINE uint32_t GetDeleterIndex() const noexcept {
+			return DeleterIndex;
+		}
+
+		//Select the deleter (see IntrusiveDeleters) used when the last reference is released
+		//[Index] must be an index returned by IntrusiveDeleters::Register (check it against IntrusiveDeleters::InvalidIndex)
+		FORCEINLINE void SetDeleterIndex(uint32_t Index) noexcept {
+			DeleterIndex = Index;
+		}
+
+	private:
+		mutable std::atomic<uint32_t>	RefCount{ 1 };
+		uint32_t						DeleterIndex{ 0 };
+	};
+}
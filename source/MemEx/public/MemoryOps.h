@@ -0,0 +1,51 @@
+#pragma once
+/**
+ * @file MemoryOps.h
+ *
+ * @brief MemEx vectorized bulk memory operations (zero, fill)
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//Fill [Size] bytes at [Dst] with the repeating 16 bytes [Pattern] (SSE2)
+	//	[Dst] must be aligned to the period of the pattern (eg. 4 for a pattern of uint32_t)
+	//	Fills larger than NonTemporalStoreThreshold use non-temporal stores (bypass the cache)
+	extern void MemFillPattern(ptr_t Dst, size_t Size, __m128i Pattern) noexcept;
+
+	//Zero [Size] bytes at [Dst]
+	FORCEINLINE void MemZero(ptr_t Dst, size_t Size) noexcept {
+		MemFillPattern(Dst, Size, _mm_setzero_si128());
+	}
+
+	//Run [Work](ThreadIndex) for each ThreadIndex in [0, ThreadsCount) on its own thread and wait for all of them
+	//The calling thread runs ThreadIndex 0, if a thread cant be started its work is run on the calling thread
+	extern void RunParallel(size_t ThreadsCount, const Delegate<void, size_t>& Work) noexcept;
+
+	//Can T be filled with MemFillPattern
+	template<typename T>
+	constexpr bool CanVectorFill = std::is_trivially_copyable_v<T> && IsPowerOf2(sizeof(T)) && sizeof(T) <= 16;
+
+	//Construct [Count] copies of [Value] at [Dst]
+	template<typename T>
+	FORCEINLINE void MemFill(T* Dst, size_t Count, const T& Value) noexcept {
+		if constexpr (CanVectorFill<T>) {
+			if ((reinterpret_cast<size_t>(Dst) & (sizeof(T) - 1)) == 0) {
+				//Broadcast Value into the 16 bytes pattern
+				__m128i Pattern;
+				for (size_t i = 0; i < sizeof(__m128i) / sizeof(T); i++) {
+					memcpy(reinterpret_cast<uint8_t*>(&Pattern) + (i * sizeof(T)), &Value, sizeof(T));
+				}
+
+				MemFillPattern(Dst, sizeof(T) * Count, Pattern);
+				return;
+			}
+		}
+
+		for (size_t i = 0; i < Count; i++) {
+			new (Dst + i) T(Value);
+		}
+	}
+}
@@ -0,0 +1,201 @@
+#pragma once
+/**
+ * @file MemoryTags.h
+ *
+ * @brief MemoryTags: Per subsystem accounting of the MemoryManager blocks
+			Each block records the tag of the thread that allocated it (see MemoryTagScope) in its flags.
+			Bytes and blocks are accounted per tag in per thread counters (see TThreadCounters), no locked instructions on the hot path.
+			A tag can have a soft budget (callback when crossed) and a hard budget (callback, the allocation fails).
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	using MemoryTag = uint8_t;
+
+	//Tag of untagged allocations
+	constexpr MemoryTag DefaultMemoryTag = 0;
+
+	//Budget callback (Tag, TagBytes)
+	using MemoryBudgetCallback = Delegate<void, MemoryTag, size_t>;
+
+	class MemoryTags {
+	public:
+		static_assert(MemoryTagsCount > 0 && MemoryTagsCount <= 256, "MemoryTagsCount must be in [1, 256]");
+
+		struct TagStatistics {
+			const char*	Name{ nullptr };
+			size_t		Bytes{ 0 };				//Bytes currently held (block headers included)
+			size_t		BlocksCount{ 0 };		//Blocks currently held
+			size_t		TotalAllocations{ 0 };
+			size_t		TotalRejected{ 0 };		//Allocations failed by the hard budget
+			size_t		SoftBudget{ 0 };
+			size_t		HardBudget{ 0 };
+		};
+
+		FORCEINLINE static MemoryTag GetThreadTag() noexcept {
+			return ThreadTag;
+		}
+
+		FORCEINLINE static void SetThreadTag(MemoryTag Tag) noexcept {
+			ThreadTag = Tag;
+		}
+
+		static void SetName(MemoryTag Tag, const char* Name) noexcept {
+			if (Tag < MemoryTagsCount) {
+				Tags[Tag].Name = Name;
+			}
+		}
+
+		//Set the budgets of [Tag] in bytes (0 - no budget)
+		//	[OnSoftBudget] is called by the allocation that crosses [SoftBudget]
+		//	[OnHardBudget] is called by each allocation rejected because it would cross [HardBudget]
+		static void SetBudget(MemoryTag Tag, size_t SoftBudget, size_t HardBudget, const MemoryBudgetCallback& OnSoftBudget = { }, const MemoryBudgetCallback& OnHardBudget = { }) noexcept {
+			if (Tag >= MemoryTagsCount) {
+				return;
+			}
+
+			TagState& State = Tags[Tag];
+
+			State.OnSoftBudget = OnSoftBudget;
+			State.OnHardBudget = OnHardBudget;
+			State.SoftBudget.store(SoftBudget, std::memory_order_relaxed);
+			State.HardBudget.store(HardBudget, std::memory_order_release);
+		}
+
+		//Account [Bytes] allocated under [Tag], returns false if the hard budget rejects the allocation
+		FORCEINLINE static bool OnAllocate(MemoryTag Tag, size_t Bytes) noexcept {
+			TagState& State = Tags[Tag < MemoryTagsCount ? Tag : DefaultMemoryTag];
+
+			if (State.SoftBudget.load(std::memory_order_relaxed) | State.HardBudget.load(std::memory_order_relaxed)) {
+				return OnAllocateBudgeted(State, Tag, Bytes);
+			}
+
+			AddAllocation(Tag, Bytes);
+
+			return true;
+		}
+
+		FORCEINLINE static void OnFree(MemoryTag Tag, size_t Bytes) noexcept {
+			//Blocks may be freed by another thread, the counters of all the threads are summed so the per thread values can wrap
+			TagCounters& Counters = ThreadCounters::Local().Tags[Tag < MemoryTagsCount ? Tag : DefaultMemoryTag];
+
+			AddLocalCounter(Counters.Bytes, size_t(0) - Bytes);
+			AddLocalCounter(Counters.BlocksCount, size_t(0) - 1);
+		}
+
+		static TagStatistics GetStatistics(MemoryTag Tag) noexcept {
+			TagStatistics Result;
+			if (Tag >= MemoryTagsCount) {
+				return Result;
+			}
+
+			const TagState& State = Tags[Tag];
+
+			Result.Name = State.Name;
+			Result.SoftBudget = State.SoftBudget.load(std::memory_order_relaxed);
+			Result.HardBudget = State.HardBudget.load(std::memory_order_relaxed);
+			Result.TotalRejected = State.TotalRejected.load(std::memory_order_relaxed);
+
+			ThreadCounters::ForEach([&Result, Tag](const ThreadTagCounters& Counters) {
+				Result.Bytes += Counters.Tags[Tag].Bytes.load(std::memory_order_relaxed);
+				Result.BlocksCount += Counters.Tags[Tag].BlocksCount.load(std::memory_order_relaxed);
+				Result.TotalAllocations += Counters.Tags[Tag].TotalAllocations.load(std::memory_order_relaxed);
+			});
+
+			return Result;
+		}
+
+	private:
+		struct TagCounters {
+			std::atomic<size_t>	Bytes{ 0 };
+			std::atomic<size_t>	BlocksCount{ 0 };
+			std::atomic<size_t>	TotalAllocations{ 0 };
+		};
+
+		struct ThreadTagCounters {
+			TagCounters	Tags[MemoryTagsCount];
+		};
+
+		using ThreadCounters = TThreadCounters<ThreadTagCounters>;
+
+		struct TagState {
+			std::atomic<size_t>					SoftBudget{ 0 };
+			std::atomic<size_t>					HardBudget{ 0 };
+			std::atomic<size_t>					TotalRejected{ 0 };
+			MemoryBudgetCallback				OnSoftBudget{ };
+			MemoryBudgetCallback				OnHardBudget{ };
+			const char*							Name{ nullptr };
+		};
+
+		FORCEINLINE static void AddAllocation(MemoryTag Tag, size_t Bytes) noexcept {
+			TagCounters& Counters = ThreadCounters::Local().Tags[Tag < MemoryTagsCount ? Tag : DefaultMemoryTag];
+
+			AddLocalCounter(Counters.Bytes, Bytes);
+			AddLocalCounter(Counters.BlocksCount, 1);
+			AddLocalCounter(Counters.TotalAllocations, 1);
+		}
+
+		static size_t SumBytes(MemoryTag Tag) noexcept {
+			size_t Total = 0;
+
+			ThreadCounters::ForEach([&Total, Tag](const ThreadTagCounters& Counters) {
+				Total += Counters.Tags[Tag].Bytes.load(std::memory_order_relaxed);
+			});
+
+			return Total;
+		}
+
+		//Budgeted tags sum the counters of all the threads on each allocation, the budget is checked against a racy total
+		static bool OnAllocateBudgeted(TagState& State, MemoryTag Tag, size_t Bytes) noexcept {
+			const size_t SoftBudget = State.SoftBudget.load(std::memory_order_relaxed);
+			const size_t HardBudget = State.HardBudget.load(std::memory_order_acquire);
+			const size_t Before = SumBytes(Tag < MemoryTagsCount ? Tag : DefaultMemoryTag);
+
+			if (HardBudget && Before + Bytes > HardBudget) {
+				State.TotalRejected.fetch_add(1, std::memory_order_relaxed);
+
+				if (!State.OnHardBudget.isNull()) {
+					State.OnHardBudget(Tag, Before);
+				}
+
+				return false;
+			}
+
+			AddAllocation(Tag, Bytes);
+
+			if (SoftBudget && Before <= SoftBudget && Before + Bytes > SoftBudget && !State.OnSoftBudget.isNull()) {
+				State.OnSoftBudget(Tag, Before + Bytes);
+			}
+
+			return true;
+		}
+
+		static TagState							Tags[MemoryTagsCount];
+		static inline thread_local MemoryTag	ThreadTag{ DefaultMemoryTag };
+	};
+
+	inline MemoryTags::TagState MemoryTags::Tags[MemoryTagsCount]{ };
+
+	//RAII memory tag of the calling thread, the previous tag is restored on exit
+	class MemoryTagScope {
+	public:
+		explicit MemoryTagScope(MemoryTag Tag) noexcept
+			: PreviousTag(MemoryTags::GetThreadTag())
+		{
+			MemoryTags::SetThreadTag(Tag);
+		}
+
+		~MemoryTagScope() noexcept {
+			MemoryTags::SetThreadTag(PreviousTag);
+		}
+
+		MemoryTagScope(const MemoryTagScope&) = delete;
+		MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+	private:
+		MemoryTag PreviousTag;
+	};
+}
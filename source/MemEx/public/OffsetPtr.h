@@ -0,0 +1,70 @@
+#pragma once
+/**
+ * @file OffsetPtr.h
+ *
+ * @brief MemEx self relative pointer
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//Pointer that stores the distance from its own address to the target
+	//It stays valid when the region containing both the pointer and the target is mapped at another address
+	//(eg. a file backed PersistentHeap reattached at a different base)
+	template<typename T>
+	class TOffsetPtr {
+	public:
+		TOffsetPtr() noexcept = default;
+		TOffsetPtr(std::nullptr_t) noexcept {}
+		TOffsetPtr(T* Ptr) noexcept {
+			Set(Ptr);
+		}
+
+		TOffsetPtr(const TOffsetPtr& Other) noexcept {
+			Set(Other.Get());
+		}
+		TOffsetPtr& operator=(const TOffsetPtr& Other) noexcept {
+			Set(Other.Get());
+			return *this;
+		}
+		TOffsetPtr& operator=(T* Ptr) noexcept {
+			Set(Ptr);
+			return *this;
+		}
+
+		FORCEINLINE T* Get() const noexcept {
+			if (Offset == 0) {
+				return nullptr;
+			}
+
+			return reinterpret_cast<T*>(reinterpret_cast<intptr_t>(this) + Offset);
+		}
+
+		FORCEINLINE T& operator*() const noexcept {
+			return *Get();
+		}
+		FORCEINLINE T* operator->() const noexcept {
+			return Get();
+		}
+		FORCEINLINE T& operator[](size_t Index) const noexcept {
+			return Get()[Index];
+		}
+
+		explicit operator bool() const noexcept {
+			return Offset != 0;
+		}
+		FORCEINLINE bool IsNull() const noexcept {
+			return Offset == 0;
+		}
+
+	private:
+		FORCEINLINE void Set(T* Ptr) noexcept {
+			//A pointer to itself is stored as null, it is never a meaningful target
+			Offset = Ptr ? reinterpret_cast<intptr_t>(Ptr) - reinterpret_cast<intptr_t>(this) : 0;
+		}
+
+		intptr_t Offset{ 0 };
+	};
+}
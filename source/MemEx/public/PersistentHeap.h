@@ -0,0 +1,192 @@
+#pragma once
+/**
+ * @file PersistentHeap.h
+ *
+ * @brief MemEx file backed persistent heap
+ *			The heap lives in a memory mapped file: fixed size tiers of blocks (same block sizes as the MemoryManager tiers)
+ *			with lock-free free lists and a table of roots, all stored in the file. Reopening the file reattaches the heap
+ *			and all the live blocks as they were, no object is reconstructed.
+ *			The file header records the tier layout, a file created by an incompatible build is refused.
+ *			Pointers stored inside the heap must be TOffsetPtr (or offsets, see ToOffset), the heap may be reattached
+ *			at another base address if [PreferredBase] is not available.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	constexpr size_t PersistentTiersCount = 4;
+
+	enum class EPersistentHeapStatus {
+		None,
+		Created,			//New heap file created
+		Attached,			//Existing heap file reattached
+		ErrorMap,			//Failed to create/open/map the file
+		ErrorIncompatible	//The file was not created by a compatible build (or is not a heap file)
+	};
+
+	class PersistentHeap {
+	public:
+		static constexpr uint64_t	HeapMagic = 0x3150414548584D4DULL; //"MMXHEAP1"
+		static constexpr uint32_t	HeapVersion = 2;
+
+		static constexpr uint32_t TierBlockSizes[PersistentTiersCount] = {
+			SmallMemBlockSize,
+			MediumMemBlockSize,
+			LargeMemBlockSize,
+			ExtraLargeMemBlockSize
+		};
+
+		//Placed before each block in the file
+		struct alignas(MEMEX_CACHE_LINE_SIZE) BlockHeader {
+			std::atomic<uint32_t>	NextFree{ 0 };		//Index + 1 of the next free block in the tier free list
+			uint32_t				TierIndex{ 0 };
+			uint32_t				BlockIndex{ 0 };
+			uint32_t				Size{ 0 };			//Requested size, 0 if the block is free
+			std::atomic<uint32_t>	RefCount{ 0 };		//References held by MSharedHeapPtr (see SharedHeap), 1 after allocation
+		};
+
+		struct alignas(MEMEX_CACHE_LINE_SIZE) TierState {
+			std::atomic<uint64_t>	FreeHead{ 0 };		//[Tag:32][Index + 1:32] of the first free block
+			std::atomic<uint32_t>	LiveBlocksCount{ 0 };
+		};
+
+		//Placed at the begining of the file
+		struct HeapHeader {
+			uint64_t				Magic;
+			uint32_t				Version;
+			uint32_t				HeapHeaderSize;
+			uint32_t				BlockHeaderSize;
+			uint32_t				PointerSize;
+			uint32_t				TiersCount;
+			uint32_t				TierBlockSize[PersistentTiersCount];
+			uint32_t				TierBlocksCount[PersistentTiersCount];
+			uint64_t				TierOffset[PersistentTiersCount];
+			uint64_t				TotalSize;
+			uint64_t				CreationBase;
+
+			TierState				Tiers[PersistentTiersCount];
+			std::atomic<uint64_t>	Roots[PersistentHeapRootsCount];
+		};
+
+		static_assert(std::atomic<uint64_t>::is_always_lock_free, "PersistentHeap requires lock-free 64bit atomics");
+
+		PersistentHeap() noexcept = default;
+		~PersistentHeap() noexcept {
+			Close();
+		}
+
+		//Cant copy
+		PersistentHeap(const PersistentHeap&) = delete;
+		PersistentHeap& operator=(const PersistentHeap&) = delete;
+
+		//Open (reattach) the heap file at [Path] or create it with [TierBlocksCount] blocks per tier
+		//[PreferredBase] - stable address to map the heap at, nullptr for any
+		//A new heap is formatted under a temporary name and renamed to [Path] when complete, a half formatted heap is never
+		//visible at [Path]. An existing file that is not a compatible heap is left untouched (ErrorIncompatible).
+		EPersistentHeapStatus Open(const char* Path, const uint32_t(&TierBlocksCount)[PersistentTiersCount], ptr_t PreferredBase = nullptr) noexcept;
+
+		//Flush and unmap the heap, all pointers into the heap become invalid
+		void Close() noexcept;
+
+		//Write all the changes back to the file and wait for completion
+		bool Checkpoint() noexcept;
+
+		//Allocate a block of at least [Size] bytes from the smallest tier with free blocks, nullptr if the heap is full
+		ptr_t AllocateRaw(size_t Size) noexcept;
+
+		//Free a block allocated with AllocateRaw
+		void FreeRaw(ptr_t Ptr) noexcept;
+
+		template<typename T, typename ...Types>
+		T* New(Types&&... Args) noexcept {
+			static_assert(!std::is_polymorphic_v<T>, "PersistentHeap cant store polymorphic types (vtable pointers dont survive a restart)!");
+			static_assert(alignof(T) <= MEMEX_CACHE_LINE_SIZE, "PersistentHeap blocks are aligned to MEMEX_CACHE_LINE_SIZE!");
+
+			ptr_t Ptr = AllocateRaw(sizeof(T));
+			if (!Ptr) {
+				return nullptr;
+			}
+
+			return new (Ptr) T(std::forward<Types>(Args)...);
+		}
+
+		template<typename T>
+		void Delete(T* Obj) noexcept {
+			if (!Obj) {
+				return;
+			}
+
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				Obj->~T();
+			}
+
+			FreeRaw(Obj);
+		}
+
+		//Store [Ptr] as root [Index], roots survive restarts and are the entry points into the heap
+		FORCEINLINE void SetRoot(size_t Index, const void* Ptr) noexcept {
+			Header->Roots[Index].store(Ptr ? ToOffset(Ptr) : 0, std::memory_order_release);
+		}
+
+		template<typename T>
+		FORCEINLINE T* GetRoot(size_t Index) const noexcept {
+			const uint64_t Offset = Header->Roots[Index].load(std::memory_order_acquire);
+			return Offset ? reinterpret_cast<T*>(FromOffset(Offset)) : nullptr;
+		}
+
+		//Offset of [Ptr] from the heap base, stable across restarts
+		FORCEINLINE uint64_t ToOffset(const void* Ptr) const noexcept {
+			return static_cast<uint64_t>(reinterpret_cast<const uint8_t*>(Ptr) - Region.GetBase());
+		}
+
+		FORCEINLINE ptr_t FromOffset(uint64_t Offset) const noexcept {
+			return Region.GetBase() + Offset;
+		}
+
+		FORCEINLINE bool Contains(const void* Ptr) const noexcept {
+			return Header && Ptr >= Region.GetBase() && Ptr < Region.GetBase() + Region.GetSize();
+		}
+
+		FORCEINLINE bool IsOpen() const noexcept {
+			return Header != nullptr;
+		}
+
+		FORCEINLINE uint8_t* GetBase() const noexcept {
+			return Region.GetBase();
+		}
+
+		FORCEINLINE size_t GetLiveBlocksCount(size_t TierIndex) const noexcept {
+			return Header->Tiers[TierIndex].LiveBlocksCount.load(std::memory_order_relaxed);
+		}
+
+		//Size of the heap file for [TierBlocksCount] blocks per tier
+		static size_t ComputeHeapSize(const uint32_t(&TierBlocksCount)[PersistentTiersCount], uint64_t(&OutTierOffset)[PersistentTiersCount]) noexcept;
+
+	protected:
+		FORCEINLINE static size_t GetBlockStride(size_t TierIndex) noexcept {
+			return sizeof(BlockHeader) + TierBlockSizes[TierIndex];
+		}
+
+		FORCEINLINE BlockHeader* GetBlock(size_t TierIndex, uint32_t BlockIndex) const noexcept {
+			return reinterpret_cast<BlockHeader*>(Region.GetBase() + Header->TierOffset[TierIndex] + (GetBlockStride(TierIndex) * BlockIndex));
+		}
+
+		//Lock-free free list (tagged head against ABA, safe across threads and processes)
+		BlockHeader* PopFree(size_t TierIndex) noexcept;
+		void PushFree(BlockHeader* Block) noexcept;
+
+		//Format the new (zero filled) heap, the magic is written last
+		//[bDurable] - the heap is flushed before the magic is written and the header page after
+		bool Format(const uint32_t(&TierBlocksCount)[PersistentTiersCount], bool bDurable) noexcept;
+		bool Validate() const noexcept;
+
+		//Format a new heap file next to [Path] and publish it at [Path], on success [Path] is mapped
+		//Returns Created, or Attached if another process published its heap at [Path] first
+		EPersistentHeapStatus Create(const char* Path, const uint32_t(&TierBlocksCount)[PersistentTiersCount], ptr_t PreferredBase) noexcept;
+
+		MappedRegion		Region;
+		HeapHeader* PTR		Header{ nullptr };
+	};
+}
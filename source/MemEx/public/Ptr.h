@@ -65,221 +65,242 @@ namespace MemEx {
 		mutable T* PTR	Ptr{ nullptr };
 	};
 
-	template<typename T, typename Base>
-	class _TPtr : public Base {
-		_TPtr() :Base() {}
-		_TPtr(T* Ptr) :Base(Ptr) {}
+#pragma endregion
 
-		//Move
-		_TPtr(_TPtr&& Other) noexcept : Base() {
-			Reset(Other.Release());
-		};
-		_TPtr& operator=(_TPtr&& Other) noexcept {
-			if (this == &Other) {
-				return *this;
-			}
+#pragma region _MPtr [Base of all MPtr]
 
-			Reset(Other.Release());
+	//Memory Block pointer abstraction
+	//It consists of a single pointer to T, the MemoryBlock that owns T is found at a fixed offset before it (see GetBlockFromPayload)
+	//	bShared: [false] unique owner, move only
+	//	         [true]  shared owner, copies share the block's RefCount
+	template<typename T, bool bShared>
+	class _MPtr : public _TPtrBase<T> {
+	public:
+		using MyType = _MPtr<T, bShared>;
 
-			return *this;
-		};
+		_MPtr() noexcept {}
+		_MPtr(std::nullptr_t) noexcept {}
 
-		//Cant copy
-		_TPtr(_TPtr&) = delete;
-		_TPtr& operator=(_TPtr&) = delete;
+		//Take ownership of [Ptr], it must be the payload of a MemoryManager block
+		explicit _MPtr(T* Ptr) noexcept :_TPtrBase<T>(Ptr) {}
 
-		//Cast
-		template<typename TargetType>
-		FORCEINLINE _TPtr<TargetType, Base> Cast() {
-			return _TPtr<TargetType, Base>((TargetType*)Release());
-		}
+		//Unique to shared
+		_MPtr(_MPtr<T, false>&& Other) noexcept requires(bShared) : _TPtrBase<T>(Other.Release()) {}
 
-		~_TPtr() {
-			this->DestroyResource();
+		~_MPtr() noexcept {
+			DestroyResource();
 		}
 
-		FORCEINLINE void Reset(T* Resource = nullptr) {
-			this->DestroyResource();
-			this->Ptr = Resource;
-		}
-		FORCEINLINE T* Release() {
-			T* Temp = this->Ptr;
-			this->Ptr = nullptr;
-			return Temp;
+		//Copy (shared only)
+		_MPtr(const _MPtr& Other) noexcept requires(bShared) : _TPtrBase<T>(Other.Ptr) {
+			AddReference();
 		}
+		_MPtr& operator=(const _MPtr& Other) noexcept requires(bShared) {
+			if (this == &Other) {
+				return *this;
+			}
 
-		friend struct MemoryManager;
-		template<typename T, typename BasePtr>
-		friend struct _MPtr;
-	};
+			Other.AddReference();
+			DestroyResource();
+			this->Ptr = Other.Ptr;
 
-	template<typename T, typename Base>
-	class _TSharedPtr : public Base {
-	public:
-		_TSharedPtr() :Base() {}
-		_TSharedPtr(T* Ptr) : Base(Ptr) {}
+			return *this;
+		}
 
 		//Move
-		_TSharedPtr(_TSharedPtr&& Other) noexcept {
-			this->Ptr = Other.Ptr;
+		FORCEINLINE _MPtr(_MPtr&& Other) noexcept : _TPtrBase<T>(Other.Ptr) {
 			Other.Ptr = nullptr;
-		};
-		_TSharedPtr& operator=(_TSharedPtr&& Other)noexcept {
+		}
+		FORCEINLINE _MPtr& operator=(_MPtr&& Other) noexcept {
 			if (this == &Other) {
 				return *this;
 			}
 
+			DestroyResource();
+
 			this->Ptr = Other.Ptr;
 			Other.Ptr = nullptr;
 
 			return *this;
-		};
+		}
 
-		//Copy
-		_TSharedPtr(const _TSharedPtr& Other) {
-			Other.IncRef();
-			this->Ptr = Other.Ptr;
-		};
-		_TSharedPtr& operator=(const _TSharedPtr& Other) {
-			if (this == &Other) {
-				return *this;
-			}
+		FORCEINLINE size_t GetCapacity() const noexcept {
+			if (this->IsNull()) { return 0; }
 
-			Other.AddReference();
-			this->Ptr = Other.Ptr;
+			return static_cast<size_t>(GetMemoryBlock()->GetEnd() - reinterpret_cast<const uint8_t*>(this->Ptr));
+		}
 
-			return *this;
-		};
+		FORCEINLINE void Reset() noexcept {
+			DestroyResource();
+		}
 
-		~_TSharedPtr() {
-			ReleaseReference();
+		//Give up the ownership (the reference for shared) without destroying
+		FORCEINLINE T* Release() noexcept {
+			T* Temp = this->Ptr;
+			this->Ptr = nullptr;
+			return Temp;
 		}
 
-		void Release() noexcept {
-			ReleaseReference();
+		FORCEINLINE IMemoryBlock* GetMemoryBlock() noexcept {
+			return this->Ptr ? GetBlockFromPayload(this->Ptr) : nullptr;
 		}
 
-	private:
-		FORCEINLINE bool AddReference() const noexcept { // increment ref count if not zero, return true if successful
-			if (this->IsNull()) { return false; }
+		FORCEINLINE const IMemoryBlock* GetMemoryBlock() const noexcept {
+			return this->Ptr ? GetBlockFromPayload(this->Ptr) : nullptr;
+		}
 
-			return this->Ptr->AddReference();
+	protected:
+		FORCEINLINE void AddReference() const noexcept {
+			if (this->Ptr) {
+				GetBlockFromPayload(this->Ptr)->AddReference();
+			}
 		}
-		FORCEINLINE void ReleaseReference() const noexcept {
-			if (this->IsNull()) { return; }
 
-			if (this->Ptr->ReleaseReference()) {
-				this->DestroyResource();
+		FORCEINLINE void DestroyResource() noexcept {
+			if (!this->Ptr) {
+				return;
 			}
+
+			IMemoryBlock* BlockObject = GetBlockFromPayload(this->Ptr);
+			this->Ptr = nullptr;
+
+			if constexpr (bShared) {
+				if (!BlockObject->ReleaseReference()) {
+					return;
+				}
+			}
+
+			DeferredDestruction::DestroyBlock(BlockObject);
 		}
 
-		template<typename K, size_t PoolSize>
-		friend struct TGlobalMemoryStore;
-		template<typename T, typename BasePtr>
-		friend struct _MPtr;
 		friend struct MemoryManager;
+		template<typename, bool>
+		friend class _MPtr;
 	};
 
+	//MemoryBlock unique pointer
+	template<typename T>
+	using MPtr = _MPtr<T, false>;
+
+	//MemoryBlock shared pointer
+	template<typename T>
+	using MSharedPtr = _MPtr<T, true>;
+
+	static_assert(sizeof(MPtr<int>) == sizeof(int*), "MPtr<T> must be a single pointer");
+	static_assert(sizeof(MSharedPtr<int>) == sizeof(int*), "MSharedPtr<T> must be a single pointer");
+
 #pragma endregion
 
-#pragma region _MPtr [Base of all MPtr]
+#pragma region MIntrusivePtr
 
-	template<typename T>
-	class MemoryResourcePtrBase : public _TPtrBase<T> {
+	//Deleters of intrusive resources (see IResource<TUpper, true>), selected by the deleter index stored in the object
+	//Index 0 is reserved for objects allocated by the MemoryManager (the owning block is destroyed)
+	class IntrusiveDeleters {
 	public:
-		MemoryResourcePtrBase() noexcept : _TPtrBase<T>(nullptr) {}
-		MemoryResourcePtrBase(T* Ptr) noexcept : _TPtrBase<T>(Ptr) {}
+		static constexpr uint32_t MaxDeleters = 256;
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
 
-		FORCEINLINE void DestroyResource() const noexcept
-		{
-			if (this->Ptr)
-			{
-				this->Ptr->Destroy(this->Ptr, true);
-				this->Ptr = nullptr;
+		//Register a deleter, returns its index or InvalidIndex if the table is full (never 0, the reserved deleter)
+		static uint32_t Register(const Delegate<void, ptr_t>& Deleter) noexcept {
+			uint32_t Index = DeletersCount.load(std::memory_order_relaxed);
+			do {
+				if (Index >= MaxDeleters) {
+					return InvalidIndex;
+				}
+			} while (!DeletersCount.compare_exchange_weak(Index, Index + 1, std::memory_order_relaxed));
+
+			Deleters[Index] = Deleter;
+
+			return Index;
+		}
+
+		FORCEINLINE static void Invoke(uint32_t Index, ptr_t Object) noexcept {
+			if (Index == 0) {
+				IMemoryBlock::DestroyPayload(Object);
+				return;
 			}
+
+			Deleters[Index](Object);
 		}
-	};
 
-	using TIMemoryBlockPtrBase = MemoryResourcePtrBase<IMemoryBlock>;
+	private:
+		static inline Delegate<void, ptr_t>		Deleters[MaxDeleters]{ };
+		static inline std::atomic<uint32_t>		DeletersCount{ 1 };
+	};
 
-	//Memory Block pointer abstraction
-	//It consits of 2 pointers, one to the MemoryBlock, and the other is an aligned pointer into the MemoryBlock, of type T
-	template<typename T, typename MyBlockPtr>
-	class _MPtr : public _TPtrBase<T> {
-		static_assert(
-			std::is_same_v<_TPtr<IMemoryBlock, TIMemoryBlockPtrBase>, MyBlockPtr> ||
-			std::is_same_v<_TSharedPtr<IMemoryBlock, TIMemoryBlockPtrBase>, MyBlockPtr>,
-			"See _MPtr<T, MyBlockPtr>");
+	//Shared pointer to an intrusive resource (T derives IResource<T, true>)
+	//The reference count lives inside the object, copies touch only the object
+	template<typename T>
+	class MIntrusivePtr : public _TPtrBase<T> {
 	public:
-		using MyType = _MPtr<T, MyBlockPtr>;
+		MIntrusivePtr() noexcept {}
+		MIntrusivePtr(std::nullptr_t) noexcept {}
 
-		_MPtr() {}
-		_MPtr(IMemoryBlock* BlockObject, T* Ptr) :_TPtrBase<T>(Ptr), BlockObject(BlockObject) {}
-		_MPtr(MyBlockPtr&& BlockObject, T* Ptr) :_TPtrBase<T>(Ptr), BlockObject(std::move(BlockObject)) {}
+		//Adopt a reference already owned on [Ptr]
+		explicit MIntrusivePtr(T* Ptr) noexcept : _TPtrBase<T>(Ptr) {}
 
-		//Cant copy
-		_MPtr(const _MPtr&) = delete;
-		_MPtr& operator=(const _MPtr&) = delete;
+		~MIntrusivePtr() noexcept {
+			ReleaseReference();
+		}
 
-		//Move
-		FORCEINLINE _MPtr(_MPtr&& Other) noexcept : BlockObject(std::move(Other.BlockObject)) {
-			auto Temp = Other.Ptr;
-			Other.Ptr = nullptr;
-			this->Ptr = Temp;
+		//Copy
+		MIntrusivePtr(const MIntrusivePtr& Other) noexcept : _TPtrBase<T>(Other.Ptr) {
+			if (this->Ptr) {
+				this->Ptr->AddReference();
+			}
 		}
-		FORCEINLINE _MPtr& operator=(_MPtr&& Other) noexcept {
+		MIntrusivePtr& operator=(const MIntrusivePtr& Other) noexcept {
 			if (this == &Other) {
 				return *this;
 			}
 
-			BlockObject = std::move(Other.BlockObject);
+			if (Other.Ptr) {
+				Other.Ptr->AddReference();
+			}
 
-			auto Temp = Other.Ptr;
-			Other.Ptr = nullptr;
-			this->Ptr = Temp;
+			ReleaseReference();
+			this->Ptr = Other.Ptr;
 
 			return *this;
 		}
 
-		FORCEINLINE size_t GetCapacity() const noexcept {
-			if (this->IsNull() || BlockObject.IsNull()) { return 0; }
+		//Move
+		FORCEINLINE MIntrusivePtr(MIntrusivePtr&& Other) noexcept : _TPtrBase<T>(Other.Ptr) {
+			Other.Ptr = nullptr;
+		}
+		FORCEINLINE MIntrusivePtr& operator=(MIntrusivePtr&& Other) noexcept {
+			if (this == &Other) {
+				return *this;
+			}
 
-			const auto Ptr = reinterpret_cast<uint8_t*>(this->Ptr);
+			ReleaseReference();
 
-			return static_cast<size_t>(BlockObject->GetEnd() - BlockObject->GetBegin(static_cast<ulong_t>(Ptr - BlockObject->Block)));
-		}
+			this->Ptr = Other.Ptr;
+			Other.Ptr = nullptr;
 
-		FORCEINLINE void Reset() noexcept {
-			this->Ptr = nullptr;
-			BlockObject.Reset();
+			return *this;
 		}
 
-		FORCEINLINE IMemoryBlock* GetMemoryBlock() noexcept {
-			return this->BlockObject.Ptr;
+		FORCEINLINE void Reset() noexcept {
+			ReleaseReference();
 		}
 
-		FORCEINLINE const IMemoryBlock* GetMemoryBlock() const noexcept {
-			return this->BlockObject.Ptr;
-		}
+	private:
+		FORCEINLINE void ReleaseReference() noexcept {
+			if (!this->Ptr) {
+				return;
+			}
 
-	protected:
-		MyBlockPtr BlockObject{ nullptr };
+			T* Obj = this->Ptr;
+			this->Ptr = nullptr;
 
-		friend struct MemoryManager;
-		template <typename T>
-		friend struct TStructureBase;
+			if (Obj->ReleaseReference()) {
+				IntrusiveDeleters::Invoke(Obj->GetDeleterIndex(), Obj);
+			}
+		}
 	};
 
-	using IMemoryBlockPtr = _TPtr<IMemoryBlock, TIMemoryBlockPtrBase>;
-	using IMemoryBlockSharedPtr = _TSharedPtr<IMemoryBlock, TIMemoryBlockPtrBase>;
-
-	//MemoryBlock unique pointer
-	template<typename T>
-	using MPtr = _MPtr<T, IMemoryBlockPtr>;
-
-	//MemoryBlock shared pointer
-	template<typename T>
-	using MSharedPtr = _MPtr<T, IMemoryBlockSharedPtr>;
+	static_assert(sizeof(MIntrusivePtr<int>) == sizeof(int*), "MIntrusivePtr<T> must be a single pointer");
 
 #pragma endregion
 }
\ No newline at end of file
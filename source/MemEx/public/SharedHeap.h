@@ -0,0 +1,192 @@
+#pragma once
+/**
+ * @file SharedHeap.h
+ *
+ * @brief MemEx cross-process shared memory heap
+ *			A PersistentHeap laid out in a named shared memory segment (shm_open, named file mapping on Windows) that several
+ *			processes map at the same time, each at its own base address. The tier slabs, the lock-free free lists and the
+ *			block headers live in the segment, a block allocated by one process can be freed by any other.
+ *			Blocks are handed over between processes as offsets from the heap base (see MSharedHeapPtr::Detach and
+ *			SharedHeap::Adopt), the payload is never copied. Each block header holds a process shared reference count,
+ *			the process that releases the last reference destroys the object and frees the block.
+ *			Types stored in the heap must not hold pointers (use TOffsetPtr or offsets) and must be destructible by every
+ *			process that can release them.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	template<typename T>
+	class MSharedHeapPtr;
+
+	class SharedHeap : public PersistentHeap {
+	public:
+		//Open the shared heap [Name] (eg. "/MyApp_Heap") or create it with [TierBlocksCount] blocks per tier
+		//Processes attaching while the creator formats the heap wait up to [TimeoutMs] for it to be ready
+		//A segment whose creator died before formatting it is removed and created again (POSIX, on Windows the segment
+		//is removed when the last process unmaps it)
+		EPersistentHeapStatus Open(const char* Name, const uint32_t(&TierBlocksCount)[PersistentTiersCount], uint32_t TimeoutMs = 1000) noexcept;
+
+		//Remove the name of the shared heap [Name], processes that have it open keep using it
+		//After this call Open([Name]) creates a new heap
+		FORCEINLINE static bool Unlink(const char* Name) noexcept {
+			return MappedRegion::UnlinkShared(Name);
+		}
+
+		//Construct a new T in the heap, the returned pointer holds the only reference
+		template<typename T, typename ...Types>
+		MSharedHeapPtr<T> NewShared(Types&&... Args) noexcept {
+			return MSharedHeapPtr<T>(this, New<T>(std::forward<Types>(Args)...));
+		}
+
+		//Take over a reference handed over by another process as [Offset] (see MSharedHeapPtr::Detach)
+		//Returns null if [Offset] is not a live block of this heap
+		template<typename T>
+		MSharedHeapPtr<T> Adopt(uint64_t Offset) noexcept {
+			if (!IsLiveBlockOffset(Offset)) {
+				return MSharedHeapPtr<T>();
+			}
+
+			return MSharedHeapPtr<T>(this, reinterpret_cast<T*>(FromOffset(Offset)));
+		}
+
+		//Add a reference to the block at [Ptr]
+		FORCEINLINE void AddReference(const void* Ptr) noexcept {
+			GetBlockHeader(Ptr)->RefCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		//Remove a reference from the block at [Ptr], returns true if it was the last one (the caller destroys and frees the block)
+		FORCEINLINE bool ReleaseReference(const void* Ptr) noexcept {
+			return GetBlockHeader(Ptr)->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+		}
+
+		FORCEINLINE uint32_t GetReferenceCount(const void* Ptr) const noexcept {
+			return GetBlockHeader(Ptr)->RefCount.load(std::memory_order_relaxed);
+		}
+
+		//Is [Offset] the payload of an allocated block (offsets received from other processes are not trusted)
+		bool IsLiveBlockOffset(uint64_t Offset) const noexcept;
+
+	private:
+		FORCEINLINE static BlockHeader* GetBlockHeader(const void* Ptr) noexcept {
+			return reinterpret_cast<BlockHeader*>(const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(Ptr)) - sizeof(BlockHeader));
+		}
+	};
+
+	//Reference counted pointer to an object in a SharedHeap, the count is stored in the block header (shared by all the processes)
+	//The pointer itself is local to the process, Detach() turns one reference into an offset that can be sent to another process
+	template<typename T>
+	class MSharedHeapPtr {
+	public:
+		MSharedHeapPtr() noexcept = default;
+		MSharedHeapPtr(std::nullptr_t) noexcept {}
+		~MSharedHeapPtr() noexcept {
+			Reset();
+		}
+
+		MSharedHeapPtr(const MSharedHeapPtr& Other) noexcept : Heap{ Other.Heap }, Ptr{ Other.Ptr } {
+			if (Ptr) {
+				Heap->AddReference(Ptr);
+			}
+		}
+		MSharedHeapPtr& operator=(const MSharedHeapPtr& Other) noexcept {
+			if (this != &Other) {
+				Reset();
+
+				Heap = Other.Heap;
+				Ptr = Other.Ptr;
+
+				if (Ptr) {
+					Heap->AddReference(Ptr);
+				}
+			}
+
+			return *this;
+		}
+
+		MSharedHeapPtr(MSharedHeapPtr&& Other) noexcept : Heap{ Other.Heap }, Ptr{ Other.Ptr } {
+			Other.Heap = nullptr;
+			Other.Ptr = nullptr;
+		}
+		MSharedHeapPtr& operator=(MSharedHeapPtr&& Other) noexcept {
+			if (this != &Other) {
+				Reset();
+
+				Heap = Other.Heap;
+				Ptr = Other.Ptr;
+
+				Other.Heap = nullptr;
+				Other.Ptr = nullptr;
+			}
+
+			return *this;
+		}
+
+		//Release the reference, the last one destroys the object and frees the block (in whichever process releases it)
+		void Reset() noexcept {
+			if (Ptr && Heap->ReleaseReference(Ptr)) {
+				Heap->Delete(Ptr);
+			}
+
+			Heap = nullptr;
+			Ptr = nullptr;
+		}
+
+		//Give up the reference without releasing it, returns the offset of the object in the heap (0 if null)
+		//The receiver (possibly another process) takes the reference over with SharedHeap::Adopt
+		uint64_t Detach() noexcept {
+			const uint64_t Offset = GetOffset();
+
+			Heap = nullptr;
+			Ptr = nullptr;
+
+			return Offset;
+		}
+
+		//Add a reference for another process and return the offset to send it, this pointer keeps its own reference
+		uint64_t Share() const noexcept {
+			if (!Ptr) {
+				return 0;
+			}
+
+			Heap->AddReference(Ptr);
+
+			return GetOffset();
+		}
+
+		FORCEINLINE uint64_t GetOffset() const noexcept {
+			return Ptr ? Heap->ToOffset(Ptr) : 0;
+		}
+
+		FORCEINLINE uint32_t GetReferenceCount() const noexcept {
+			return Ptr ? Heap->GetReferenceCount(Ptr) : 0;
+		}
+
+		FORCEINLINE T* Get() const noexcept {
+			return Ptr;
+		}
+		FORCEINLINE T* operator->() const noexcept {
+			return Ptr;
+		}
+		FORCEINLINE T& operator*() const noexcept {
+			return *Ptr;
+		}
+		FORCEINLINE bool IsNull() const noexcept {
+			return Ptr == nullptr;
+		}
+		FORCEINLINE explicit operator bool() const noexcept {
+			return Ptr != nullptr;
+		}
+
+	private:
+		//Takes over the reference held on [Ptr]
+		MSharedHeapPtr(SharedHeap* Heap, T* Ptr) noexcept : Heap{ Ptr ? Heap : nullptr }, Ptr{ Ptr } {}
+
+		SharedHeap* Heap{ nullptr };
+		T* Ptr{ nullptr };
+
+		friend class SharedHeap;
+	};
+}
@@ -0,0 +1,246 @@
+#pragma once
+/**
+ * @file THandlePool.h
+ *
+ * @brief THandlePool: Densely packed object pool addressed by generational handles
+			A handle is [Generation][Index] packed in THandleType (32 or 64 bits), a fraction of the size of a MPtr.
+			Resolve is O(1) and detects stale handles (the object was destroyed, the slot may have been reused).
+			A slot is retired when its generation would wrap (a stale handle would resolve again), a new slot index is
+			used instead, Create fails once all the 2^IndexBits slot indices are retired.
+			Live objects are kept packed in memory order, iterating them is a linear pass over the storage.
+			Destroy moves the last object into the hole, raw pointers into the pool are invalidated by Create/Destroy.
+			Not thread safe.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+#include <cstring>
+
+namespace MemEx {
+	template<typename THandleType = uint32_t, size_t IndexBits = (sizeof(THandleType) * 8 * 3) / 4>
+	struct THandle {
+		static_assert(std::is_unsigned_v<THandleType>, "THandle storage must be an unsigned integer");
+		static_assert(IndexBits > 0 && IndexBits < sizeof(THandleType) * 8, "THandle must have index and generation bits");
+
+		static constexpr size_t			MyIndexBits = IndexBits;
+		static constexpr size_t			MyGenerationBits = (sizeof(THandleType) * 8) - IndexBits;
+		static constexpr THandleType	MyIndexMask = (THandleType(1) << IndexBits) - 1;
+		static constexpr THandleType	MyGenerationMask = THandleType(~THandleType(0)) >> IndexBits;
+
+		THandleType Value{ 0 };
+
+		THandle() noexcept = default;
+		THandle(THandleType Index, THandleType Generation) noexcept
+			: Value(static_cast<THandleType>((Generation << IndexBits) | (Index & MyIndexMask)))
+		{}
+
+		FORCEINLINE THandleType GetIndex() const noexcept {
+			return Value & MyIndexMask;
+		}
+
+		FORCEINLINE THandleType GetGeneration() const noexcept {
+			return Value >> IndexBits;
+		}
+
+		//Generations start at 1, the zero handle is never valid
+		FORCEINLINE bool IsNull() const noexcept {
+			return Value == 0;
+		}
+
+		FORCEINLINE bool operator==(const THandle& Other) const noexcept {
+			return Value == Other.Value;
+		}
+		FORCEINLINE bool operator!=(const THandle& Other) const noexcept {
+			return Value != Other.Value;
+		}
+	};
+
+	template<typename T, typename THandleType = uint32_t, size_t IndexBits = (sizeof(THandleType) * 8 * 3) / 4>
+	class THandlePool {
+	public:
+		using HandleType = THandle<THandleType, IndexBits>;
+
+		//[Capacity] - max number of live objects, at most 2^IndexBits
+		explicit THandlePool(size_t Capacity) noexcept
+			: Dense(MemoryManager::AllocBuffer<T, true>(Capacity))
+			, DenseToSlot(MemoryManager::AllocBuffer<THandleType, true>(Capacity))
+			, Slots(MemoryManager::AllocBuffer<Slot, true>(Capacity))
+			, Capacity(Dense.IsNull() || DenseToSlot.IsNull() || Slots.IsNull() ? 0 : Capacity)
+		{
+			if (this->Capacity > MaxSlotsCount) {
+				this->Capacity = MaxSlotsCount;
+			}
+
+			SlotsCapacity = this->Capacity;
+		}
+
+		~THandlePool() noexcept {
+			Clear();
+		}
+
+		//Cant copy
+		THandlePool(const THandlePool&) = delete;
+		THandlePool& operator=(const THandlePool&) = delete;
+
+		//Construct a new T, returns a null handle if the pool is full
+		template<typename ...Types>
+		HandleType Create(Types&&... Args) noexcept {
+			if (Size == Capacity) {
+				return { };
+			}
+
+			THandleType SlotIndex;
+			if (FreeSlotsHead != InvalidIndex) {
+				SlotIndex = FreeSlotsHead;
+				FreeSlotsHead = Slots[SlotIndex].DenseIndex;
+			}
+			else {
+				//All the slots are live or retired
+				if (SlotsCount == SlotsCapacity && !GrowSlots()) {
+					return { };
+				}
+
+				SlotIndex = static_cast<THandleType>(SlotsCount++);
+				Slots[SlotIndex].Generation = 1;
+			}
+
+			const THandleType DenseIndex = static_cast<THandleType>(Size++);
+
+			new (&Dense[DenseIndex]) T(std::forward<Types>(Args)...);
+			DenseToSlot[DenseIndex] = SlotIndex;
+			Slots[SlotIndex].DenseIndex = DenseIndex;
+
+			return HandleType(SlotIndex, Slots[SlotIndex].Generation);
+		}
+
+		//Get the object of [Handle], nullptr if the handle is stale
+		FORCEINLINE T* Resolve(HandleType Handle) noexcept {
+			const THandleType SlotIndex = Handle.GetIndex();
+			if (SlotIndex >= SlotsCount || Slots[SlotIndex].Generation != Handle.GetGeneration()) {
+				return nullptr;
+			}
+
+			return &Dense[Slots[SlotIndex].DenseIndex];
+		}
+
+		FORCEINLINE const T* Resolve(HandleType Handle) const noexcept {
+			return const_cast<THandlePool*>(this)->Resolve(Handle);
+		}
+
+		FORCEINLINE bool IsValid(HandleType Handle) const noexcept {
+			return Resolve(Handle) != nullptr;
+		}
+
+		//Destroy the object of [Handle], the last object is moved into its place, returns false if the handle is stale
+		bool Destroy(HandleType Handle) noexcept {
+			const THandleType SlotIndex = Handle.GetIndex();
+			if (SlotIndex >= SlotsCount || Slots[SlotIndex].Generation != Handle.GetGeneration()) {
+				return false;
+			}
+
+			const THandleType DenseIndex = Slots[SlotIndex].DenseIndex;
+			const THandleType LastIndex = static_cast<THandleType>(--Size);
+
+			if (DenseIndex != LastIndex) {
+				//Keep the storage packed
+				Dense[DenseIndex] = std::move(Dense[LastIndex]);
+				DenseToSlot[DenseIndex] = DenseToSlot[LastIndex];
+				Slots[DenseToSlot[DenseIndex]].DenseIndex = DenseIndex;
+			}
+
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				Dense[LastIndex].~T();
+			}
+
+			//Invalidate all the handles to this slot
+			if (Slots[SlotIndex].Generation == HandleType::MyGenerationMask) {
+				//The generation would wrap and the oldest handles would resolve again, retire the slot
+				//No handle has generation 0, the slot never resolves again
+				Slots[SlotIndex].Generation = 0;
+				return true;
+			}
+
+			Slots[SlotIndex].Generation++;
+			Slots[SlotIndex].DenseIndex = FreeSlotsHead;
+			FreeSlotsHead = SlotIndex;
+
+			return true;
+		}
+
+		//Destroy all objects, all handles become stale
+		void Clear() noexcept {
+			while (Size) {
+				Destroy(HandleType(DenseToSlot[Size - 1], Slots[DenseToSlot[Size - 1]].Generation));
+			}
+		}
+
+		//Handle of the object at [DenseIndex] (in memory order)
+		FORCEINLINE HandleType GetHandleAt(size_t DenseIndex) const noexcept {
+			const THandleType SlotIndex = DenseToSlot[DenseIndex];
+			return HandleType(SlotIndex, Slots[SlotIndex].Generation);
+		}
+
+		//Iterate the live objects in memory order
+		FORCEINLINE T* begin() noexcept {
+			return Dense.Get();
+		}
+		FORCEINLINE T* end() noexcept {
+			return Dense.Get() + Size;
+		}
+		FORCEINLINE const T* begin() const noexcept {
+			return Dense.Get();
+		}
+		FORCEINLINE const T* end() const noexcept {
+			return Dense.Get() + Size;
+		}
+
+		FORCEINLINE size_t GetSize() const noexcept {
+			return Size;
+		}
+
+		FORCEINLINE size_t GetCapacity() const noexcept {
+			return Capacity;
+		}
+
+	private:
+		static constexpr THandleType InvalidIndex = THandleType(~THandleType(0));
+		static constexpr size_t MaxSlotsCount = size_t(1) << IndexBits;
+
+		struct Slot {
+			THandleType DenseIndex;	//Index into Dense if live, next free slot if free
+			THandleType Generation;
+		};
+
+		//Double the slot array (up to MaxSlotsCount), returns false if it cant grow
+		//New slot indices replace the retired slots, the slots are addressed by index only so the array can be moved
+		bool GrowSlots() noexcept {
+			const size_t NewCapacity = SlotsCapacity * 2 < MaxSlotsCount ? SlotsCapacity * 2 : MaxSlotsCount;
+			if (NewCapacity <= SlotsCapacity) {
+				return false;
+			}
+
+			MPtr<Slot> NewSlots = MemoryManager::AllocBuffer<Slot, true>(NewCapacity);
+			if (NewSlots.IsNull()) {
+				return false;
+			}
+
+			memcpy(NewSlots.Get(), Slots.Get(), sizeof(Slot) * SlotsCount);
+
+			Slots = std::move(NewSlots);
+			SlotsCapacity = NewCapacity;
+
+			return true;
+		}
+
+		MPtr<T>				Dense;
+		MPtr<THandleType>	DenseToSlot;
+		MPtr<Slot>			Slots;
+		size_t				SlotsCapacity{ 0 };
+		size_t				Capacity{ 0 };
+		size_t				Size{ 0 };
+		size_t				SlotsCount{ 0 };
+		THandleType			FreeSlotsHead{ InvalidIndex };
+	};
+}
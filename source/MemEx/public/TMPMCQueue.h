@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * @file TMPMCQueue.h
+ *
+ * @brief TMPMCQueue: Bounded lock-free multi producer multi consumer queue (Vyukov)
+			Ring of [Capacity] cells, each cell has a sequence number that tells the producers and the consumers whose
+			turn it is, a push or a pop is one CAS on its position and no shared lock.
+			The queued nodes are MemoryManager blocks (MPtr<T>), T needs no embedded link.
+			The queue owns the queued nodes, the ones left are destroyed with the queue.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//[Capacity] - max number of queued nodes (power of 2)
+	template<typename T, size_t Capacity>
+	class TMPMCQueue {
+	public:
+		static_assert(Capacity >= 2 && IsPowerOf2(Capacity), "TMPMCQueue Capacity must be a power of 2");
+
+		TMPMCQueue() noexcept {
+			for (size_t i = 0; i < Capacity; i++) {
+				Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		~TMPMCQueue() noexcept {
+			while (TryPop()) {}
+		}
+
+		//Cant copy or move
+		TMPMCQueue(const TMPMCQueue&) = delete;
+		TMPMCQueue& operator=(const TMPMCQueue&) = delete;
+
+		//Enqueue [Node], any thread
+		//Returns false if the queue is full, [Node] is left untouched
+		bool TryPush(MPtr<T>&& Node) noexcept {
+			Cell* Target;
+			size_t Position = EnqueuePosition.load(std::memory_order_relaxed);
+
+			for (;;) {
+				Target = &Cells[Position & Mask];
+
+				const size_t Sequence = Target->Sequence.load(std::memory_order_acquire);
+				const intptr_t Difference = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position);
+
+				if (Difference == 0) {
+					if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				}
+				else if (Difference < 0) {
+					//The cell was not popped since the last lap
+					return false;
+				}
+				else {
+					Position = EnqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			Target->Value = Node.Release();
+			Target->Sequence.store(Position + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		//Dequeue the oldest node, any thread
+		//Returns null if the queue is empty
+		MPtr<T> TryPop() noexcept {
+			Cell* Target;
+			size_t Position = DequeuePosition.load(std::memory_order_relaxed);
+
+			for (;;) {
+				Target = &Cells[Position & Mask];
+
+				const size_t Sequence = Target->Sequence.load(std::memory_order_acquire);
+				const intptr_t Difference = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position + 1);
+
+				if (Difference == 0) {
+					if (DequeuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				}
+				else if (Difference < 0) {
+					//The cell was not pushed yet
+					return { };
+				}
+				else {
+					Position = DequeuePosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			T* Value = Target->Value;
+			Target->Sequence.store(Position + Mask + 1, std::memory_order_release);
+
+			return MPtr<T>(Value);
+		}
+
+		//Approximate number of queued nodes
+		FORCEINLINE size_t GetCount() const noexcept {
+			const size_t Dequeued = DequeuePosition.load(std::memory_order_relaxed);
+			const size_t Enqueued = EnqueuePosition.load(std::memory_order_relaxed);
+
+			return Enqueued > Dequeued ? Enqueued - Dequeued : 0;
+		}
+
+		static constexpr size_t GetCapacity() noexcept {
+			return Capacity;
+		}
+
+	private:
+		static constexpr size_t Mask = Capacity - 1;
+
+		struct Cell {
+			std::atomic<size_t>	Sequence{ 0 };
+			T*					Value{ nullptr };
+		};
+
+		alignas(MEMEX_CACHE_LINE_SIZE) Cell					Cells[Capacity];
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>	EnqueuePosition{ 0 };
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>	DequeuePosition{ 0 };
+	};
+}
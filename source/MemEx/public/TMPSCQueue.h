@@ -0,0 +1,120 @@
+#pragma once
+/**
+ * @file TMPSCQueue.h
+ *
+ * @brief TMPSCQueue: Intrusive lock-free multi producer single consumer queue (Vyukov)
+			The link is embedded in the queued T (derive MQueueNode, eg. next to IResource<T>), the nodes are the
+			MemoryManager blocks of the T's themselves (MPtr<T>), queuing a message allocates nothing but the message.
+			Push is wait-free (one exchange), Pop is lock-free for the single consumer thread.
+			Pop can return nullptr while a producer is between its exchange and its link store, the message is
+			returned by a later Pop.
+			The queue owns the queued messages, the ones left are destroyed with the queue.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//Link of a queued object (see TMPSCQueue)
+	class MQueueNode {
+	public:
+		MQueueNode() noexcept {}
+
+		//The link is not copied, the copy is not queued
+		MQueueNode(const MQueueNode&) noexcept {}
+		MQueueNode& operator=(const MQueueNode&) noexcept {
+			return *this;
+		}
+
+	private:
+		std::atomic<MQueueNode*> QueueNext{ nullptr };
+
+		template<typename T>
+		friend class TMPSCQueue;
+	};
+
+	template<typename T>
+	class TMPSCQueue {
+	public:
+		static_assert(std::is_base_of_v<MQueueNode, T>, "TMPSCQueue<T> requires T to derive MQueueNode");
+
+		TMPSCQueue() noexcept {}
+
+		~TMPSCQueue() noexcept {
+			while (Pop()) {}
+		}
+
+		//Cant copy or move (the stub node is linked by address)
+		TMPSCQueue(const TMPSCQueue&) = delete;
+		TMPSCQueue& operator=(const TMPSCQueue&) = delete;
+
+		//Enqueue [Node], any thread
+		FORCEINLINE void Push(MPtr<T>&& Node) noexcept {
+			if (Node.IsNull()) {
+				return;
+			}
+
+			PushNode(static_cast<MQueueNode*>(Node.Release()));
+		}
+
+		//Dequeue the oldest node, consumer thread only
+		//Returns null if the queue is empty (or the next node is not linked yet)
+		MPtr<T> Pop() noexcept {
+			MQueueNode* Tail = this->Tail;
+			MQueueNode* Next = Tail->QueueNext.load(std::memory_order_acquire);
+
+			//Skip the stub
+			if (Tail == &Stub) {
+				if (!Next) {
+					return { };
+				}
+
+				this->Tail = Next;
+				Tail = Next;
+				Next = Next->QueueNext.load(std::memory_order_acquire);
+			}
+
+			if (Next) {
+				this->Tail = Next;
+				return MPtr<T>(static_cast<T*>(Tail));
+			}
+
+			//A producer swapped the head but did not link the node yet
+			if (Tail != Head.load(std::memory_order_acquire)) {
+				return { };
+			}
+
+			//Tail is the last node, push the stub behind it so Tail can be unlinked
+			PushNode(&Stub);
+
+			Next = Tail->QueueNext.load(std::memory_order_acquire);
+			if (Next) {
+				this->Tail = Next;
+				return MPtr<T>(static_cast<T*>(Tail));
+			}
+
+			return { };
+		}
+
+		//Approximate, consumer thread only
+		FORCEINLINE bool IsEmpty() const noexcept {
+			return Tail == &Stub && !Stub.QueueNext.load(std::memory_order_acquire);
+		}
+
+	private:
+		FORCEINLINE void PushNode(MQueueNode* Node) noexcept {
+			Node->QueueNext.store(nullptr, std::memory_order_relaxed);
+
+			MQueueNode* Previous = Head.exchange(Node, std::memory_order_acq_rel);
+			Previous->QueueNext.store(Node, std::memory_order_release);
+		}
+
+		//Producers side
+		alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<MQueueNode*>	Head{ &Stub };
+
+		//Consumer side
+		alignas(MEMEX_CACHE_LINE_SIZE) MQueueNode*				Tail{ &Stub };
+		MQueueNode												Stub;
+	};
+}
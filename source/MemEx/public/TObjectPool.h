@@ -3,161 +3,586 @@
  * @file TObjectPool.h
  *
  * @brief TObjectPool: Ring based thread safe object pool
+			TObjectPool is the process wide pool of T (static API), TObjectPoolInstance holds the state and can be instanced
+			on its own (see MHeap)
+			The pool is striped into [ShardsCount] cache line isolated shards, each thread uses the shard
+			of the CPU it is running on and steals from the other shards when its own shard runs empty
 			bUseSpinLock:
 				[true] : SpinLock is used for synchronization [default]
 				[false]: Atomic operations are used for synchronization
+			bLIFO:
+				[true] : The most recently deallocated block (still cache hot) is allocated first
+				[false]: Blocks are reused in FIFO order, the atomic mode is always FIFO [default, PoolReuseLIFO]
+			When the pool runs empty the exhaustion policy decides what happens (see SetExhaustionPolicy):
+				Grow    : a new block is allocated with GAllocate [default]
+				FailFast: the allocation fails (nullptr), the pool never holds more than PoolSize blocks
+				Wait    : the allocating thread waits for a block to be deallocated, up to the wait timeout
+			ColorsCount:
+				Blocks of at least PoolCacheColoringMinSize bytes are placed at [ColorsCount] rotating cache line offsets
+				(colors) inside their OS allocation, so the same fields of many blocks do not map to the same cache sets
+				[PoolCacheColorsCount default], 1 disables the coloring
  *
  * @author Balan Narcis
  * Contact: balannarcis96@gmail.com
  *
  */
 
+#include <algorithm>
+#include <chrono>
+
 namespace MemEx {
-	template<typename T, size_t PoolSize, bool bUseSpinLock = true>
-	class TObjectPool {
+	enum class EPoolExhaustionPolicy : uint32_t {
+		Grow,
+		FailFast,
+		Wait
+	};
+
+	struct PoolWaitStatistics {
+		size_t Waiters{ 0 };			//Threads currently waiting for a block
+		size_t TotalWaits{ 0 };			//Allocations that had to wait
+		size_t TotalTimeouts{ 0 };		//Waits that timed out
+		size_t TotalFailures{ 0 };		//Failed allocations (fail fast and timeouts)
+		size_t TotalWaitTimeUs{ 0 };	//Sum of all the wait times
+		size_t MaxWaitTimeUs{ 0 };		//Longest wait
+	};
+
+	//Storage and synchronization of a pool of T blocks, TObjectPool uses one process wide instance
+	//Instances can be embedded in other objects (see MHeap), blocks are never shared between instances
+	template<typename T, size_t PoolSize, bool bUseSpinLock = true, size_t ShardsCount = PoolShardsCount, bool bLIFO = PoolReuseLIFO, size_t ColorsCount = PoolCacheColorsCount>
+	class TObjectPoolInstance {
 	public:
 		struct PoolTraits {
 			static const size_t MyPoolSize = PoolSize;
-			static const size_t MyPoolMask = PoolSize - 1;
+			static const size_t MyShardsCount = ShardsCount;
+			static const size_t MyShardsMask = ShardsCount - 1;
+			static const size_t MyShardSize = PoolSize / ShardsCount;
+			static const size_t MyShardMask = MyShardSize - 1;
 
 			using MyPoolType = T;
-			using MyType = TObjectPool<T, PoolSize>;
+			using MyType = TObjectPoolInstance<T, PoolSize, bUseSpinLock, ShardsCount, bLIFO, ColorsCount>;
 
-			static_assert((MyPoolSize& MyPoolMask) == 0, "TObjectPool size must be a power of 2");
+			static constexpr bool bIsLIFO = bLIFO && bUseSpinLock;
 
-#ifdef MEMEX_STATISTICS
-			static inline std::atomic<size_t> TotalAllocations{ 0 };
-			static inline std::atomic<size_t> TotalDeallocations{ 0 };
+			//Distance between two colors and the alignment of the OS allocations (the color is recovered from the block address)
+			static constexpr size_t MyColorsCount = sizeof(T) >= PoolCacheColoringMinSize ? ColorsCount : 1;
+			static constexpr size_t MyColorStep = alignof(T) > MEMEX_CACHE_LINE_SIZE ? alignof(T) : MEMEX_CACHE_LINE_SIZE;
+			static constexpr size_t MyStorageAlignment = MyColorsCount > 1 ? MyColorStep * MyColorsCount : alignof(T);
 
-			static inline std::atomic<size_t> TotalOSAllocations{ 0 };
-			static inline std::atomic<size_t> TotalOSDeallocations{ 0 };
-#endif
+			static_assert(IsPowerOf2(MyPoolSize), "TObjectPool size must be a power of 2");
+			static_assert(IsPowerOf2(MyShardsCount), "TObjectPool shards count must be a power of 2");
+			static_assert(MyShardsCount <= MyPoolSize, "TObjectPool shards count must not exceed the pool size");
+			static_assert(ColorsCount > 0 && IsPowerOf2(ColorsCount), "TObjectPool colors count must be a power of 2");
 		};
 
 		//Preallocate and fill the whole Pool with [PoolSize] elements
-		static bool Preallocate() noexcept {
+		//Elements are allocated with alignof(T) so over-aligned T's (eg. cache line aligned) are placed correctly
+		//Blocks already held by the pool count towards [PoolSize]
+		bool Preallocate() noexcept {
 			// ! Hopefully GAllocate will allocate in a continuous fashion.
 
-			for (size_t i = 0; i < PoolSize; i++)
+			for (size_t ShardIndex = 0; ShardIndex < ShardsCount; ShardIndex++)
 			{
-				Pool[i] = GAllocate(sizeof(T), ALIGNMENT);
-				if (Pool[i] == nullptr) {
-					return false;
+				PoolShard& Shard = Shards[ShardIndex];
+
+				const uint64_t HeldCount = Shard.TailPosition.load(std::memory_order_relaxed) - Shard.HeadPosition.load(std::memory_order_relaxed);
+
+				for (size_t i = HeldCount; i < PoolTraits::MyShardSize; i++)
+				{
+					ptr_t Block = AllocateStorage(Shard);
+					if (Block == nullptr) {
+						return false;
+					}
+
+					//Preallocate is called while the pool is not used, no need to synchronize
+					const uint64_t InsPos = Shard.TailPosition.load(std::memory_order_relaxed);
+					Shard.Pool[InsPos & PoolTraits::MyShardMask].store(Block, std::memory_order_relaxed);
+					Shard.TailPosition.store(InsPos + 1, std::memory_order_relaxed);
 				}
 			}
 
 			return true;
 		}
 
-		//Allocate raw ptr T
-		template<typename ...Types>
-		static T* NewRaw(Types... Args) noexcept {
-			return Allocate(std::forward<Types...>(Args)...);
-		}
+		//Allocate raw storage of sizeof(T) bytes (alignof(T) aligned), no constructor is called
+		ptr_t AllocateRaw() noexcept {
+			const size_t ShardIndex = GetCurrentProcessorIndex() & PoolTraits::MyShardsMask;
+			PoolShard& Shard = Shards[ShardIndex];
 
-		//Deallocate T
-		static void Deallocate(T* Obj) noexcept {
+			ptr_t Allocated = PopAny(ShardIndex);
 
-			if constexpr (std::is_destructible_v<T>) {
-				//Call destructor manually
-				Obj->~T();
+			if (!Allocated) {
+				const EPoolExhaustionPolicy Policy = Bounds.Policy.load(std::memory_order_relaxed);
+
+				if (Policy == EPoolExhaustionPolicy::Grow) {
+					Allocated = AllocateStorage(Shard);
+					if (!Allocated) {
+						return nullptr;
+					}
+
+#ifdef MEMEX_STATISTICS
+					Shard.TotalOSAllocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+				}
+				else if (Policy == EPoolExhaustionPolicy::Wait) {
+					Allocated = WaitForBlock(ShardIndex);
+					if (!Allocated) {
+						return nullptr;
+					}
+				}
+				else {
+					Bounds.TotalFailures.fetch_add(1, std::memory_order_relaxed);
+					return nullptr;
+				}
 			}
 
+#ifdef MEMEX_STATISTICS
+			Shard.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+			return Allocated;
+		}
+
+		//Return raw storage obtained from AllocateRaw() (or a destroyed T) to the pool, no destructor is called
+		void DeallocateRaw(ptr_t Obj) noexcept {
+			const size_t ShardIndex = GetCurrentProcessorIndex() & PoolTraits::MyShardsMask;
+			PoolShard& Shard = Shards[ShardIndex];
+
 			ptr_t PrevVal{ nullptr };
 
 			if constexpr (bUseSpinLock) {
-				{ //Critical section
-					SpinLockScopeGuard Guard(&SpinLock);
-
-					const uint64_t InsPos = TailPosition++;
+				if (!Push(Shard, Obj)) {
+					//Shard is full
+					PrevVal = Obj;
+
+					//Bounded pool, keep the block in one of the other shards (they can't all be full)
+					if (Bounds.Policy.load(std::memory_order_relaxed) != EPoolExhaustionPolicy::Grow) {
+						for (size_t i = 1; PrevVal && i < ShardsCount; i++) {
+							if (Push(Shards[(ShardIndex + i) & PoolTraits::MyShardsMask], Obj)) {
+								PrevVal = nullptr;
+							}
+						}
+					}
+				}
 
-					PrevVal = Pool[InsPos & PoolTraits::MyPoolMask];
-					Pool[InsPos & PoolTraits::MyPoolMask] = (ptr_t)Obj;
+				if (!PrevVal) {
+					WakeWaiter();
 				}
 			}
 			else {
-				uint64_t InsPos = (uint64_t)InterlockedIncrement64((volatile long long*)(&TailPosition));
-				InsPos--;
+				const uint64_t InsPos = Shard.TailPosition.fetch_add(1, std::memory_order_acq_rel);
 
-				PrevVal = InterlockedExchangePointer(
-					reinterpret_cast<volatile ptr_t*>(&Pool[InsPos & PoolTraits::MyPoolMask]),
-					reinterpret_cast<ptr_t>(Obj)
-				);
+				PrevVal = Shard.Pool[InsPos & PoolTraits::MyShardMask].exchange((ptr_t)Obj, std::memory_order_acq_rel);
 			}
 
 			if (PrevVal)
 			{
-				GFree(PrevVal);
+				FreeStorage(PrevVal);
 
 #ifdef MEMEX_STATISTICS
-				PoolTraits::TotalOSDeallocations++;
+				Shard.TotalOSDeallocations.fetch_add(1, std::memory_order_relaxed);
 #endif
 
 				return;
 			}
 
 #ifdef MEMEX_STATISTICS
-			PoolTraits::TotalDeallocations++;
+			Shard.TotalDeallocations.fetch_add(1, std::memory_order_relaxed);
 #endif
 		}
 
-		//Get GUID of this Pool instance
-		static size_t GetPoolId() {
-			return (size_t)(&PoolTraits::MyType::Preallocate);
+		//Set what happens when the pool runs empty, [WaitTimeoutMs] is used by EPoolExhaustionPolicy::Wait (0 - wait forever)
+		//The bounded policies (FailFast, Wait) require bUseSpinLock, returns false if not supported
+		bool SetExhaustionPolicy(EPoolExhaustionPolicy Policy, uint32_t WaitTimeoutMs = 0) noexcept {
+			if constexpr (!bUseSpinLock) {
+				if (Policy != EPoolExhaustionPolicy::Grow) {
+					return false;
+				}
+			}
+
+			Bounds.WaitTimeoutMs.store(WaitTimeoutMs, std::memory_order_relaxed);
+			Bounds.Policy.store(Policy, std::memory_order_relaxed);
+
+			//Release the waiters so they observe the new policy
+			Bounds.FreeSignal.fetch_add(1, std::memory_order_release);
+			Bounds.FreeSignal.notify_all();
+
+			return true;
+		}
+
+		EPoolExhaustionPolicy GetExhaustionPolicy() const noexcept {
+			return Bounds.Policy.load(std::memory_order_relaxed);
+		}
+
+		PoolWaitStatistics GetWaitStatistics() const noexcept {
+			PoolWaitStatistics Result;
+
+			Result.Waiters = Bounds.Waiters.load(std::memory_order_relaxed);
+			Result.TotalWaits = Bounds.TotalWaits.load(std::memory_order_relaxed);
+			Result.TotalTimeouts = Bounds.TotalTimeouts.load(std::memory_order_relaxed);
+			Result.TotalFailures = Bounds.TotalFailures.load(std::memory_order_relaxed);
+			Result.TotalWaitTimeUs = Bounds.TotalWaitTimeUs.load(std::memory_order_relaxed);
+			Result.MaxWaitTimeUs = Bounds.MaxWaitTimeUs.load(std::memory_order_relaxed);
+
+			return Result;
 		}
 
+		//Free all the blocks held by the pool, the blocks allocated from the pool and not yet returned are not affected
+		//No other thread may use the pool during the call
+		void Release() noexcept {
+			for (size_t ShardIndex = 0; ShardIndex < ShardsCount; ShardIndex++) {
+				PoolShard& Shard = Shards[ShardIndex];
+
+				for (ptr_t Block = Pop(Shard); Block; Block = Pop(Shard)) {
+					FreeStorage(Block);
+
 #ifdef MEMEX_STATISTICS
-		static size_t GetTotalOSDeallocations() {
-			return PoolTraits::TotalOSDeallocations;
+					Shard.TotalOSDeallocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+				}
+			}
 		}
 
-		static size_t GetTotalOSAllocations() {
-			return PoolTraits::TotalOSAllocations;
+#ifdef MEMEX_STATISTICS
+		size_t GetTotalOSDeallocations() const noexcept {
+			return SumShards(&PoolShard::TotalOSDeallocations);
 		}
 
-		static size_t GetTotalDeallocations() {
-			return PoolTraits::TotalDeallocations;
+		size_t GetTotalOSAllocations() const noexcept {
+			return SumShards(&PoolShard::TotalOSAllocations);
 		}
 
-		static size_t GetTotalAllocations() {
-			return PoolTraits::TotalAllocations;
+		size_t GetTotalDeallocations() const noexcept {
+			return SumShards(&PoolShard::TotalDeallocations);
+		}
+
+		size_t GetTotalAllocations() const noexcept {
+			return SumShards(&PoolShard::TotalAllocations);
 		}
 #endif
 
 	private:
-		template<typename ...Types>
-		static T* Allocate(Types... Args) noexcept {
-			T* Allocated{ nullptr };
+		//Cache line isolated shard of the pool, head and tail live on separate cache lines
+		struct alignas(MEMEX_CACHE_LINE_SIZE) PoolShard {
+			alignas(MEMEX_CACHE_LINE_SIZE) SpinLock					Lock{ };
+			std::atomic<uint32_t>									NextColor{ 0 };
+			alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<uint64_t>	HeadPosition{ 0 };
+			alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<uint64_t>	TailPosition{ 0 };
 
-			if constexpr (bUseSpinLock) {
-				{ //Critical section
-					SpinLockScopeGuard Guard(&SpinLock);
+#ifdef MEMEX_STATISTICS
+			alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>		TotalAllocations{ 0 };
+			std::atomic<size_t>										TotalDeallocations{ 0 };
+			std::atomic<size_t>										TotalOSAllocations{ 0 };
+			std::atomic<size_t>										TotalOSDeallocations{ 0 };
+#endif
 
-					const uint64_t PopPos = HeadPosition++;
+			alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<ptr_t>		Pool[PoolTraits::MyShardSize]{ };
+		};
 
-					Allocated = reinterpret_cast<T*>(Pool[PopPos & PoolTraits::MyPoolMask]);
-					Pool[PopPos & PoolTraits::MyPoolMask] = nullptr;
-				}
+		//Exhaustion policy state, shared by all the shards
+		struct alignas(MEMEX_CACHE_LINE_SIZE) PoolBounds {
+			std::atomic<EPoolExhaustionPolicy>						Policy{ EPoolExhaustionPolicy::Grow };
+			std::atomic<uint32_t>									WaitTimeoutMs{ 0 };
+
+			alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<uint32_t>	FreeSignal{ 0 };
+			std::atomic<size_t>										Waiters{ 0 };
+
+			alignas(MEMEX_CACHE_LINE_SIZE) std::atomic<size_t>		TotalWaits{ 0 };
+			std::atomic<size_t>										TotalTimeouts{ 0 };
+			std::atomic<size_t>										TotalFailures{ 0 };
+			std::atomic<size_t>										TotalWaitTimeUs{ 0 };
+			std::atomic<size_t>										MaxWaitTimeUs{ 0 };
+		};
+
+		//Allocate the OS storage of a block, the block is placed at the next color of [Shard]
+		//	[Padding: Color * MyColorStep][T]
+		FORCEINLINE ptr_t AllocateStorage(PoolShard& Shard) noexcept {
+			if constexpr (PoolTraits::MyColorsCount == 1) {
+				return GAllocate(sizeof(T), alignof(T));
+			}
+			else {
+				const size_t Offset = (Shard.NextColor.fetch_add(1, std::memory_order_relaxed) & (PoolTraits::MyColorsCount - 1)) * PoolTraits::MyColorStep;
+
+				uint8_t* Storage = reinterpret_cast<uint8_t*>(GAllocate(sizeof(T) + Offset, PoolTraits::MyStorageAlignment));
+
+				return Storage ? Storage + Offset : nullptr;
+			}
+		}
+
+		//Free the OS storage of [Block] (see AllocateStorage)
+		FORCEINLINE static void FreeStorage(ptr_t Block) noexcept {
+			if constexpr (PoolTraits::MyColorsCount == 1) {
+				GFree(Block);
 			}
 			else {
-				uint64_t PopPos = (uint64_t)InterlockedIncrement64(reinterpret_cast<volatile long long*>(&HeadPosition));
-				PopPos--;
+				GFree(reinterpret_cast<ptr_t>(reinterpret_cast<size_t>(Block) & ~(PoolTraits::MyStorageAlignment - 1)));
+			}
+		}
 
-				Allocated = reinterpret_cast<T*>(InterlockedExchangePointer(
-					reinterpret_cast<volatile ptr_t*>(&Pool[PopPos & PoolTraits::MyPoolMask]),
-					nullptr
-				));
+		//Push [Obj] into [Shard], false if the shard is full (spin lock mode only)
+		FORCEINLINE bool Push(PoolShard& Shard, ptr_t Obj) noexcept {
+			SpinLockScopeGuard Guard(&Shard.Lock);
+
+			const uint64_t InsPos = Shard.TailPosition.load(std::memory_order_relaxed);
+			if (InsPos - Shard.HeadPosition.load(std::memory_order_relaxed) == PoolTraits::MyShardSize) {
+				return false;
 			}
 
+			Shard.Pool[InsPos & PoolTraits::MyShardMask].store(Obj, std::memory_order_relaxed);
+			Shard.TailPosition.store(InsPos + 1, std::memory_order_relaxed);
+
+			return true;
+		}
+
+		//Prefetch the first (header) and the second (first payload line of MemoryManager blocks) cache lines of [Block]
+		FORCEINLINE static void PrefetchBlock(ptr_t Block) noexcept {
+			if (!Block) {
+				return;
+			}
+
+			_mm_prefetch(reinterpret_cast<const char*>(Block), _MM_HINT_T0);
+
+			if constexpr (sizeof(T) > MEMEX_CACHE_LINE_SIZE) {
+				_mm_prefetch(reinterpret_cast<const char*>(Block) + MEMEX_CACHE_LINE_SIZE, _MM_HINT_T0);
+			}
+		}
+
+		//Pop from the shard [ShardIndex], steal from the other shards if it is empty
+		FORCEINLINE ptr_t PopAny(size_t ShardIndex) noexcept {
+			ptr_t Allocated = Pop(Shards[ShardIndex]);
+
+			for (size_t i = 1; !Allocated && i < ShardsCount; i++) {
+				Allocated = Pop(Shards[(ShardIndex + i) & PoolTraits::MyShardsMask]);
+			}
+
+			return Allocated;
+		}
+
+		//Called after a block was returned to the pool
+		FORCEINLINE void WakeWaiter() noexcept {
+			if (Bounds.Policy.load(std::memory_order_relaxed) != EPoolExhaustionPolicy::Wait) {
+				return;
+			}
+
+			//Pairs with the fence in WaitForBlock, either the waiter sees the block or we see the waiter
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (Bounds.Waiters.load(std::memory_order_relaxed)) {
+				Bounds.FreeSignal.fetch_add(1, std::memory_order_release);
+				Bounds.FreeSignal.notify_one();
+			}
+		}
+
+		//Wait until a block is deallocated or the wait timeout expires, nullptr on timeout
+		//Without a timeout the thread blocks in std::atomic::wait, timed waits poll the signal with a growing backoff
+		ptr_t WaitForBlock(size_t ShardIndex) noexcept {
+			using Clock = std::chrono::steady_clock;
+
+			const uint32_t TimeoutMs = Bounds.WaitTimeoutMs.load(std::memory_order_relaxed);
+			const Clock::time_point Start = Clock::now();
+			const Clock::time_point Deadline = Start + std::chrono::milliseconds(TimeoutMs);
+
+			Bounds.Waiters.fetch_add(1, std::memory_order_relaxed);
+			Bounds.TotalWaits.fetch_add(1, std::memory_order_relaxed);
+
+			ptr_t Allocated = nullptr;
+			uint32_t Backoff = 1;
+
+			for (;;) {
+				const uint32_t Signal = Bounds.FreeSignal.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				Allocated = PopAny(ShardIndex);
+				if (Allocated || Bounds.Policy.load(std::memory_order_relaxed) != EPoolExhaustionPolicy::Wait) {
+					break;
+				}
+
+				if (!TimeoutMs) {
+					Bounds.FreeSignal.wait(Signal, std::memory_order_acquire);
+					continue;
+				}
+
+				const Clock::time_point Now = Clock::now();
+				if (Now >= Deadline) {
+					Bounds.TotalTimeouts.fetch_add(1, std::memory_order_relaxed);
+					break;
+				}
+
+				if (Bounds.FreeSignal.load(std::memory_order_acquire) == Signal) {
+					const Clock::duration Sleep = std::min<Clock::duration>(std::chrono::microseconds(Backoff), Deadline - Now);
+					std::this_thread::sleep_for(Sleep);
+
+					Backoff = Backoff < 1000 ? Backoff * 2 : Backoff;
+				}
+			}
+
+			Bounds.Waiters.fetch_sub(1, std::memory_order_relaxed);
+
 			if (!Allocated) {
-				Allocated = (T*)GAllocate(sizeof(T), ALIGNMENT);
-				if (!Allocated) {
+				Bounds.TotalFailures.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			const size_t WaitTimeUs = static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - Start).count());
+			Bounds.TotalWaitTimeUs.fetch_add(WaitTimeUs, std::memory_order_relaxed);
+
+			size_t MaxWaitTimeUs = Bounds.MaxWaitTimeUs.load(std::memory_order_relaxed);
+			while (WaitTimeUs > MaxWaitTimeUs && !Bounds.MaxWaitTimeUs.compare_exchange_weak(MaxWaitTimeUs, WaitTimeUs, std::memory_order_relaxed)) {}
+
+			return Allocated;
+		}
+
+		//Pop a block from [Shard], nullptr if the shard is empty
+		FORCEINLINE ptr_t Pop(PoolShard& Shard) noexcept {
+			if constexpr (bUseSpinLock) {
+				//Cheap check before taking the lock (used when stealing from other shards)
+				if (Shard.TailPosition.load(std::memory_order_relaxed) == Shard.HeadPosition.load(std::memory_order_relaxed)) {
+					return nullptr;
+				}
+
+				ptr_t Block;
+				ptr_t NextBlock{ nullptr };
+
+				{ //Critical section
+					SpinLockScopeGuard Guard(&Shard.Lock);
+
+					const uint64_t HeadPos = Shard.HeadPosition.load(std::memory_order_relaxed);
+					const uint64_t TailPos = Shard.TailPosition.load(std::memory_order_relaxed);
+					if (HeadPos == TailPos) {
+						//Shard is empty
+						return nullptr;
+					}
+
+					if constexpr (PoolTraits::bIsLIFO) {
+						//Pop the most recently deallocated block
+						Shard.TailPosition.store(TailPos - 1, std::memory_order_relaxed);
+
+						Block = Shard.Pool[(TailPos - 1) & PoolTraits::MyShardMask].exchange(nullptr, std::memory_order_relaxed);
+						if (TailPos - 1 != HeadPos) {
+							NextBlock = Shard.Pool[(TailPos - 2) & PoolTraits::MyShardMask].load(std::memory_order_relaxed);
+						}
+					}
+					else {
+						Shard.HeadPosition.store(HeadPos + 1, std::memory_order_relaxed);
+
+						Block = Shard.Pool[HeadPos & PoolTraits::MyShardMask].exchange(nullptr, std::memory_order_relaxed);
+						if (HeadPos + 1 != TailPos) {
+							NextBlock = Shard.Pool[(HeadPos + 1) & PoolTraits::MyShardMask].load(std::memory_order_relaxed);
+						}
+					}
+				}
+
+				//The next allocation from this shard will most likely get NextBlock
+				PrefetchBlock(NextBlock);
+
+				return Block;
+			}
+			else {
+				if (Shard.TailPosition.load(std::memory_order_relaxed) <= Shard.HeadPosition.load(std::memory_order_relaxed)) {
 					return nullptr;
 				}
 
+				const uint64_t PopPos = Shard.HeadPosition.fetch_add(1, std::memory_order_acq_rel);
+
+				return Shard.Pool[PopPos & PoolTraits::MyShardMask].exchange(nullptr, std::memory_order_acq_rel);
+			}
+		}
+
 #ifdef MEMEX_STATISTICS
-				PoolTraits::TotalOSAllocations++;
+		size_t SumShards(std::atomic<size_t> PoolShard::* Counter) const noexcept {
+			size_t Total = 0;
+
+			for (size_t i = 0; i < ShardsCount; i++) {
+				Total += (Shards[i].*Counter).load(std::memory_order_relaxed);
+			}
+
+			return Total;
+		}
 #endif
+
+		PoolShard			Shards[ShardsCount]{ };
+		PoolBounds			Bounds{ };
+	};
+
+	template<typename T, size_t PoolSize, bool bUseSpinLock = true, size_t ShardsCount = PoolShardsCount, bool bLIFO = PoolReuseLIFO, size_t ColorsCount = PoolCacheColorsCount>
+	class TObjectPool {
+	public:
+		using InstanceType = TObjectPoolInstance<T, PoolSize, bUseSpinLock, ShardsCount, bLIFO, ColorsCount>;
+
+		using PoolTraits = typename InstanceType::PoolTraits;
+
+		//Preallocate and fill the whole Pool with [PoolSize] elements
+		FORCEINLINE static bool Preallocate() noexcept {
+			return Instance.Preallocate();
+		}
+
+		//Allocate raw ptr T
+		template<typename ...Types>
+		static T* NewRaw(Types... Args) noexcept {
+			return Allocate(std::forward<Types>(Args)...);
+		}
+
+		//Deallocate T
+		static void Deallocate(T* Obj) noexcept {
+
+			if constexpr (std::is_destructible_v<T>) {
+				//Call destructor manually
+				Obj->~T();
+			}
+
+			DeallocateRaw(Obj);
+		}
+
+		//Allocate raw storage of sizeof(T) bytes (alignof(T) aligned), no constructor is called
+		FORCEINLINE static ptr_t AllocateRaw() noexcept {
+			return Instance.AllocateRaw();
+		}
+
+		//Return raw storage obtained from AllocateRaw() (or a destroyed T) to the pool, no destructor is called
+		FORCEINLINE static void DeallocateRaw(ptr_t Obj) noexcept {
+			Instance.DeallocateRaw(Obj);
+		}
+
+		//See TObjectPoolInstance::SetExhaustionPolicy
+		static bool SetExhaustionPolicy(EPoolExhaustionPolicy Policy, uint32_t WaitTimeoutMs = 0) noexcept {
+			return Instance.SetExhaustionPolicy(Policy, WaitTimeoutMs);
+		}
+
+		static EPoolExhaustionPolicy GetExhaustionPolicy() noexcept {
+			return Instance.GetExhaustionPolicy();
+		}
+
+		static PoolWaitStatistics GetWaitStatistics() noexcept {
+			return Instance.GetWaitStatistics();
+		}
+
+		//Get GUID of this Pool instance
+		static size_t GetPoolId() {
+			return (size_t)(&Instance);
+		}
+
+#ifdef MEMEX_STATISTICS
+		static size_t GetTotalOSDeallocations() {
+			return Instance.GetTotalOSDeallocations();
+		}
+
+		static size_t GetTotalOSAllocations() {
+			return Instance.GetTotalOSAllocations();
+		}
+
+		static size_t GetTotalDeallocations() {
+			return Instance.GetTotalDeallocations();
+		}
+
+		static size_t GetTotalAllocations() {
+			return Instance.GetTotalAllocations();
+		}
+#endif
+
+	private:
+		template<typename ...Types>
+		static T* Allocate(Types... Args) noexcept {
+			T* Allocated = reinterpret_cast<T*>(AllocateRaw());
+			if (!Allocated) {
+				return nullptr;
 			}
 
 			if constexpr (sizeof...(Types) == 0) {
@@ -168,19 +593,13 @@ namespace MemEx {
 			}
 			else {
 				//Call constructor manually
-				new (Allocated) T(std::forward<Types...>(Args)...);
+				new (Allocated) T(std::forward<Types>(Args)...);
 			}
 
-#ifdef MEMEX_STATISTICS
-			PoolTraits::TotalAllocations++;
-#endif
-
 			return Allocated;
 		}
 
-		static	inline ptr_t 				Pool[PoolSize]{ 0 };
-		static	inline uint64_t  			HeadPosition{ 0 };
-		static	inline uint64_t  			TailPosition{ 0 };
-		static	inline SpinLock				SpinLock{ };
+		//Constant initialized, usable by the constructors of other globals
+		static constinit inline InstanceType	Instance{ };
 	};
-}
\ No newline at end of file
+}
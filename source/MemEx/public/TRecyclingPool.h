@@ -0,0 +1,134 @@
+#pragma once
+/**
+ * @file TRecyclingPool.h
+ *
+ * @brief TRecyclingPool: Cache of constructed (warm) T's allocated by the MemoryManager
+			Releasing a T allocated by New does not destroy it, the T::Recycle() (or T::Reset()) hook is called
+			and the object is kept constructed, the next New returns it without running the constructor.
+			At most [MaxWarm] objects are kept warm, the surplus is destroyed normally.
+			Warm objects stay accounted as live memory, call Trim() to destroy them (eg. before Shutdown).
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	template<typename T, size_t MaxWarm>
+	class TRecyclingPool {
+	public:
+		static_assert(MaxWarm > 0, "TRecyclingPool must keep at least one warm object");
+		static_assert(requires(T& Obj) { Obj.Recycle(); } || requires(T& Obj) { Obj.Reset(); }, "TRecyclingPool<T> requires T::Recycle() or T::Reset()");
+
+		//Get a warm T, or a new T constructed from [Args] if there is no warm object
+		template<typename ...Types>
+		static MPtr<T> New(Types... Args) noexcept {
+			IMemoryBlock* BlockObject = PopWarm();
+			if (BlockObject) {
+				//The last release left the reference count at 0
+				BlockObject->RefCount = 1;
+
+				TotalReused.fetch_add(1, std::memory_order_relaxed);
+
+				return MPtr<T>(reinterpret_cast<T*>(BlockObject->Block));
+			}
+
+			MPtr<T> NewObject = MemoryManager::Alloc<T>(std::forward<Types>(Args)...);
+			if (NewObject.IsNull()) {
+				return { };
+			}
+
+			BlockObject = NewObject.GetMemoryBlock();
+
+			//All the T blocks come from the same tier and share the same destroy handler
+			{ //Critical section
+				SpinLockScopeGuard Guard(&Lock);
+
+				if (BaseDestroy.isNull()) {
+					BaseDestroy = BlockObject->Destroy;
+				}
+			}
+
+			BlockObject->Destroy = [](ptr_t Object, bool bCallDestructor = true) -> void {
+				//A destroy that skips the destructor frees the block as is, only a normal release recycles
+				if (!bCallDestructor) {
+					DestroyBlock(reinterpret_cast<IMemoryBlock*>(Object), false);
+					return;
+				}
+
+				Recycle(reinterpret_cast<IMemoryBlock*>(Object));
+			};
+
+			return NewObject;
+		}
+
+		//Destroy all the warm objects
+		static void Trim() noexcept {
+			for (IMemoryBlock* BlockObject = PopWarm(); BlockObject; BlockObject = PopWarm()) {
+				DestroyBlock(BlockObject);
+			}
+		}
+
+		static size_t GetWarmCount() noexcept {
+			SpinLockScopeGuard Guard(&Lock);
+			return WarmCount;
+		}
+
+		//Number of New calls served by a warm object
+		static size_t GetTotalReused() noexcept {
+			return TotalReused.load(std::memory_order_relaxed);
+		}
+
+		//Number of released objects destroyed because MaxWarm objects were already warm
+		static size_t GetTotalSurplusDestroyed() noexcept {
+			return TotalSurplusDestroyed.load(std::memory_order_relaxed);
+		}
+
+	private:
+		static void Recycle(IMemoryBlock* BlockObject) noexcept {
+			T* Obj = reinterpret_cast<T*>(BlockObject->Block);
+
+			if constexpr (requires(T& Obj) { Obj.Recycle(); }) {
+				Obj->Recycle();
+			}
+			else {
+				Obj->Reset();
+			}
+
+			{ //Critical section
+				SpinLockScopeGuard Guard(&Lock);
+
+				if (WarmCount < MaxWarm) {
+					Warm[WarmCount++] = BlockObject;
+					return;
+				}
+			}
+
+			TotalSurplusDestroyed.fetch_add(1, std::memory_order_relaxed);
+			DestroyBlock(BlockObject);
+		}
+
+		static IMemoryBlock* PopWarm() noexcept {
+			SpinLockScopeGuard Guard(&Lock);
+
+			return WarmCount ? Warm[--WarmCount] : nullptr;
+		}
+
+		//Restore the destroy handler of the tier and forward the destroy to it
+		FORCEINLINE static void DestroyBlock(IMemoryBlock* BlockObject, bool bCallDestructor = true) noexcept {
+			{ //Critical section
+				SpinLockScopeGuard Guard(&Lock);
+				BlockObject->Destroy = BaseDestroy;
+			}
+
+			BlockObject->Destroy(BlockObject, bCallDestructor);
+		}
+
+		static inline SpinLock						Lock{ };
+		static inline size_t						WarmCount{ 0 };
+		static inline IMemoryBlock*					Warm[MaxWarm]{ };
+		static inline MemoryBlockDestroyCallback	BaseDestroy{ };
+		static inline std::atomic<size_t>			TotalReused{ 0 };
+		static inline std::atomic<size_t>			TotalSurplusDestroyed{ 0 };
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+/**
+ * @file ThreadCounters.h
+ *
+ * @brief TThreadCounters: Per thread statistics counters
+			Each thread writes only its own slot, with plain loads and stores (no locked instructions on the hot path),
+			readers sum the slots of all the threads.
+			Slots are never freed, the slot of an exited thread is taken over by the next new thread so the values it
+			holds keep contributing to the sums. Counters decremented by other threads may wrap, only the sums are meaningful.
+ *
+ * @author Balan Narcis
+ * Contact: balannarcis96@gmail.com
+ *
+ */
+
+namespace MemEx {
+	//Add [Value] to a counter written only by the calling thread (see TThreadCounters)
+	FORCEINLINE void AddLocalCounter(std::atomic<size_t>& Counter, size_t Value) noexcept {
+		Counter.store(Counter.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+	}
+
+	template<typename TCounters>
+	class TThreadCounters {
+	public:
+		//Counters of the calling thread
+		FORCEINLINE static TCounters& Local() noexcept {
+			if (!LocalSlot) {
+				AcquireSlot();
+			}
+
+			return LocalSlot->Counters;
+		}
+
+		//Call [Visitor](const TCounters&) for the slot of each thread
+		template<typename TVisitor>
+		static void ForEach(const TVisitor& Visitor) noexcept {
+			for (const Slot* It = SlotsHead.load(std::memory_order_acquire); It; It = It->Next) {
+				Visitor(It->Counters);
+			}
+
+			Visitor(OverflowSlot.Counters);
+		}
+
+	private:
+		struct alignas(MEMEX_CACHE_LINE_SIZE) Slot {
+			TCounters			Counters{ };
+			Slot*				Next{ nullptr };
+			std::atomic<bool>	bInUse{ true };
+		};
+
+		//Releases the slot of the thread on exit
+		struct SlotOwner {
+			~SlotOwner() noexcept {
+				if (LocalSlot) {
+					LocalSlot->bInUse.store(false, std::memory_order_release);
+					LocalSlot = nullptr;
+				}
+
+				bOwnerDestroyed = true;
+			}
+		};
+
+		static void AcquireSlot() noexcept {
+			//Take over the slot of an exited thread
+			for (Slot* It = SlotsHead.load(std::memory_order_acquire); It; It = It->Next) {
+				bool bExpected = false;
+				if (!It->bInUse.load(std::memory_order_relaxed) && It->bInUse.compare_exchange_strong(bExpected, true, std::memory_order_acquire)) {
+					LocalSlot = It;
+					break;
+				}
+			}
+
+			if (!LocalSlot) {
+				ptr_t Memory = GAllocate(sizeof(Slot), alignof(Slot));
+				if (!Memory) {
+					//Shared by all the threads that could not get a slot, updates may be lost
+					LocalSlot = &OverflowSlot;
+					return;
+				}
+
+				Slot* NewSlot = new (Memory) Slot();
+
+				NewSlot->Next = SlotsHead.load(std::memory_order_relaxed);
+				while (!SlotsHead.compare_exchange_weak(NewSlot->Next, NewSlot, std::memory_order_release, std::memory_order_relaxed)) {}
+
+				LocalSlot = NewSlot;
+			}
+
+			//Blocks released by thread_local destructors after the owner is gone keep the slot (never reused)
+			if (!bOwnerDestroyed) {
+				static thread_local SlotOwner Owner;
+				(void)Owner;
+			}
+		}
+
+		static inline std::atomic<Slot*>		SlotsHead{ nullptr };
+		static inline Slot						OverflowSlot{ };
+		static inline thread_local Slot*		LocalSlot{ nullptr };
+		static inline thread_local bool			bOwnerDestroyed{ false };
+	};
+}
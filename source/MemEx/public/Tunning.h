@@ -38,4 +38,117 @@ namespace MemEx {
 #define ExtraLargeMemBlockCount   4096
 #endif 
 
+//Fills (AllocBuffer zeroing, AllocBufferFilled, ZeroBlockMemory) larger than this use non-temporal stores, keep it around the LLC size
+#ifndef NonTemporalStoreThreshold
+#define NonTemporalStoreThreshold (8 * 1024 * 1024)
+#endif 
+
+//AllocBufferParallel buffers smaller than this are constructed on the calling thread
+#ifndef ParallelInitThreshold
+#define ParallelInitThreshold (16 * 1024 * 1024)
+#endif 
+
+//Number of roots (persistent entry points) of a PersistentHeap
+#ifndef PersistentHeapRootsCount
+#define PersistentHeapRootsCount  64
+#endif 
+
+//Capacity of the deferred destruction queue (power of 2), see DeferredDestruction
+#ifndef DeferredQueueSize
+#define DeferredQueueSize		  4096
+#endif 
+
+//Number of memory tags (at most 256), see MemoryTags
+#ifndef MemoryTagsCount
+#define MemoryTagsCount			  64
+#endif 
+
+//Number of types tracked individually by FragmentationStats
+#ifndef FragmentationTypesCount
+#define FragmentationTypesCount	  256
+#endif 
+
+//Max number of slices in a MBufferChain (keep it under IOV_MAX)
+#ifndef BufferChainMaxSlices
+#define BufferChainMaxSlices	  16
+#endif 
+
+//Spans larger than this (power of 2) are not cached by the LargeObjectCache, they are mapped and unmapped on each use
+#ifndef LargeObjectCacheMaxSpanSize
+#define LargeObjectCacheMaxSpanSize (32 * 1024 * 1024)
+#endif 
+
+//Max number of cached spans of each LargeObjectCache size class
+#ifndef LargeObjectCacheSpansPerBucket
+#define LargeObjectCacheSpansPerBucket 16
+#endif 
+
+//Max bytes held by the LargeObjectCache, spans freed over it are unmapped (see LargeObjectCache::SetLimits)
+#ifndef LargeObjectCacheMaxBytes
+#define LargeObjectCacheMaxBytes  (256 * 1024 * 1024)
+#endif 
+
+//Max cached bytes kept committed by the LargeObjectCache, the oldest spans over it are returned to the OS (see LargeObjectCache::SetLimits)
+#ifndef LargeObjectCacheHotBytes
+#define LargeObjectCacheHotBytes  (64 * 1024 * 1024)
+#endif 
+
+//LargeObjectCache decommits with MADV_FREE (MEM_RESET) instead of MADV_DONTNEED (MEM_DECOMMIT), cheaper to reuse
+//while there is no memory pressure but the decommitted spans are not known to be zero
+#ifndef LargeObjectCacheLazyDecommit
+#define LargeObjectCacheLazyDecommit false
+#endif 
+
+//Number of events buffered per thread before they are copied into the trace file, see AllocationTrace
+#ifndef TraceBufferEventsCount
+#define TraceBufferEventsCount	  512
+#endif 
+
+//Default capacity (events) of a trace file, see AllocationTrace::Start
+#ifndef TraceDefaultMaxEvents
+#define TraceDefaultMaxEvents	  (16 * 1024 * 1024)
+#endif 
+
+//Mean number of allocated bytes between two samples of the HeapProfiler, see HeapProfiler::Start
+#ifndef HeapProfilerSamplingInterval
+#define HeapProfilerSamplingInterval (512 * 1024)
+#endif 
+
+//Max number of live (not yet freed) samples tracked by the HeapProfiler (power of 2)
+#ifndef HeapProfilerMaxSamples
+#define HeapProfilerMaxSamples	  65536
+#endif 
+
+//Max number of distinct call stacks recorded by the HeapProfiler (power of 2)
+#ifndef HeapProfilerMaxStacks
+#define HeapProfilerMaxStacks	  16384
+#endif 
+
+//Max number of frames captured per HeapProfiler sample
+#ifndef HeapProfilerMaxFrames
+#define HeapProfilerMaxFrames	  32
+#endif 
+
+//Number of cache line offsets (colors, power of 2) the pool blocks are rotated across, 1 disables the coloring (see TObjectPool)
+//Each block costs up to (PoolCacheColorsCount - 1) * MEMEX_CACHE_LINE_SIZE extra bytes of padding
+#ifndef PoolCacheColorsCount
+#define PoolCacheColorsCount	  4
+#endif 
+
+//Pool blocks smaller than this are not colored (many of them share a page at different offsets anyway)
+#ifndef PoolCacheColoringMinSize
+#define PoolCacheColoringMinSize  1024
+#endif 
+
+//Tier pools reuse blocks in FIFO order, set to true to reuse the most recently freed (cache hot) block first
+#ifndef PoolReuseLIFO
+#define PoolReuseLIFO			  false
+#endif 
+
+//Number of shards each tier pool is striped into (power of 2, must divide the tier block count)
+//Each thread uses the shard of the CPU it runs on, define MEMEX_SHARD_BY_THREAD to use a per thread shard instead
+#ifndef PoolShardsCount
+#define PoolShardsCount			  8
+#endif 
+
 }
\ No newline at end of file
@@ -1,8 +1,21 @@
 #include <iostream>
 #include <thread>
+#include <chrono>
+#include <coroutine>
+#include <cstring>
 
 #include <MemEx.h>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 //Global allocator implementation
 namespace MemEx {
 	ptr_t GAllocate(size_t BlockSize, size_t BlockAlignment) noexcept {
@@ -46,6 +59,14 @@ struct TypeB: IResource<TypeB> {
 	}
 };
 
+struct alignas(64) CacheLineType {
+	int a{ 1 };
+};
+
+struct alignas(256) OverAlignedType {
+	int a{ 2 };
+};
+
 bool TestUniquePtr() {
 	std::cout << "#TestUniquePtr():\n";
 	{
@@ -117,25 +138,2243 @@ bool TestBuffer() {
 	return true;
 }
 
-int main(int argc, const char** argv)
-{
-	if (MemoryManager::Initialize()) {
-		std::cout << "MemoryManager::Initialize() -> Failed";
-		std::cin.get();
-		return 1;
+bool TestAlignment() {
+	std::cout << "#TestAlignment():\n";
+
+	auto IsAligned = [](const void* Ptr, size_t Alignment) {
+		return (reinterpret_cast<size_t>(Ptr) & (Alignment - 1)) == 0;
+	};
+
+	auto CacheLineObj = MemoryManager::Alloc<CacheLineType>();
+	if (!IsAligned(CacheLineObj.Get(), 64) || CacheLineObj->a != 1) {
+		std::cout << "Alloc<CacheLineType> is not aligned to 64!\n";
+		return false;
 	}
 
-	if (!TestUniquePtr()) {
-		std::cin.get();
-		return 1;
+	auto OverAlignedObj = MemoryManager::Alloc<OverAlignedType>();
+	if (!IsAligned(OverAlignedObj.Get(), 256) || OverAlignedObj->a != 2) {
+		std::cout << "Alloc<OverAlignedType> is not aligned to 256!\n";
+		return false;
 	}
 
-	if (!TestSharedPtr(argc)) {
-		std::cin.get();
+	auto AlignedObj = MemoryManager::AllocAligned<TypeA, 128>(2.0);
+	if (!IsAligned(AlignedObj.Get(), 128) || AlignedObj->t != 2.0) {
+		std::cout << "AllocAligned<TypeA, 128> is not aligned to 128!\n";
+		return false;
+	}
+
+	auto Buffer = MemoryManager::AllocBuffer<float, false, 32>(100);
+	if (!IsAligned(Buffer.Get(), 32) || Buffer.GetCapacity() < sizeof(float) * 100) {
+		std::cout << "AllocBuffer<float, false, 32> is not aligned to 32!\n";
+		return false;
+	}
+
+	auto PageBuffer = MemoryManager::AllocBuffer<uint8_t, true, MEMEX_PAGE_SIZE>(64 * 1024);
+	if (!IsAligned(PageBuffer.Get(), MEMEX_PAGE_SIZE)) {
+		std::cout << "AllocBuffer<uint8_t, true, MEMEX_PAGE_SIZE> is not page aligned!\n";
+		return false;
+	}
+
+	//sizeof(T) * Count overflows or does not fit the ulong_t block sizes
+	if (MemoryManager::AllocBuffer<uint64_t, true>(SIZE_MAX / 4) || MemoryManager::AllocBuffer<uint8_t, true>(MemoryManager::MaxBlockSize + 1)) {
+		std::cout << "AllocBuffer accepted a count that does not fit a block!\n";
+		return false;
+	}
+
+	std::cout << "#TestAlignment():\n";
+
+	return true;
+}
+
+bool TestBulkOperations() {
+	std::cout << "#TestBulkOperations():\n";
+
+	{
+		//Dirty a block and return it to the pool
+		auto Dirty = MemoryManager::AllocBuffer<uint32_t, true>(100);
+		for (size_t i = 0; i < 100; i++) {
+			Dirty[i] = 0xDEADBEEF;
+		}
+	}
+
+	for (size_t Count : { size_t(3), size_t(100), size_t(NonTemporalStoreThreshold / sizeof(uint32_t)) + 7 }) {
+		auto Zeroed = MemoryManager::AllocBuffer<uint32_t>(Count);
+		for (size_t i = 0; i < Count; i++) {
+			if (Zeroed[i] != 0) {
+				std::cout << "AllocBuffer<uint32_t>(" << Count << ") did not zero the elements!\n";
+				return false;
+			}
+		}
+
+		auto Filled = MemoryManager::AllocBufferFilled<uint16_t>(Count, 0xABCD);
+		for (size_t i = 0; i < Count; i++) {
+			if (Filled[i] != 0xABCD) {
+				std::cout << "AllocBufferFilled<uint16_t>(" << Count << ") did not fill the elements!\n";
+				return false;
+			}
+		}
+	}
+
+	auto Objects = MemoryManager::AllocBufferFilled<TypeA>(4, TypeA(5.0));
+	for (size_t i = 0; i < 4; i++) {
+		if (Objects[i].t != 5.0) {
+			std::cout << "AllocBufferFilled<TypeA> did not copy construct the elements!\n";
+			return false;
+		}
+	}
+
+	std::cout << "#TestBulkOperations():\n";
+
+	return true;
+}
+
+struct TouchedElement {
+	uint64_t Value;
+
+	TouchedElement() : Value(1) {}
+	~TouchedElement() {
+		Value = 0;
+	}
+};
+
+bool TestParallelBuffer() {
+	std::cout << "#TestParallelBuffer():\n";
+
+	const size_t Count = (ParallelInitThreshold / sizeof(TouchedElement)) * 2 + 3;
+
+	auto Buffer = MemoryManager::AllocBufferParallel<TouchedElement>(Count, 4, true);
+	if (Buffer.IsNull() || (reinterpret_cast<size_t>(Buffer.Get()) & (MEMEX_PAGE_SIZE - 1)) != 0) {
+		std::cout << "AllocBufferParallel<TouchedElement> returned an unaligned buffer!\n";
+		return false;
+	}
+
+	for (size_t i = 0; i < Count; i++) {
+		if (Buffer[i].Value != 1) {
+			std::cout << "AllocBufferParallel<TouchedElement> did not construct element " << i << "!\n";
+			return false;
+		}
+	}
+
+	auto Zeroed = MemoryManager::AllocBufferParallel<uint32_t>(ParallelInitThreshold / sizeof(uint32_t) + 1, 3);
+	for (size_t i = 0; i < ParallelInitThreshold / sizeof(uint32_t) + 1; i++) {
+		if (Zeroed[i] != 0) {
+			std::cout << "AllocBufferParallel<uint32_t> did not zero element " << i << "!\n";
+			return false;
+		}
+	}
+
+	std::cout << "#TestParallelBuffer():\n";
+
+	return true;
+}
+
+struct PersistentNode {
+	uint64_t Value{ 0 };
+	TOffsetPtr<PersistentNode> Next{ };
+};
+
+bool TestPersistentHeap() {
+	std::cout << "#TestPersistentHeap():\n";
+
+	const char* HeapPath = "MemEx_Tests_PersistentHeap.bin";
+	const uint32_t TierBlocksCount[PersistentTiersCount] = { 256, 16, 16, 4 };
+
+	std::remove(HeapPath);
+
+	{
+		PersistentHeap Heap;
+		if (Heap.Open(HeapPath, TierBlocksCount) != EPersistentHeapStatus::Created) {
+			std::cout << "PersistentHeap::Open() failed to create the heap!\n";
+			return false;
+		}
+
+		//Build a list of 100 nodes, reachable from root 0
+		PersistentNode* Head = nullptr;
+		for (uint64_t i = 0; i < 100; i++) {
+			PersistentNode* Node = Heap.New<PersistentNode>();
+			if (!Node) {
+				std::cout << "PersistentHeap::New() failed!\n";
+				return false;
+			}
+
+			Node->Value = i;
+			Node->Next = Head;
+			Head = Node;
+		}
+
+		Heap.SetRoot(0, Head);
+
+		if (!Heap.Checkpoint()) {
+			std::cout << "PersistentHeap::Checkpoint() failed!\n";
+			return false;
+		}
+	}
+
+	{
+		PersistentHeap Heap;
+		if (Heap.Open(HeapPath, TierBlocksCount) != EPersistentHeapStatus::Attached) {
+			std::cout << "PersistentHeap::Open() failed to reattach the heap!\n";
+			return false;
+		}
+
+		uint64_t Expected = 100;
+		for (PersistentNode* Node = Heap.GetRoot<PersistentNode>(0); Node; Node = Node->Next.Get()) {
+			if (Node->Value != --Expected) {
+				std::cout << "PersistentHeap reattached with a corrupted list!\n";
+				return false;
+			}
+		}
+
+		if (Expected != 0 || Heap.GetLiveBlocksCount(0) != 100) {
+			std::cout << "PersistentHeap reattached with missing blocks!\n";
+			return false;
+		}
+
+		//Free half of the list and keep allocating from the reattached heap
+		PersistentNode* Node = Heap.GetRoot<PersistentNode>(0);
+		for (size_t i = 0; i < 50; i++) {
+			PersistentNode* Next = Node->Next.Get();
+			Heap.Delete(Node);
+			Node = Next;
+		}
+		Heap.SetRoot(0, Node);
+
+		if (Heap.GetLiveBlocksCount(0) != 50 || !Heap.New<PersistentNode>()) {
+			std::cout << "PersistentHeap failed to reuse the freed blocks!\n";
+			return false;
+		}
+	}
+
+	{
+		//Corrupt the layout, the heap must refuse to attach
+		FILE* File = fopen(HeapPath, "r+b");
+		const uint32_t BadVersion = PersistentHeap::HeapVersion + 1;
+		fseek(File, sizeof(uint64_t), SEEK_SET);
+		fwrite(&BadVersion, sizeof(BadVersion), 1, File);
+		fclose(File);
+
+		PersistentHeap Heap;
+		if (Heap.Open(HeapPath, TierBlocksCount) != EPersistentHeapStatus::ErrorIncompatible) {
+			std::cout << "PersistentHeap::Open() attached an incompatible heap!\n";
+			return false;
+		}
+	}
+
+	{
+		//A file that is not a heap (zero filled, eg. sparse) is refused and never modified or removed
+		std::remove(HeapPath);
+
+		FILE* File = fopen(HeapPath, "wb");
+		const uint8_t Zero[MEMEX_PAGE_SIZE]{ };
+		fwrite(Zero, sizeof(Zero), 1, File);
+		fclose(File);
+
+		PersistentHeap Heap;
+		if (Heap.Open(HeapPath, TierBlocksCount) != EPersistentHeapStatus::ErrorIncompatible) {
+			std::cout << "PersistentHeap::Open() accepted a file that is not a heap!\n";
+			return false;
+		}
+
+		uint8_t Content[MEMEX_PAGE_SIZE + 1]{ };
+		File = fopen(HeapPath, "rb");
+		const size_t ContentSize = File ? fread(Content, 1, sizeof(Content), File) : 0;
+		if (File) {
+			fclose(File);
+		}
+
+		if (ContentSize != sizeof(Zero) || memcmp(Content, Zero, sizeof(Zero)) != 0) {
+			std::cout << "PersistentHeap::Open() modified a file that is not a heap!\n";
+			return false;
+		}
+	}
+
+	{
+		//Concurrent creators, exactly one creates the heap and the other attaches to it
+		std::remove(HeapPath);
+
+		PersistentHeap Heaps[4];
+		EPersistentHeapStatus Statuses[4];
+		std::thread Threads[4];
+
+		for (size_t i = 0; i < 4; i++) {
+			Threads[i] = std::thread([&, i]() {
+				Statuses[i] = Heaps[i].Open(HeapPath, TierBlocksCount);
+			});
+		}
+
+		size_t CreatedCount = 0;
+		for (size_t i = 0; i < 4; i++) {
+			Threads[i].join();
+
+			CreatedCount += Statuses[i] == EPersistentHeapStatus::Created;
+			if (Statuses[i] != EPersistentHeapStatus::Created && Statuses[i] != EPersistentHeapStatus::Attached) {
+				CreatedCount = 0;
+				break;
+			}
+		}
+
+		PersistentNode* Node = CreatedCount == 1 ? Heaps[0].New<PersistentNode>() : nullptr;
+		if (Node) {
+			Node->Value = 77;
+			Heaps[0].SetRoot(1, Node);
+		}
+
+		if (!Node || Heaps[3].GetRoot<PersistentNode>(1)->Value != 77) {
+			std::cout << "PersistentHeap::Open() concurrent creation failed!\n";
+			return false;
+		}
+	}
+
+	std::remove(HeapPath);
+
+	std::cout << "#TestPersistentHeap():\n";
+
+	return true;
+}
+
+struct SharedMessage {
+	uint64_t Sequence{ 0 };
+	char Payload[200]{ };
+};
+
+const char* SharedHeapTestName = "/MemEx_Tests_SharedHeap";
+const uint32_t SharedHeapTestTierBlocksCount[PersistentTiersCount] = { 256, 16, 16, 4 };
+constexpr uint64_t SharedHeapTestMessagesCount = 100;
+
+//Producer process of the cross-process test: attach by name, produce the messages and hand over only their offsets
+//Returns the process exit code
+template<typename TSendOffset>
+int RunSharedHeapProducer(TSendOffset&& SendOffset) {
+	SharedHeap Heap;
+	if (Heap.Open(SharedHeapTestName, SharedHeapTestTierBlocksCount) != EPersistentHeapStatus::Attached) {
 		return 1;
 	}
 
-	if (!TestThread(argc)) {
+	int ExitCode = 0;
+
+	for (uint64_t i = 0; i < SharedHeapTestMessagesCount; i++) {
+		MSharedHeapPtr<SharedMessage> Message = Heap.NewShared<SharedMessage>();
+		if (!Message) {
+			ExitCode = 2;
+			break;
+		}
+
+		Message->Sequence = i;
+		snprintf(Message->Payload, sizeof(Message->Payload), "message %llu", static_cast<unsigned long long>(i));
+
+		if (!SendOffset(Message.Detach())) {
+			ExitCode = 3;
+			break;
+		}
+	}
+
+	Heap.Close();
+
+	return ExitCode;
+}
+
+//Consumer side of the cross-process test: adopt the message at [Offset], it must be the [Index]th message produced
+bool ReceiveSharedMessage(SharedHeap& Consumer, uint64_t Offset, uint64_t Index) {
+	MSharedHeapPtr<SharedMessage> Message = Consumer.Adopt<SharedMessage>(Offset);
+
+	char Expected[sizeof(SharedMessage::Payload)];
+	snprintf(Expected, sizeof(Expected), "message %llu", static_cast<unsigned long long>(Index));
+
+	return Message && Message->Sequence == Index && strcmp(Message->Payload, Expected) == 0;
+}
+
+#ifdef _WIN32
+//Runs this executable as the producer process of TestSharedHeap() (no fork on Windows)
+const char* SharedHeapChildSwitch = "--shared-heap-child";
+
+//[WritePipe] - value of the inherited pipe handle the offsets are written to
+int SharedHeapChildMain(const char* WritePipe) {
+	const HANDLE Pipe = reinterpret_cast<HANDLE>(static_cast<uintptr_t>(strtoull(WritePipe, nullptr, 10)));
+
+	const int ExitCode = RunSharedHeapProducer([Pipe](uint64_t Offset) -> bool {
+		DWORD Written = 0;
+		return WriteFile(Pipe, &Offset, sizeof(Offset), &Written, nullptr) && Written == sizeof(Offset);
+	});
+
+	CloseHandle(Pipe);
+
+	return ExitCode;
+}
+#endif
+
+bool TestSharedHeap() {
+	std::cout << "#TestSharedHeap():\n";
+
+	SharedHeap::Unlink(SharedHeapTestName);
+
+	SharedHeap Producer;
+	if (Producer.Open(SharedHeapTestName, SharedHeapTestTierBlocksCount) != EPersistentHeapStatus::Created) {
+		std::cout << "SharedHeap::Open() failed to create the heap!\n";
+		return false;
+	}
+
+	//Second mapping of the same segment, at another base address
+	SharedHeap Consumer;
+	if (Consumer.Open(SharedHeapTestName, SharedHeapTestTierBlocksCount) != EPersistentHeapStatus::Attached || Consumer.GetBase() == Producer.GetBase()) {
+		std::cout << "SharedHeap::Open() failed to attach the heap!\n";
+		return false;
+	}
+
+	{
+		MSharedHeapPtr<SharedMessage> Message = Producer.NewShared<SharedMessage>();
+		if (!Message) {
+			std::cout << "SharedHeap::NewShared() failed!\n";
+			return false;
+		}
+
+		Message->Sequence = 7;
+		strcpy(Message->Payload, "zero-copy");
+
+		//Only the offset crosses over
+		const uint64_t Offset = Message.Share();
+
+		MSharedHeapPtr<SharedMessage> Received = Consumer.Adopt<SharedMessage>(Offset);
+		if (!Received || Received.Get() == Message.Get() || Received->Sequence != 7 || strcmp(Received->Payload, "zero-copy") != 0 || Received.GetReferenceCount() != 2) {
+			std::cout << "SharedHeap::Adopt() failed!\n";
+			return false;
+		}
+
+		if (Consumer.Adopt<SharedMessage>(Offset + 1) || Consumer.Adopt<SharedMessage>(0)) {
+			std::cout << "SharedHeap::Adopt() accepted an invalid offset!\n";
+			return false;
+		}
+
+		//The last release (in the consumer) frees the block
+		Message.Reset();
+		if (Consumer.GetLiveBlocksCount(0) != 1) {
+			std::cout << "MSharedHeapPtr released the block early!\n";
+			return false;
+		}
+
+		Received.Reset();
+		if (Producer.GetLiveBlocksCount(0) != 0 || Consumer.Adopt<SharedMessage>(Offset)) {
+			std::cout << "MSharedHeapPtr failed to free the block!\n";
+			return false;
+		}
+	}
+
+#ifndef _WIN32
+	int Pipe[2];
+	if (pipe(Pipe) != 0) {
+		std::cout << "pipe() failed!\n";
+		return false;
+	}
+
+	const pid_t Child = fork();
+	if (Child == 0) {
+		//Child process
+		close(Pipe[0]);
+
+		const int ExitCode = RunSharedHeapProducer([&Pipe](uint64_t Offset) -> bool {
+			return write(Pipe[1], &Offset, sizeof(Offset)) == sizeof(Offset);
+		});
+
+		close(Pipe[1]);
+
+		_exit(ExitCode);
+	}
+
+	close(Pipe[1]);
+
+	if (Child < 0) {
+		close(Pipe[0]);
+		std::cout << "fork() failed!\n";
+		return false;
+	}
+
+	uint64_t ReceivedCount = 0;
+	uint64_t Offset = 0;
+	bool bCorrupted = false;
+
+	while (read(Pipe[0], &Offset, sizeof(Offset)) == sizeof(Offset)) {
+		if (!ReceiveSharedMessage(Consumer, Offset, ReceivedCount)) {
+			bCorrupted = true;
+		}
+
+		ReceivedCount++;
+	}
+
+	close(Pipe[0]);
+
+	int ChildStatus = 0;
+	waitpid(Child, &ChildStatus, 0);
+
+	const bool bChildSucceeded = WIFEXITED(ChildStatus) && WEXITSTATUS(ChildStatus) == 0;
+#else
+	//Run this executable again as the producer (see SharedHeapChildMain), only the write end of the pipe is inherited
+	SECURITY_ATTRIBUTES PipeAttributes{ sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+	HANDLE ReadPipe = nullptr;
+	HANDLE WritePipe = nullptr;
+	if (!CreatePipe(&ReadPipe, &WritePipe, &PipeAttributes, 0) || !SetHandleInformation(ReadPipe, HANDLE_FLAG_INHERIT, 0)) {
+		std::cout << "CreatePipe() failed!\n";
+		return false;
+	}
+
+	char ModulePath[MAX_PATH];
+	char CommandLine[MAX_PATH + 64];
+	STARTUPINFOA StartupInfo{ };
+	PROCESS_INFORMATION ChildInfo{ };
+
+	StartupInfo.cb = sizeof(StartupInfo);
+
+	const DWORD ModulePathLength = GetModuleFileNameA(nullptr, ModulePath, MAX_PATH);
+	snprintf(CommandLine, sizeof(CommandLine), "\"%s\" %s %llu", ModulePath, SharedHeapChildSwitch, static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(WritePipe)));
+
+	const bool bStarted = ModulePathLength && ModulePathLength < MAX_PATH &&
+		CreateProcessA(nullptr, CommandLine, nullptr, nullptr, TRUE, 0, nullptr, nullptr, &StartupInfo, &ChildInfo);
+
+	//The child holds its own write end, the reads below end when the child exits
+	CloseHandle(WritePipe);
+
+	if (!bStarted) {
+		CloseHandle(ReadPipe);
+		std::cout << "CreateProcessA() failed!\n";
+		return false;
+	}
+
+	uint64_t ReceivedCount = 0;
+	uint64_t Offset = 0;
+	bool bCorrupted = false;
+	DWORD BytesRead = 0;
+
+	while (ReadFile(ReadPipe, &Offset, sizeof(Offset), &BytesRead, nullptr) && BytesRead == sizeof(Offset)) {
+		if (!ReceiveSharedMessage(Consumer, Offset, ReceivedCount)) {
+			bCorrupted = true;
+		}
+
+		ReceivedCount++;
+	}
+
+	CloseHandle(ReadPipe);
+
+	DWORD ChildExitCode = 1;
+	WaitForSingleObject(ChildInfo.hProcess, INFINITE);
+	GetExitCodeProcess(ChildInfo.hProcess, &ChildExitCode);
+
+	CloseHandle(ChildInfo.hThread);
+	CloseHandle(ChildInfo.hProcess);
+
+	const bool bChildSucceeded = ChildExitCode == 0;
+#endif
+
+	if (!bChildSucceeded || ReceivedCount != SharedHeapTestMessagesCount || bCorrupted) {
+		std::cout << "SharedHeap cross-process hand over failed!\n";
+		return false;
+	}
+
+	//Allocated by the child, freed by this process
+	if (Producer.GetLiveBlocksCount(0) != 0) {
+		std::cout << "SharedHeap leaked blocks across processes!\n";
+		return false;
+	}
+
+	Consumer.Close();
+	Producer.Close();
+	SharedHeap::Unlink(SharedHeapTestName);
+
+	{
+		//The creator of the segment went away before formatting it (eg. crash), the next Open creates the heap again
+		const char* AbandonedName = "/MemEx_Tests_SharedHeap_Abandoned";
+		uint64_t TierOffset[PersistentTiersCount];
+
+		SharedHeap::Unlink(AbandonedName);
+
+		MappedRegion Abandoned;
+		bool bCreated = false;
+		if (!Abandoned.MapShared(AbandonedName, PersistentHeap::ComputeHeapSize(SharedHeapTestTierBlocksCount, TierOffset), bCreated) || !bCreated) {
+			std::cout << "MappedRegion::MapShared() failed!\n";
+			return false;
+		}
+
+		Abandoned.Unmap();
+
+		SharedHeap Heap;
+		if (Heap.Open(AbandonedName, SharedHeapTestTierBlocksCount) != EPersistentHeapStatus::Created || !Heap.NewShared<SharedMessage>()) {
+			std::cout << "SharedHeap::Open() failed to recreate an unformatted heap!\n";
+			return false;
+		}
+
+		Heap.Close();
+		SharedHeap::Unlink(AbandonedName);
+	}
+
+	std::cout << "#TestSharedHeap():\n";
+
+	return true;
+}
+
+bool TestHandlePool() {
+	std::cout << "#TestHandlePool():\n";
+
+	using EntityHandle = THandlePool<TypeA>::HandleType;
+	static_assert(sizeof(EntityHandle) == sizeof(uint32_t), "THandlePool<T> handles must be 32 bits");
+
+	THandlePool<uint64_t> Pool(1000);
+
+	EntityHandle Handles[1000];
+	for (uint64_t i = 0; i < 1000; i++) {
+		Handles[i] = Pool.Create(i);
+	}
+
+	if (Pool.Create(uint64_t(0)).IsNull() == false) {
+		std::cout << "THandlePool::Create() exceeded the capacity!\n";
+		return false;
+	}
+
+	//Destroy the odd ones
+	for (size_t i = 1; i < 1000; i += 2) {
+		if (!Pool.Destroy(Handles[i])) {
+			std::cout << "THandlePool::Destroy() failed!\n";
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < 1000; i++) {
+		const uint64_t* Value = Pool.Resolve(Handles[i]);
+		if ((i % 2 == 1) != (Value == nullptr) || (Value && *Value != i)) {
+			std::cout << "THandlePool::Resolve() returned a wrong object for handle " << i << "!\n";
+			return false;
+		}
+	}
+
+	//Reused slots must not resolve through the old handles
+	auto Reused = Pool.Create(uint64_t(5000));
+	if (Reused.GetIndex() != Handles[999].GetIndex() || Pool.Resolve(Handles[999]) || *Pool.Resolve(Reused) != 5000) {
+		std::cout << "THandlePool stale handle resolved!\n";
+		return false;
+	}
+
+	//The storage is dense
+	uint64_t Sum = 0;
+	for (uint64_t Value : Pool) {
+		Sum += Value;
+	}
+	if (Pool.GetSize() != 501 || Sum != (499 * 500) + 5000) {
+		std::cout << "THandlePool iteration is wrong!\n";
+		return false;
+	}
+
+	{
+		//4 generation bits, a slot is reused 15 times then retired, no stale handle may ever resolve again
+		using FSmallGenerationPool = THandlePool<uint64_t, uint32_t, 28>;
+		FSmallGenerationPool* SmallPool = new FSmallGenerationPool(1);
+
+		FSmallGenerationPool::HandleType Issued[40];
+		for (uint64_t i = 0; i < std::size(Issued); i++) {
+			Issued[i] = SmallPool->Create(i);
+			if (Issued[i].IsNull() || *SmallPool->Resolve(Issued[i]) != i || !SmallPool->Destroy(Issued[i])) {
+				std::cout << "THandlePool failed to reuse or replace a slot!\n";
+				return false;
+			}
+
+			for (uint64_t j = 0; j <= i; j++) {
+				if (SmallPool->IsValid(Issued[j])) {
+					std::cout << "THandlePool stale handle resolved after a generation wrap!\n";
+					return false;
+				}
+			}
+		}
+
+		if (Issued[0].GetIndex() != 0 || Issued[15].GetIndex() != 1 || Issued[30].GetIndex() != 2) {
+			std::cout << "THandlePool did not retire the wrapped slots!\n";
+			return false;
+		}
+
+		delete SmallPool;
+	}
+
+	std::cout << "#TestHandlePool():\n";
+
+	return true;
+}
+
+struct CountedType {
+	static inline std::atomic<int> LiveCount{ 0 };
+
+	CountedType() {
+		LiveCount++;
+	}
+	~CountedType() {
+		LiveCount--;
+	}
+};
+
+bool TestCompactPtr() {
+	std::cout << "#TestCompactPtr():\n";
+
+	static_assert(sizeof(MPtr<TypeA>) == sizeof(TypeA*), "MPtr<T> must be a single pointer");
+	static_assert(sizeof(MSharedPtr<TypeA>) == sizeof(TypeA*), "MSharedPtr<T> must be a single pointer");
+
+	{
+		auto Shared = MemoryManager::AllocShared<CountedType>();
+		{
+			MSharedPtr<CountedType> Copy = Shared;
+			MSharedPtr<CountedType> Copy2;
+			Copy2 = Copy;
+
+			if (Copy2.Get() != Shared.Get() || Copy2.GetMemoryBlock() != Shared.GetMemoryBlock()) {
+				std::cout << "MSharedPtr copy points to another block!\n";
+				return false;
+			}
+		}
+
+		if (CountedType::LiveCount != 1) {
+			std::cout << "MSharedPtr copies destroyed the shared object!\n";
+			return false;
+		}
+
+		MSharedPtr<CountedType> FromUnique = MemoryManager::Alloc<CountedType>();
+		if (CountedType::LiveCount != 2) {
+			std::cout << "MPtr to MSharedPtr conversion destroyed the object!\n";
+			return false;
+		}
+	}
+
+	if (CountedType::LiveCount != 0) {
+		std::cout << "MSharedPtr did not destroy the shared objects!\n";
+		return false;
+	}
+
+	//The block is recovered from the payload address for all kinds of blocks
+	auto Small = MemoryManager::Alloc<TypeA>();
+	auto OverAligned = MemoryManager::Alloc<OverAlignedType>();
+	auto Large = MemoryManager::AllocBuffer<uint8_t>(ExtraLargeMemBlockSize * 2);
+
+	if (Small.GetMemoryBlock()->GetBegin() != reinterpret_cast<uint8_t*>(Small.Get()) ||
+		OverAligned.GetMemoryBlock()->GetBegin() != reinterpret_cast<uint8_t*>(OverAligned.Get()) ||
+		Large.GetMemoryBlock()->GetBegin() != Large.Get() ||
+		Large.GetCapacity() != ExtraLargeMemBlockSize * 2) {
+		std::cout << "MPtr<T>::GetMemoryBlock() returned a wrong block!\n";
+		return false;
+	}
+
+	std::cout << "#TestCompactPtr():\n";
+
+	return true;
+}
+
+struct IntrusiveType : IResource<IntrusiveType, true> {
+	static inline int LiveCount{ 0 };
+
+	int Value{ 0 };
+
+	IntrusiveType() {
+		LiveCount++;
+	}
+	IntrusiveType(int Value) : Value(Value) {
+		LiveCount++;
+	}
+	~IntrusiveType() {
+		LiveCount--;
+	}
+};
+
+bool TestIntrusivePtr() {
+	std::cout << "#TestIntrusivePtr():\n";
+
+	static_assert(sizeof(MIntrusivePtr<IntrusiveType>) == sizeof(IntrusiveType*), "MIntrusivePtr<T> must be a single pointer");
+
+	{
+		MIntrusivePtr<IntrusiveType> Shared = IntrusiveType::NewShared(5);
+		if (Shared.IsNull() || Shared->Value != 5 || Shared->GetReferenceCount() != 1) {
+			std::cout << "IResource<T, true>::NewShared() failed!\n";
+			return false;
+		}
+
+		{
+			MIntrusivePtr<IntrusiveType> Copy = Shared;
+			MIntrusivePtr<IntrusiveType> FromThis = Shared->SharedFromThis();
+
+			if (FromThis.Get() != Shared.Get() || Shared->GetReferenceCount() != 3) {
+				std::cout << "MIntrusivePtr copies are not counted!\n";
+				return false;
+			}
+
+			MIntrusivePtr<IntrusiveType> Moved = std::move(Copy);
+			if (!Copy.IsNull() || Shared->GetReferenceCount() != 3) {
+				std::cout << "MIntrusivePtr move changed the reference count!\n";
+				return false;
+			}
+		}
+
+		if (IntrusiveType::LiveCount != 1 || Shared->GetReferenceCount() != 1) {
+			std::cout << "MIntrusivePtr copies destroyed the shared object!\n";
+			return false;
+		}
+	}
+
+	if (IntrusiveType::LiveCount != 0) {
+		std::cout << "MIntrusivePtr did not destroy the shared object!\n";
+		return false;
+	}
+
+	//Custom deleter, the object is owned by the MemoryManager but released through a registered deleter
+	static int DeleterCalls = 0;
+	const uint32_t DeleterIndex = IntrusiveDeleters::Register([](ptr_t Object) {
+		DeleterCalls++;
+		IMemoryBlock::DestroyPayload(Object);
+	});
+
+	{
+		MIntrusivePtr<IntrusiveType> Shared = IntrusiveType::NewShared();
+		Shared->SetDeleterIndex(DeleterIndex);
+	}
+
+	if (DeleterIndex == IntrusiveDeleters::InvalidIndex || DeleterIndex == 0 || DeleterCalls != 1 || IntrusiveType::LiveCount != 0) {
+		std::cout << "MIntrusivePtr did not use the registered deleter!\n";
+		return false;
+	}
+
+	//A full table is reported, the reserved index 0 is never handed out
+	uint32_t LastIndex = DeleterIndex;
+	for (uint32_t i = DeleterIndex + 1; i < IntrusiveDeleters::MaxDeleters; i++) {
+		LastIndex = IntrusiveDeleters::Register([](ptr_t Object) {});
+	}
+
+	if (LastIndex != IntrusiveDeleters::MaxDeleters - 1 || IntrusiveDeleters::Register([](ptr_t Object) {}) != IntrusiveDeleters::InvalidIndex) {
+		std::cout << "IntrusiveDeleters::Register() did not report the full table!\n";
+		return false;
+	}
+
+	std::cout << "#TestIntrusivePtr():\n";
+
+	return true;
+}
+
+//Minimal eagerly started coroutine, the frame is allocated from the MemEx pools
+struct PooledTask {
+	struct promise_type : MemExCoroutineAllocator {
+		PooledTask get_return_object() noexcept {
+			return PooledTask{ std::coroutine_handle<promise_type>::from_promise(*this) };
+		}
+
+		std::suspend_never initial_suspend() noexcept { return { }; }
+		std::suspend_always final_suspend() noexcept { return { }; }
+		void return_value(int InValue) noexcept { Value = InValue; }
+		void unhandled_exception() noexcept { }
+
+		int Value{ 0 };
+	};
+
+	explicit PooledTask(std::coroutine_handle<promise_type> Handle) noexcept : Handle(Handle) {}
+	~PooledTask() noexcept {
+		Handle.destroy();
+	}
+
+	PooledTask(const PooledTask&) = delete;
+	PooledTask& operator=(const PooledTask&) = delete;
+
+	std::coroutine_handle<promise_type> Handle;
+};
+
+PooledTask AddCoroutine(int A, int B) {
+	co_return A + B;
+}
+
+bool TestCoroutineAllocator() {
+	std::cout << "#TestCoroutineAllocator():\n";
+
+	//Raw tier storage round trip
+	ptr_t Raw = MemoryManager::AllocRaw(100);
+	ptr_t RawCustom = MemoryManager::AllocRaw(sizeof(MemoryManager::ExtraLargeBlock) + 1);
+	if (!Raw || !RawCustom || reinterpret_cast<size_t>(Raw) % MEMEX_CACHE_LINE_SIZE) {
+		std::cout << "MemoryManager::AllocRaw() failed!\n";
+		return false;
+	}
+
+	memset(Raw, 0xCD, 100);
+	MemoryManager::FreeRaw(Raw, 100);
+	MemoryManager::FreeRaw(RawCustom, sizeof(MemoryManager::ExtraLargeBlock) + 1);
+
+#ifdef MEMEX_STATISTICS
+	const size_t SmallAllocations = MemoryManager::SmallBlock::GetTotalAllocations();
+	const size_t SmallDeallocations = MemoryManager::SmallBlock::GetTotalDeallocations();
+#endif
+
+	for (int i = 0; i < 1000; i++) {
+		PooledTask Task = AddCoroutine(i, 1);
+		if (!Task.Handle.done() || Task.Handle.promise().Value != i + 1) {
+			std::cout << "Pool allocated coroutine did not complete!\n";
+			return false;
+		}
+	}
+
+#ifdef MEMEX_STATISTICS
+	//Small coroutine frames fit the small tier
+	if (MemoryManager::SmallBlock::GetTotalAllocations() - SmallAllocations != 1000 ||
+		MemoryManager::SmallBlock::GetTotalDeallocations() - SmallDeallocations != 1000) {
+		std::cout << "Coroutine frames were not allocated from the small tier!\n";
+		return false;
+	}
+#endif
+
+	std::cout << "#TestCoroutineAllocator():\n";
+
+	return true;
+}
+
+bool TestDeferredDestruction() {
+	std::cout << "#TestDeferredDestruction():\n";
+
+	const DeferredDestruction::Statistics Before = DeferredDestruction::GetStatistics();
+
+	{
+		auto Unique = MemoryManager::Alloc<CountedType>();
+		auto Shared = MemoryManager::AllocShared<CountedType>();
+
+		DeferredDestroyScope Scope;
+
+		Unique.Reset();
+		Shared.Reset();
+	}
+
+	if (CountedType::LiveCount != 2 || DeferredDestruction::GetStatistics().Depth != 2) {
+		std::cout << "Blocks released in deferred mode were destroyed inline!\n";
+		return false;
+	}
+
+	if (MemoryManager::DrainDeferred() != 2 || CountedType::LiveCount != 0) {
+		std::cout << "MemoryManager::DrainDeferred() did not destroy the queued blocks!\n";
+		return false;
+	}
+
+	//Backpressure, the block that does not fit is destroyed inline
+	DeferredDestruction::SetMaxDepth(2);
+	{
+		MPtr<CountedType> Objects[3];
+		for (auto& Obj : Objects) {
+			Obj = MemoryManager::Alloc<CountedType>();
+		}
+
+		DeferredDestroyScope Scope;
+		for (auto& Obj : Objects) {
+			Obj.Reset();
+		}
+	}
+	DeferredDestruction::SetMaxDepth(DeferredQueueSize);
+
+	const DeferredDestruction::Statistics AfterBackpressure = DeferredDestruction::GetStatistics();
+	if (CountedType::LiveCount != 2 || AfterBackpressure.TotalInlineDestroys - Before.TotalInlineDestroys != 1) {
+		std::cout << "Deferred destruction queue did not apply backpressure!\n";
+		return false;
+	}
+
+	MemoryManager::DrainDeferred();
+
+	//Reclaimer thread
+	if (!DeferredDestruction::StartReclaimer()) {
+		std::cout << "DeferredDestruction::StartReclaimer() failed!\n";
+		return false;
+	}
+
+	{
+		DeferredDestroyScope Scope;
+
+		for (size_t i = 0; i < 1000; i++) {
+			auto Shared = MemoryManager::AllocShared<CountedType>();
+		}
+	}
+
+	DeferredDestruction::StopReclaimer();
+
+	const DeferredDestruction::Statistics After = DeferredDestruction::GetStatistics();
+	if (CountedType::LiveCount != 0 || After.Depth != 0 || After.TotalDrained - Before.TotalDrained != After.TotalDeferred - Before.TotalDeferred) {
+		std::cout << "The reclaimer thread did not destroy the queued blocks!\n";
+		return false;
+	}
+
+	std::cout << "#TestDeferredDestruction():\n";
+
+	return true;
+}
+
+struct BoundedItem {
+	uint8_t Data[64]{ };
+};
+
+bool TestBoundedPool() {
+	std::cout << "#TestBoundedPool():\n";
+
+	using BoundedPool = TObjectPool<BoundedItem, 8, true, 2>;
+
+	if (!BoundedPool::Preallocate()) {
+		std::cout << "BoundedPool::Preallocate() failed!\n";
+		return false;
+	}
+
+	BoundedPool::SetExhaustionPolicy(EPoolExhaustionPolicy::FailFast);
+
+	BoundedItem* Items[8];
+	for (auto& Item : Items) {
+		Item = BoundedPool::NewRaw();
+	}
+
+	if (BoundedPool::NewRaw() != nullptr || BoundedPool::GetWaitStatistics().TotalFailures != 1) {
+		std::cout << "Bounded pool grew past its size!\n";
+		return false;
+	}
+
+	//All the blocks must be kept even if they are returned to a single shard
+	for (auto& Item : Items) {
+		BoundedPool::Deallocate(Item);
+	}
+	for (auto& Item : Items) {
+		Item = BoundedPool::NewRaw();
+		if (!Item) {
+			std::cout << "Bounded pool lost blocks on deallocation!\n";
+			return false;
+		}
+	}
+
+	//Timed wait
+	BoundedPool::SetExhaustionPolicy(EPoolExhaustionPolicy::Wait, 20);
+
+	const auto Start = std::chrono::steady_clock::now();
+	if (BoundedPool::NewRaw() != nullptr || std::chrono::steady_clock::now() - Start < std::chrono::milliseconds(20)) {
+		std::cout << "Bounded pool wait did not time out!\n";
+		return false;
+	}
+
+	//Wait until another thread returns a block
+	BoundedPool::SetExhaustionPolicy(EPoolExhaustionPolicy::Wait);
+
+	std::thread Releaser([&Items]() {
+		while (BoundedPool::GetWaitStatistics().Waiters == 0) {
+			std::this_thread::yield();
+		}
+
+		BoundedPool::Deallocate(Items[0]);
+	});
+
+	BoundedItem* Waited = BoundedPool::NewRaw();
+	Releaser.join();
+
+	const PoolWaitStatistics Stats = BoundedPool::GetWaitStatistics();
+	if (Waited != Items[0] || Stats.TotalWaits != 2 || Stats.TotalTimeouts != 1 || Stats.Waiters != 0 || Stats.MaxWaitTimeUs < 20000) {
+		std::cout << "Bounded pool wait statistics are wrong!\n";
+		return false;
+	}
+
+	Items[0] = Waited;
+	for (auto& Item : Items) {
+		BoundedPool::Deallocate(Item);
+	}
+
+	BoundedPool::SetExhaustionPolicy(EPoolExhaustionPolicy::Grow);
+
+	std::cout << "#TestBoundedPool():\n";
+
+	return true;
+}
+
+bool TestMemoryTags() {
+	std::cout << "#TestMemoryTags():\n";
+
+	constexpr MemoryTag NetworkTag = 5;
+	constexpr MemoryTag ExplicitTag = 6;
+	constexpr MemoryTag BudgetTag = 7;
+	constexpr size_t SmallBlockBytes = sizeof(MemoryManager::SmallBlock);
+
+	MemoryTags::SetName(NetworkTag, "Network");
+
+	{
+		MemoryTagScope Scope(NetworkTag);
+
+		auto Obj = MemoryManager::Alloc<TypeA>();
+		auto Explicit = MemoryManager::AllocTagged<TypeA>(ExplicitTag);
+
+		const MemoryTags::TagStatistics Stats = MemoryTags::GetStatistics(NetworkTag);
+		if (Stats.Bytes != SmallBlockBytes || Stats.BlocksCount != 1 || Obj.GetMemoryBlock()->GetBegin() == nullptr ||
+			MemoryTags::GetStatistics(ExplicitTag).BlocksCount != 1) {
+			std::cout << "Tagged allocations were not accounted!\n";
+			return false;
+		}
+
+		//Freed on another thread
+		std::thread([Obj = std::move(Obj)]() mutable {
+			Obj.Reset();
+		}).join();
+	}
+
+	if (MemoryTags::GetStatistics(NetworkTag).Bytes != 0 || MemoryTags::GetStatistics(ExplicitTag).Bytes != 0 ||
+		MemoryTags::GetThreadTag() != DefaultMemoryTag) {
+		std::cout << "Tagged deallocations were not accounted!\n";
+		return false;
+	}
+
+	//Budgets
+	static int SoftCalls = 0;
+	static int HardCalls = 0;
+
+	MemoryTags::SetBudget(BudgetTag, SmallBlockBytes * 2, SmallBlockBytes * 3,
+		[](MemoryTag Tag, size_t Bytes) { SoftCalls++; },
+		[](MemoryTag Tag, size_t Bytes) { HardCalls++; }
+	);
+
+	{
+		MemoryTagScope Scope(BudgetTag);
+
+		MPtr<TypeA> Objects[4];
+		for (auto& Obj : Objects) {
+			Obj = MemoryManager::Alloc<TypeA>();
+		}
+
+		if (Objects[2].IsNull() || !Objects[3].IsNull() || SoftCalls != 1 || HardCalls != 1 ||
+			MemoryTags::GetStatistics(BudgetTag).TotalRejected != 1) {
+			std::cout << "Memory tag budgets were not applied!\n";
+			return false;
+		}
+	}
+
+	MemoryTags::SetBudget(BudgetTag, 0, 0);
+
+	if (MemoryTags::GetStatistics(BudgetTag).Bytes != 0) {
+		std::cout << "Budgeted tag deallocations were not accounted!\n";
+		return false;
+	}
+
+	std::cout << "#TestMemoryTags():\n";
+
+	return true;
+}
+
+struct WastefulType {
+	uint8_t Data[SmallMemBlockSize + 8]{ };
+};
+
+bool TestFragmentationStats() {
+	std::cout << "#TestFragmentationStats():\n";
+
+#ifdef MEMEX_STATISTICS
+	FragmentationStats::SetTypeName<WastefulType>("WastefulType");
+
+	const FragmentationStats::TierStatistics Before = FragmentationStats::GetTierStatistics(MemoryManager::SmallBlock::TierIndex);
+
+	{
+		auto Obj = MemoryManager::Alloc<TypeA>();
+
+		const FragmentationStats::TierStatistics After = FragmentationStats::GetTierStatistics(MemoryManager::SmallBlock::TierIndex);
+		if (After.LiveBlocks - Before.LiveBlocks != 1 ||
+			After.BlockBytes - Before.BlockBytes != sizeof(MemoryManager::SmallBlock) ||
+			After.RequestedBytes - Before.RequestedBytes != sizeof(TypeA) ||
+			After.HeaderBytes - Before.HeaderBytes != BlockHeaderOffset) {
+			std::cout << "Small tier fragmentation was not accounted!\n";
+			return false;
+		}
+	}
+
+	const FragmentationStats::TierStatistics AfterFree = FragmentationStats::GetTierStatistics(MemoryManager::SmallBlock::TierIndex);
+	if (AfterFree.LiveBlocks != Before.LiveBlocks || AfterFree.BlockBytes != Before.BlockBytes) {
+		std::cout << "Small tier fragmentation was not released!\n";
+		return false;
+	}
+
+	//WastefulType wastes most of a MediumBlock
+	MPtr<WastefulType> Objects[64];
+	for (auto& Obj : Objects) {
+		Obj = MemoryManager::Alloc<WastefulType>();
+	}
+
+	FragmentationStats::TypeStatistics WorstOffenders[3];
+	const size_t Count = FragmentationStats::GetWorstOffenders(WorstOffenders, 3);
+	if (!Count || strcmp(WorstOffenders[0].Name, "WastefulType") != 0 || WorstOffenders[0].LiveBlocks != 64 ||
+		WorstOffenders[0].WastedBytes != 64 * (sizeof(MemoryManager::MediumBlock) - sizeof(WastefulType))) {
+		std::cout << "FragmentationStats::GetWorstOffenders() did not report the wasteful type!\n";
+		return false;
+	}
+
+	const FragmentationStats::TierStatistics Medium = FragmentationStats::GetTierStatistics(MemoryManager::MediumBlock::TierIndex);
+	if (Medium.GetFragmentationRatio() <= 0.4) {
+		std::cout << "Medium tier fragmentation ratio is wrong!\n";
+		return false;
+	}
+#endif
+
+	std::cout << "#TestFragmentationStats():\n";
+
+	return true;
+}
+
+struct WarmType {
+	static inline int Constructions{ 0 };
+	static inline int Destructions{ 0 };
+
+	MPtr<uint8_t> Buffer;
+	int Uses{ 0 };
+
+	WarmType() {
+		Constructions++;
+		Buffer = MemoryManager::AllocBuffer<uint8_t>(256);
+	}
+	~WarmType() {
+		Destructions++;
+	}
+
+	void Recycle() {
+		Uses = 0;
+	}
+};
+
+bool TestRecyclingPool() {
+	std::cout << "#TestRecyclingPool():\n";
+
+	using WarmPool = TRecyclingPool<WarmType, 2>;
+
+	WarmType* First = nullptr;
+	{
+		auto Obj = WarmPool::New();
+		Obj->Uses = 5;
+		First = Obj.Get();
+	}
+
+	{
+		auto Obj = WarmPool::New();
+		if (Obj.Get() != First || Obj->Uses != 0 || Obj->Buffer.IsNull() || WarmType::Constructions != 1 || WarmPool::GetTotalReused() != 1) {
+			std::cout << "TRecyclingPool did not reuse the warm object!\n";
+			return false;
+		}
+	}
+
+	//Shared owners recycle on the last release too
+	{
+		MSharedPtr<WarmType> Shared = WarmPool::New();
+		MSharedPtr<WarmType> Copy = Shared;
+	}
+
+	if (WarmPool::GetWarmCount() != 1 || WarmType::Destructions != 0) {
+		std::cout << "TRecyclingPool did not recycle the shared object!\n";
+		return false;
+	}
+
+	//Surplus beyond MaxWarm is destroyed
+	{
+		MPtr<WarmType> Objects[4];
+		for (auto& Obj : Objects) {
+			Obj = WarmPool::New();
+		}
+	}
+
+	if (WarmPool::GetWarmCount() != 2 || WarmType::Destructions != 2 || WarmPool::GetTotalSurplusDestroyed() != 2) {
+		std::cout << "TRecyclingPool did not destroy the surplus objects!\n";
+		return false;
+	}
+
+	WarmPool::Trim();
+
+	if (WarmPool::GetWarmCount() != 0 || WarmType::Destructions != WarmType::Constructions) {
+		std::cout << "TRecyclingPool::Trim() did not destroy the warm objects!\n";
+		return false;
+	}
+
+	std::cout << "#TestRecyclingPool():\n";
+
+	return true;
+}
+
+bool TestBufferChain() {
+	std::cout << "#TestBufferChain():\n";
+
+	MSharedPtr<uint8_t> Received = MemoryManager::AllocSharedBuffer<uint8_t>(64);
+	memcpy(Received.Get(), "HEADERpayload1payload2", 22);
+
+	MSlice Message(Received, 0, 22);
+	MSlice Payload1 = Message.SubSlice(6, 8);
+	MSlice Payload2 = Message.SubSlice(14);
+
+	if (Payload1.GetData() != Received.Get() + 6 || Payload1.GetSize() != 8 || Payload2.GetSize() != 8 ||
+		!Message.SubSlice(30).IsNull()) {
+		std::cout << "MSlice::SubSlice() returned a wrong range!\n";
+		return false;
+	}
+
+	//The slices keep the buffer alive
+	Received.Reset();
+	Message.Reset();
+
+	MBufferChain Chain;
+	Chain.Append(Payload2);
+	Chain.Append(Payload1);
+
+	MIOVec Vecs[BufferChainMaxSlices];
+	if (Chain.GetTotalSize() != 16 || Chain.FillIOVecs(Vecs, BufferChainMaxSlices) != 2 || memcmp(Vecs[0].Base, "payload2", 8) != 0) {
+		std::cout << "MBufferChain::FillIOVecs() failed!\n";
+		return false;
+	}
+
+#ifndef _WIN32
+	int Sockets[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets) != 0) {
+		std::cout << "socketpair() failed!\n";
+		return false;
+	}
+
+	//Gather write of the reordered payloads
+	const ssize_t Written = writev(Sockets[0], reinterpret_cast<iovec*>(Vecs), 2);
+
+	//Scatter read into two slices of a new buffer
+	MSharedPtr<uint8_t> ReceiveBuffer = MemoryManager::AllocSharedBuffer<uint8_t>(16);
+	MBufferChain ReceiveChain;
+	ReceiveChain.Append(MSlice(ReceiveBuffer, 0, 4));
+	ReceiveChain.Append(MSlice(ReceiveBuffer, 4, 12));
+
+	MIOVec ReceiveVecs[BufferChainMaxSlices];
+	const size_t ReceiveVecsCount = ReceiveChain.FillIOVecs(ReceiveVecs, BufferChainMaxSlices);
+
+	ssize_t Read = 0;
+	while (Read < 16) {
+		const ssize_t Result = readv(Sockets[1], reinterpret_cast<iovec*>(ReceiveVecs), static_cast<int>(ReceiveVecsCount));
+		if (Result <= 0) {
+			break;
+		}
+
+		Read += Result;
+		ReceiveChain.Consume(static_cast<size_t>(Result));
+		ReceiveChain.FillIOVecs(ReceiveVecs, BufferChainMaxSlices);
+	}
+
+	close(Sockets[0]);
+	close(Sockets[1]);
+
+	if (Written != 16 || Read != 16 || memcmp(ReceiveBuffer.Get(), "payload2payload1", 16) != 0) {
+		std::cout << "MBufferChain socket round trip failed!\n";
+		return false;
+	}
+#endif
+
+	//Partial writes
+	Chain.Consume(10);
+	if (Chain.GetSlicesCount() != 1 || Chain.GetTotalSize() != 6 || Chain.FillIOVecs(Vecs, BufferChainMaxSlices) != 1 ||
+		memcmp(Vecs[0].Base, "yload1", 6) != 0) {
+		std::cout << "MBufferChain::Consume() failed!\n";
+		return false;
+	}
+
+	std::cout << "#TestBufferChain():\n";
+
+	return true;
+}
+
+bool TestPoolReuseOrder() {
+	std::cout << "#TestPoolReuseOrder():\n";
+
+	using LIFOPool = TObjectPool<BoundedItem, 8, true, 1, true>;
+	using FIFOPool = TObjectPool<BoundedItem, 8, true, 1, false>;
+
+	if (!LIFOPool::Preallocate() || !FIFOPool::Preallocate()) {
+		std::cout << "Pool Preallocate() failed!\n";
+		return false;
+	}
+
+	BoundedItem* Hot = LIFOPool::NewRaw();
+	LIFOPool::Deallocate(Hot);
+	if (LIFOPool::NewRaw() != Hot) {
+		std::cout << "LIFO pool did not reuse the most recently freed block!\n";
+		return false;
+	}
+	LIFOPool::Deallocate(Hot);
+
+	Hot = FIFOPool::NewRaw();
+	FIFOPool::Deallocate(Hot);
+	BoundedItem* Next = FIFOPool::NewRaw();
+	if (Next == Hot) {
+		std::cout << "FIFO pool reused the most recently freed block!\n";
+		return false;
+	}
+	FIFOPool::Deallocate(Next);
+
+	std::cout << "#TestPoolReuseOrder():\n";
+
+	return true;
+}
+
+bool TestAllocationTrace() {
+	std::cout << "#TestAllocationTrace():\n";
+
+	const char* TracePath = "MemEx_Tests_AllocationTrace.bin";
+
+	if (!AllocationTrace::Start(TracePath, 1024)) {
+		std::cout << "AllocationTrace::Start() failed!\n";
+		return false;
+	}
+
+	{
+		auto Small = MemoryManager::Alloc<TypeA>();
+		auto Buffer = MemoryManager::AllocBuffer<uint8_t>(2000);
+		auto Huge = MemoryManager::AllocBuffer<uint8_t>(64 * 1024);
+
+		//Recorded into the buffer of another thread
+		std::thread([]() {
+			auto Other = MemoryManager::Alloc<TypeA>();
+		}).join();
+	}
+
+	AllocationTrace::Stop();
+
+	//Not recorded
+	auto AfterStop = MemoryManager::Alloc<TypeA>();
+	AfterStop.Reset();
+
+	FILE* File = fopen(TracePath, "rb");
+	if (!File) {
+		std::cout << "The trace file was not created!\n";
+		return false;
+	}
+
+	TraceFileHeader Header{ };
+	TraceEvent Events[16]{ };
+	const bool bHeaderRead = fread(&Header, sizeof(Header), 1, File) == 1;
+	const size_t EventsCount = fread(Events, sizeof(TraceEvent), 16, File);
+	fclose(File);
+	std::remove(TracePath);
+
+	if (!bHeaderRead || Header.Magic != AllocationTrace::TraceMagic || Header.EventsCount != 8 || Header.DroppedEventsCount != 0 || EventsCount < 8) {
+		std::cout << "The trace file header is invalid!\n";
+		return false;
+	}
+
+	size_t AllocsCount = 0;
+	size_t CustomTierCount = 0;
+	bool bOtherThread = false;
+
+	for (size_t i = 0; i < 8; i++) {
+		AllocsCount += Events[i].Type == ETraceEventType::Alloc;
+		CustomTierCount += Events[i].Tier == FragmentationStats::CustomTier;
+		bOtherThread |= Events[i].ThreadIndex != Events[0].ThreadIndex;
+
+		if (Events[i].Type == ETraceEventType::Alloc && Events[i].Size == 2000 && Events[i].Tier != MemoryManager::LargeBlock::TierIndex) {
+			std::cout << "The traced tier of the 2000 bytes buffer is wrong!\n";
+			return false;
+		}
+	}
+
+	if (AllocsCount != 4 || CustomTierCount != 2 || !bOtherThread) {
+		std::cout << "The traced events are wrong!\n";
+		return false;
+	}
+
+	std::cout << "#TestAllocationTrace():\n";
+
+	return true;
+}
+
+bool TestLargeObjectCache() {
+	std::cout << "#TestLargeObjectCache():\n";
+
+	size_t SpanSize = 0;
+	if (LargeObjectCache::GetBucketIndex(ExtraLargeMemBlockSize + 1, SpanSize) != 0 || SpanSize != LargeObjectCache::MinSpanSize
+		|| LargeObjectCache::GetBucketIndex((LargeObjectCache::MinSpanSize * 2) + 1, SpanSize) != 5 || SpanSize != LargeObjectCache::MinSpanSize * 5 / 2
+		|| SpanSize % MEMEX_PAGE_SIZE != 0) {
+		std::cout << "LargeObjectCache::GetBucketIndex() is wrong!\n";
+		return false;
+	}
+
+	const LargeObjectCache::Statistics Before = LargeObjectCache::GetStatistics();
+
+	uint8_t* FirstPayload = nullptr;
+	{
+		auto Buffer = MemoryManager::AllocBuffer<uint8_t, true>(100 * 1024);
+		if (Buffer.IsNull() || reinterpret_cast<size_t>(Buffer.GetMemoryBlock()) % MEMEX_CACHE_LINE_SIZE != 0) {
+			std::cout << "Failed to allocate a large buffer!\n";
+			return false;
+		}
+
+		memset(Buffer.Get(), 0xAB, 100 * 1024);
+		FirstPayload = Buffer.Get();
+	}
+
+	{
+		//Same size class, the most recently freed span is reused
+		auto Buffer = MemoryManager::AllocBuffer<uint8_t, true>(110 * 1024);
+		if (Buffer.Get() != FirstPayload) {
+			std::cout << "The large buffer span was not reused!\n";
+			return false;
+		}
+	}
+
+	const LargeObjectCache::Statistics AfterReuse = LargeObjectCache::GetStatistics();
+	if (AfterReuse.Hits - Before.Hits != 1 || AfterReuse.CachedBytes == 0) {
+		std::cout << "LargeObjectCache statistics are wrong!\n";
+		return false;
+	}
+
+	//No hot bytes, the freed span is returned to the OS but stays cached
+	LargeObjectCache::SetLimits(LargeObjectCacheMaxBytes, 0);
+	{
+		auto Buffer = MemoryManager::AllocBuffer<uint8_t>(200 * 1024);
+	}
+
+	const LargeObjectCache::Statistics AfterDecommit = LargeObjectCache::GetStatistics();
+	if (AfterDecommit.Decommits - Before.Decommits != 1) {
+		std::cout << "The cached span was not decommitted!\n";
+		return false;
+	}
+
+	{
+		//A decommitted span is reused (the content is undefined)
+		auto Buffer = MemoryManager::AllocBuffer<uint8_t>(200 * 1024);
+		if (Buffer.IsNull() || Buffer[0] != 0 || LargeObjectCache::GetStatistics().Hits - AfterDecommit.Hits != 1) {
+			std::cout << "The decommitted span was not reused!\n";
+			return false;
+		}
+	}
+
+	//No cache, the freed span is unmapped
+	LargeObjectCache::SetLimits(0, 0);
+	{
+		auto Buffer = MemoryManager::AllocBuffer<uint8_t>(300 * 1024);
+	}
+
+	if (LargeObjectCache::GetStatistics().Releases - AfterDecommit.Releases != 1) {
+		std::cout << "The span was not unmapped over the cache limit!\n";
+		return false;
+	}
+
+	LargeObjectCache::SetLimits(LargeObjectCacheMaxBytes, LargeObjectCacheHotBytes);
+	LargeObjectCache::Trim(true);
+
+	if (LargeObjectCache::GetStatistics().CachedBytes != 0 || LargeObjectCache::GetStatistics().HotBytes != 0) {
+		std::cout << "LargeObjectCache::Trim() did not release the cached spans!\n";
+		return false;
+	}
+
+	std::cout << "#TestLargeObjectCache():\n";
+
+	return true;
+}
+
+struct ZeroedType {
+	uint64_t	Values[4];
+	bool		bConstructed{ true };
+};
+
+//Check that [Count] bytes at [Ptr] are zero
+static bool IsZeroed(const uint8_t* Ptr, size_t Count) {
+	for (size_t i = 0; i < Count; i++) {
+		if (Ptr[i] != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool TestZeroedAlloc() {
+	std::cout << "#TestZeroedAlloc():\n";
+
+	//Recycled tier block
+	{
+		auto Dirty = MemoryManager::AllocBuffer<uint8_t, true>(300);
+		memset(Dirty.Get(), 0xFF, 300);
+	}
+	{
+		auto Zeroed = MemoryManager::AllocBufferZeroed<uint8_t>(300);
+		if (Zeroed.IsNull() || !IsZeroed(Zeroed.Get(), 300)) {
+			std::cout << "AllocBufferZeroed() did not clear the recycled block!\n";
+			return false;
+		}
+
+		memset(Zeroed.Get(), 0xFF, 300);
+	}
+	{
+		auto Object = MemoryManager::AllocZeroed<ZeroedType>();
+		if (Object.IsNull() || !Object->bConstructed || Object->Values[0] || Object->Values[3]) {
+			std::cout << "AllocZeroed() did not clear the storage or did not construct T!\n";
+			return false;
+		}
+	}
+
+	constexpr size_t LargeSize = 512 * 1024;
+
+	LargeObjectCache::Trim(true);
+
+	//Fresh span, known to be zero
+	const size_t SkippedBefore = LargeObjectCache::GetStatistics().ZeroFillsSkipped;
+	{
+		auto Large = MemoryManager::AllocBufferZeroed<uint8_t>(LargeSize);
+		if (Large.IsNull() || !IsZeroed(Large.Get(), LargeSize) || LargeObjectCache::GetStatistics().ZeroFillsSkipped != SkippedBefore + 1) {
+			std::cout << "AllocBufferZeroed() did not skip the fill of a fresh span!\n";
+			return false;
+		}
+
+		memset(Large.Get(), 0xFF, LargeSize);
+	}
+
+	//Recycled dirty span
+	{
+		auto Large = MemoryManager::AllocBufferZeroed<uint8_t>(LargeSize);
+		if (Large.IsNull() || !IsZeroed(Large.Get(), LargeSize) || LargeObjectCache::GetStatistics().ZeroFillsSkipped != SkippedBefore + 1) {
+			std::cout << "AllocBufferZeroed() did not clear the recycled span!\n";
+			return false;
+		}
+
+		memset(Large.Get(), 0xFF, LargeSize);
+	}
+
+	//Decommitted span (no hot bytes)
+	LargeObjectCache::SetLimits(LargeObjectCacheMaxBytes, 0);
+	{
+		auto Large = MemoryManager::AllocBuffer<uint8_t, true>(LargeSize);
+		memset(Large.Get(), 0xFF, LargeSize);
+	}
+	LargeObjectCache::SetLimits(LargeObjectCacheMaxBytes, LargeObjectCacheHotBytes);
+
+	{
+		auto Large = MemoryManager::AllocBufferZeroed<uint8_t>(LargeSize);
+		if (Large.IsNull() || !IsZeroed(Large.Get(), LargeSize)) {
+			std::cout << "AllocBufferZeroed() returned a dirty decommitted span!\n";
+			return false;
+		}
+
+		if (!LargeObjectCacheLazyDecommit && LargeObjectCache::GetStatistics().ZeroFillsSkipped != SkippedBefore + 2) {
+			std::cout << "AllocBufferZeroed() did not skip the fill of a decommitted span!\n";
+			return false;
+		}
+	}
+
+	LargeObjectCache::Trim(true);
+
+	std::cout << "#TestZeroedAlloc():\n";
+
+	return true;
+}
+
+bool TestHeap() {
+	std::cout << "#TestHeap():\n";
+
+	//Each heap holds its own tier pools, allocate the heaps dynamically
+	MHeap* HeapA = new MHeap();
+	MHeap* HeapB = new MHeap();
+
+	{
+		MPtr<CountedType> A = HeapA->Alloc<CountedType>();
+		MSharedPtr<CountedType> B = HeapB->AllocShared<CountedType>();
+		MPtr<uint64_t> Buffer = HeapA->AllocBuffer<uint64_t>(1000);
+		MPtr<uint8_t> OSBuffer = HeapB->AllocBuffer<uint8_t>(ExtraLargeMemBlockSize * 2);
+		MPtr<CountedType> Global = MemoryManager::Alloc<CountedType>();
+
+		if (A.IsNull() || B.IsNull() || Buffer.IsNull() || OSBuffer.IsNull() || CountedType::LiveCount != 3) {
+			std::cout << "MHeap allocation failed!\n";
+			return false;
+		}
+
+		if (MHeap::GetOwner(A.Get()) != HeapA || MHeap::GetOwner(Buffer.Get()) != HeapA ||
+			MHeap::GetOwner(B.Get()) != HeapB || MHeap::GetOwner(OSBuffer.Get()) != HeapB ||
+			MHeap::GetOwner(Global.Get()) != nullptr) {
+			std::cout << "MHeap block header does not record the owning heap!\n";
+			return false;
+		}
+
+		if (Buffer.Get()[999] != 0 || HeapA->GetStatistics().LiveBlocks != 2 || HeapB->GetStatistics().LiveBlocks != 2 ||
+			HeapB->GetStatistics().LiveBytes <= ExtraLargeMemBlockSize * 2) {
+			std::cout << "MHeap statistics are wrong!\n";
+			return false;
+		}
+	}
+
+	if (CountedType::LiveCount != 0 || HeapA->GetStatistics().LiveBlocks != 0 || HeapA->GetStatistics().LiveBytes != 0 ||
+		HeapB->GetStatistics().LiveBlocks != 0 || HeapB->GetStatistics().LiveBytes != 0) {
+		std::cout << "MHeap blocks were not returned to their heap!\n";
+		return false;
+	}
+
+	//sizeof(T) * Count overflows
+	if (HeapA->AllocBuffer<uint64_t, true>(SIZE_MAX / 4).IsNull() == false || HeapA->GetStatistics().LiveBytes != 0) {
+		std::cout << "MHeap allocated a buffer that does not fit a block!\n";
+		return false;
+	}
+
+	//Heap blocks are tagged and accounted like the MemoryManager blocks
+	{
+		constexpr MemoryTag HeapTag = 8;
+
+		MemoryTagScope Scope(HeapTag);
+
+		MPtr<CountedType> Tagged = HeapA->Alloc<CountedType>();
+		MPtr<uint8_t> TaggedOSBuffer = HeapA->AllocBuffer<uint8_t>(ExtraLargeMemBlockSize * 2);
+
+		const MemoryTags::TagStatistics Stats = MemoryTags::GetStatistics(HeapTag);
+		if (Tagged.IsNull() || TaggedOSBuffer.IsNull() || Stats.BlocksCount != 2 || Stats.Bytes != HeapA->GetStatistics().LiveBytes) {
+			std::cout << "MHeap allocations were not tagged!\n";
+			return false;
+		}
+	}
+
+	if (MemoryTags::GetStatistics(8).BlocksCount != 0 || MemoryTags::GetStatistics(8).Bytes != 0) {
+		std::cout << "MHeap tagged allocations were not released!\n";
+		return false;
+	}
+
+	//Limits are per heap
+	HeapA->SetLimit(sizeof(MemoryManager::SmallBlock) * 2);
+	{
+		MPtr<uint64_t> First = HeapA->Alloc<uint64_t>();
+		MPtr<uint64_t> Second = HeapA->Alloc<uint64_t>();
+		MPtr<uint64_t> Third = HeapA->Alloc<uint64_t>();
+		MPtr<uint64_t> Other = HeapB->Alloc<uint64_t>();
+
+		if (First.IsNull() || Second.IsNull() || !Third.IsNull() || Other.IsNull() || HeapA->GetStatistics().TotalRejected != 1) {
+			std::cout << "MHeap::SetLimit() failed!\n";
+			return false;
+		}
+	}
+	HeapA->SetLimit(SIZE_MAX);
+
+	//Fail fast tiers of a preallocated heap, the MemoryManager pools are not used
+	if (HeapB->Preallocate() != 0 || !HeapB->SetExhaustionPolicy(EPoolExhaustionPolicy::FailFast)) {
+		std::cout << "MHeap::Preallocate() failed!\n";
+		return false;
+	}
+	{
+		MPtr<MPtr<uint64_t>> Blocks = MemoryManager::AllocBuffer<MPtr<uint64_t>>(SmallMemBlockCount);
+		for (size_t i = 0; i < SmallMemBlockCount; i++) {
+			Blocks.Get()[i] = HeapB->Alloc<uint64_t>();
+		}
+
+		if (Blocks.Get()[SmallMemBlockCount - 1].IsNull() || !HeapB->Alloc<uint64_t>().IsNull()) {
+			std::cout << "MHeap tier exhaustion policy failed!\n";
+			return false;
+		}
+	}
+	HeapB->SetExhaustionPolicy(EPoolExhaustionPolicy::Grow);
+
+	//One heap per thread
+	std::thread Workers[2];
+	std::atomic<bool> bFailed{ false };
+	for (size_t i = 0; i < 2; i++) {
+		MHeap* Heap = i == 0 ? HeapA : HeapB;
+
+		Workers[i] = std::thread([&bFailed, Heap]() {
+			for (uint64_t Iteration = 0; Iteration < 10000; Iteration++) {
+				MPtr<uint64_t> Value = Heap->Alloc<uint64_t>(Iteration);
+				if (Value.IsNull() || *Value.Get() != Iteration || MHeap::GetOwner(Value.Get()) != Heap) {
+					bFailed = true;
+				}
+			}
+		});
+	}
+	for (std::thread& Worker : Workers) {
+		Worker.join();
+	}
+
+	if (bFailed || HeapA->GetStatistics().LiveBlocks != 0 || HeapB->GetStatistics().LiveBlocks != 0) {
+		std::cout << "MHeap per thread heaps failed!\n";
+		return false;
+	}
+
+	//Tear down all the memory of the heaps
+	delete HeapA;
+	delete HeapB;
+
+	std::cout << "#TestHeap():\n";
+
+	return true;
+}
+
+bool TestHeapProfiler() {
+	std::cout << "#TestHeapProfiler():\n";
+
+	const char* ProfilePath = "MemEx_Tests_HeapProfile.txt";
+	const char* FoldedPath = "MemEx_Tests_HeapProfile.folded";
+
+	//Mean interval of 1 byte, every allocation below is sampled
+	if (!HeapProfiler::Start(1)) {
+		std::cout << "HeapProfiler::Start() failed!\n";
+		return false;
+	}
+
+	//The counter of this thread was set while the profiler was stopped, this allocation consumes it
+	MemoryManager::AllocBuffer<uint8_t>(HeapProfilerSamplingInterval + 1).Reset();
+
+	const HeapProfiler::Statistics Baseline = HeapProfiler::GetStatistics();
+
+	{
+		MPtr<uint8_t> Buffers[8];
+		for (size_t i = 0; i < 8; i++) {
+			Buffers[i] = MemoryManager::AllocBuffer<uint8_t>(256);
+		}
+
+		auto Huge = MemoryManager::AllocBuffer<uint8_t>(64 * 1024);
+
+		HeapProfiler::Statistics Stats = HeapProfiler::GetStatistics();
+		if (Stats.SampledAllocations != Baseline.SampledAllocations + 9 || Stats.LiveSamples != 9 || Stats.StacksCount == 0) {
+			std::cout << "HeapProfiler did not sample the allocations!\n";
+			return false;
+		}
+
+		for (size_t i = 0; i < 4; i++) {
+			Buffers[i].Reset();
+		}
+		Huge.Reset();
+
+		Stats = HeapProfiler::GetStatistics();
+		if (Stats.LiveSamples != 4) {
+			std::cout << "HeapProfiler did not remove the freed samples!\n";
+			return false;
+		}
+
+		if (!HeapProfiler::WriteProfile(ProfilePath) || !HeapProfiler::WriteFoldedStacks(FoldedPath, false)) {
+			std::cout << "HeapProfiler failed to write the profiles!\n";
+			return false;
+		}
+	}
+
+	HeapProfiler::Stop();
+
+	//Not sampled
+	auto AfterStop = MemoryManager::AllocBuffer<uint8_t>(256);
+	AfterStop.Reset();
+
+	const HeapProfiler::Statistics Stats = HeapProfiler::GetStatistics();
+	if (Stats.SampledAllocations != Baseline.SampledAllocations + 9 || Stats.LiveSamples != 0) {
+		std::cout << "HeapProfiler sampled after Stop()!\n";
+		return false;
+	}
+
+	char Line[256]{ };
+	FILE* File = fopen(ProfilePath, "r");
+	const bool bHeaderRead = File && fgets(Line, sizeof(Line), File) != nullptr;
+	if (File) {
+		fclose(File);
+	}
+
+	if (!bHeaderRead || strncmp(Line, "heap profile: ", 14) != 0 || !strstr(Line, "@ heap_v2/1")) {
+		std::cout << "The heap profile header is invalid!\n";
+		return false;
+	}
+
+	File = fopen(FoldedPath, "r");
+	const bool bFoldedRead = File && fgets(Line, sizeof(Line), File) != nullptr;
+	if (File) {
+		fclose(File);
+	}
+
+	std::remove(ProfilePath);
+	std::remove(FoldedPath);
+
+	if (!bFoldedRead) {
+		std::cout << "The folded stacks are empty!\n";
+		return false;
+	}
+
+	std::cout << "#TestHeapProfiler():\n";
+
+	return true;
+}
+
+struct CowConfig {
+	static inline std::atomic<int> CopiesCount{ 0 };
+
+	int Version{ 0 };
+	int Values[16]{ };
+
+	CowConfig() = default;
+	CowConfig(const CowConfig& Other) : Version(Other.Version) {
+		memcpy(Values, Other.Values, sizeof(Values));
+		CopiesCount++;
+	}
+};
+
+bool TestCowPtr() {
+	std::cout << "#TestCowPtr():\n";
+
+	{
+		MCowPtr<CowConfig> Config = MemoryManager::AllocShared<CowConfig>();
+
+		//Unique, mutated in place
+		const CowConfig* Original = Config.Read();
+		if (!Config.IsUnique() || Config.Write() != Original || CowConfig::CopiesCount != 0) {
+			std::cout << "MCowPtr copied a unique block!\n";
+			return false;
+		}
+		Config.Write()->Version = 1;
+
+		MCowPtr<CowConfig> Snapshot = Config;
+		if (Config.IsUnique() || Snapshot.Read() != Original) {
+			std::cout << "MCowPtr copies must share the block!\n";
+			return false;
+		}
+
+		//Shared, cloned on write
+		CowConfig* Written = Config.Write();
+		Written->Version = 2;
+		if (Written == Original || CowConfig::CopiesCount != 1 || Snapshot->Version != 1 || Config->Version != 2
+			|| !Config.IsUnique() || !Snapshot.IsUnique()) {
+			std::cout << "MCowPtr did not clone the shared block!\n";
+			return false;
+		}
+	}
+
+	{
+		MCowPtr<uint32_t> Table = MemoryManager::AllocSharedBuffer<uint32_t>(1000);
+		uint32_t* Entries = Table.Write();
+		for (uint32_t i = 0; i < 1000; i++) {
+			Entries[i] = i;
+		}
+
+		MCowPtr<uint32_t> Reader = Table;
+		Table.Write()[10] = 12345;
+
+		if (Table.GetCount() != 1000 || Reader.GetCount() != 1000 || Reader[10] != 10 || Table[10] != 12345 || Table[999] != 999) {
+			std::cout << "MCowPtr did not clone the shared buffer!\n";
+			return false;
+		}
+	}
+
+	{
+		MHeap* Heap = new MHeap();
+		{
+			MCowPtr<CowConfig> Config = Heap->AllocSharedBuffer<CowConfig>(4);
+			MCowPtr<CowConfig> Snapshot = Config;
+
+			//The clone is allocated from the heap of the block
+			CowConfig* Written = Config.Write();
+			if (!Written || MHeap::GetOwner(Written) != Heap || Heap->GetStatistics().LiveBlocks != 2 || CowConfig::CopiesCount != 5) {
+				std::cout << "MCowPtr did not clone into the heap of the block!\n";
+				return false;
+			}
+		}
+		delete Heap;
+	}
+
+	std::cout << "#TestCowPtr():\n";
+
+	return true;
+}
+
+struct QueueMessage : IResource<QueueMessage>, MQueueNode {
+	static inline std::atomic<int> LiveCount{ 0 };
+
+	uint32_t Producer{ 0 };
+	uint32_t Sequence{ 0 };
+
+	QueueMessage() {
+		LiveCount++;
+	}
+	QueueMessage(uint32_t Producer, uint32_t Sequence) : Producer(Producer), Sequence(Sequence) {
+		LiveCount++;
+	}
+	~QueueMessage() {
+		LiveCount--;
+	}
+};
+
+bool TestQueues() {
+	std::cout << "#TestQueues():\n";
+
+	constexpr uint32_t ProducersCount = 4;
+	constexpr uint32_t MessagesCount = 20000;
+
+	{
+		TMPSCQueue<QueueMessage>* Queue = new TMPSCQueue<QueueMessage>();
+
+		std::thread Producers[ProducersCount];
+		for (uint32_t Producer = 0; Producer < ProducersCount; Producer++) {
+			Producers[Producer] = std::thread([Queue, Producer]() {
+				for (uint32_t i = 0; i < MessagesCount; i++) {
+					Queue->Push(QueueMessage::New(Producer, i));
+				}
+			});
+		}
+
+		//Messages of each producer are received in push order
+		uint32_t NextSequence[ProducersCount]{ };
+		uint32_t Received = 0;
+		bool bOrdered = true;
+
+		while (Received < ProducersCount * MessagesCount) {
+			MPtr<QueueMessage> Message = Queue->Pop();
+			if (Message.IsNull()) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			bOrdered &= Message->Sequence == NextSequence[Message->Producer]++;
+			Received++;
+		}
+
+		for (auto& Producer : Producers) {
+			Producer.join();
+		}
+
+		if (!bOrdered || !Queue->IsEmpty() || Queue->Pop()) {
+			std::cout << "TMPSCQueue lost or reordered messages!\n";
+			return false;
+		}
+
+		//The queued messages are destroyed with the queue
+		Queue->Push(QueueMessage::New());
+		Queue->Push(QueueMessage::New());
+		delete Queue;
+
+		if (QueueMessage::LiveCount != 0) {
+			std::cout << "TMPSCQueue leaked messages!\n";
+			return false;
+		}
+	}
+
+	{
+		using FQueue = TMPMCQueue<QueueMessage, 1024>;
+		FQueue* Queue = new FQueue();
+
+		std::atomic<uint64_t> SequenceSum{ 0 };
+		std::atomic<uint32_t> ReceivedCount{ 0 };
+
+		std::thread Threads[ProducersCount * 2];
+		for (uint32_t Producer = 0; Producer < ProducersCount; Producer++) {
+			Threads[Producer] = std::thread([Queue, Producer]() {
+				for (uint32_t i = 0; i < MessagesCount; i++) {
+					MPtr<QueueMessage> Message = QueueMessage::New(Producer, i);
+					while (!Queue->TryPush(std::move(Message))) {
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		for (uint32_t Consumer = 0; Consumer < ProducersCount; Consumer++) {
+			Threads[ProducersCount + Consumer] = std::thread([Queue, &SequenceSum, &ReceivedCount]() {
+				while (ReceivedCount.load(std::memory_order_relaxed) < ProducersCount * MessagesCount) {
+					MPtr<QueueMessage> Message = Queue->TryPop();
+					if (Message.IsNull()) {
+						std::this_thread::yield();
+						continue;
+					}
+
+					SequenceSum.fetch_add(Message->Sequence, std::memory_order_relaxed);
+					ReceivedCount.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+		}
+
+		for (auto& Thread : Threads) {
+			Thread.join();
+		}
+
+		const uint64_t ExpectedSum = static_cast<uint64_t>(ProducersCount) * (static_cast<uint64_t>(MessagesCount) * (MessagesCount - 1) / 2);
+		if (SequenceSum != ExpectedSum || Queue->GetCount() != 0 || Queue->TryPop()) {
+			std::cout << "TMPMCQueue lost messages!\n";
+			return false;
+		}
+
+		//Full, the rejected node stays with the caller
+		for (size_t i = 0; i < FQueue::GetCapacity(); i++) {
+			if (!Queue->TryPush(QueueMessage::New())) {
+				std::cout << "TMPMCQueue rejected a node before it was full!\n";
+				return false;
+			}
+		}
+
+		MPtr<QueueMessage> Rejected = QueueMessage::New();
+		if (Queue->TryPush(std::move(Rejected)) || Rejected.IsNull()) {
+			std::cout << "TMPMCQueue accepted a node while full!\n";
+			return false;
+		}
+
+		Rejected.Reset();
+		delete Queue;
+
+		if (QueueMessage::LiveCount != 0) {
+			std::cout << "TMPMCQueue leaked messages!\n";
+			return false;
+		}
+	}
+
+	std::cout << "#TestQueues():\n";
+
+	return true;
+}
+
+bool TestCacheColoring() {
+	std::cout << "#TestCacheColoring():\n";
+
+	using FPoolTraits = MemoryManager::LargeBlock::PoolTraits;
+	static_assert(FPoolTraits::MyColorsCount == PoolCacheColorsCount, "LargeBlock must be colored");
+	static_assert(MemoryManager::SmallBlock::PoolTraits::MyColorsCount == 1, "SmallBlock must not be colored");
+
+	//Consecutive OS blocks of a shard are placed at consecutive colors
+	using FPool = TObjectPoolInstance<MemoryManager::LargeBlock, 16, true, 1>;
+	FPool* Pool = new FPool();
+
+	ptr_t Blocks[PoolCacheColorsCount * 2];
+	bool bColored = true;
+	for (size_t i = 0; i < std::size(Blocks); i++) {
+		Blocks[i] = Pool->AllocateRaw();
+
+		const size_t Color = (reinterpret_cast<size_t>(Blocks[i]) / MEMEX_CACHE_LINE_SIZE) & (PoolCacheColorsCount - 1);
+		bColored &= Blocks[i] && Color == (i & (PoolCacheColorsCount - 1));
+	}
+
+	//The MemoryManager blocks keep the header right before the payload
+	auto Buffer = MemoryManager::AllocBuffer<uint8_t>(LargeMemBlockSize);
+	bColored &= GetBlockFromPayload(Buffer.Get())->Block == Buffer.Get();
+	Buffer.Reset();
+
+	for (ptr_t Block : Blocks) {
+		Pool->DeallocateRaw(Block);
+	}
+	Pool->Release();
+	delete Pool;
+
+	if (!bColored) {
+		std::cout << "The pool blocks are not colored!\n";
+		return false;
+	}
+
+	std::cout << "#TestCacheColoring():\n";
+
+	return true;
+}
+
+int main(int argc, const char** argv)
+{
+	if (MemoryManager::Initialize()) {
+		std::cout << "MemoryManager::Initialize() -> Failed";
+		std::cin.get();
+		return 1;
+	}
+
+#ifdef _WIN32
+	//Producer process of TestSharedHeap()
+	if (argc == 3 && strcmp(argv[1], SharedHeapChildSwitch) == 0) {
+		return SharedHeapChildMain(argv[2]);
+	}
+#endif
+
+	if (!TestUniquePtr()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestSharedPtr(argc)) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestThread(argc)) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestAlignment()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestBulkOperations()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestParallelBuffer()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestPersistentHeap()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestSharedHeap()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestHandlePool()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestCompactPtr()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestIntrusivePtr()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestCoroutineAllocator()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestDeferredDestruction()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestBoundedPool()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestMemoryTags()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestFragmentationStats()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestRecyclingPool()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestBufferChain()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestPoolReuseOrder()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestAllocationTrace()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestLargeObjectCache()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestZeroedAlloc()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestHeap()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestHeapProfiler()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestCowPtr()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestQueues()) {
+		std::cin.get();
+		return 1;
+	}
+
+	if (!TestCacheColoring()) {
 		std::cin.get();
 		return 1;
 	}
@@ -0,0 +1,314 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#include <MemEx.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+//Global allocator implementation
+namespace MemEx {
+	ptr_t GAllocate(size_t BlockSize, size_t BlockAlignment) noexcept {
+		return _aligned_malloc(BlockSize, BlockAlignment);
+	}
+
+	void GFree(ptr_t BlockPtr) noexcept {
+		_aligned_free(BlockPtr);
+	}
+}
+
+using namespace MemEx;
+
+/*------------------------------------------------------------
+	Replays an allocation trace recorded with AllocationTrace against an allocator backend
+		MemEx_TraceReplay <TraceFile> [memex|system|os] [--no-preallocate]
+	The events of all the threads are replayed in timestamp order on one thread.
+	The tier sizes and capacities are the ones MemEx was built with (see Tunning.h), build the tool with
+	other values (e.g. /DSmallMemBlockCount=16384) to evaluate them. Peak RSS is per process, run one backend per process.
+  ------------------------------------------------------------*/
+
+enum class EReplayBackend {
+	MemEx,		//MemoryManager::AllocBuffer (tier blocks and OS blocks)
+	System,		//malloc/free
+	OS			//GAllocate/GFree
+};
+
+//Event of the trace with the block id resolved to a dense slot index
+struct ReplayOp {
+	uint32_t	Slot;
+	uint32_t	Size;
+	bool		bAlloc;
+};
+
+static bool LoadTrace(const char* Path, std::vector<TraceEvent>& OutEvents, TraceFileHeader& OutHeader) {
+	FILE* File = fopen(Path, "rb");
+	if (!File) {
+		std::cout << "Failed to open " << Path << "\n";
+		return false;
+	}
+
+	if (fread(&OutHeader, sizeof(OutHeader), 1, File) != 1
+		|| OutHeader.Magic != AllocationTrace::TraceMagic
+		|| OutHeader.Version != AllocationTrace::TraceVersion
+		|| OutHeader.EventSize != sizeof(TraceEvent)
+		|| OutHeader.EventsCount > OutHeader.Capacity) {
+		std::cout << Path << " is not a compatible trace file\n";
+		fclose(File);
+		return false;
+	}
+
+	OutEvents.resize(static_cast<size_t>(OutHeader.EventsCount));
+	const size_t ReadCount = fread(OutEvents.data(), sizeof(TraceEvent), OutEvents.size(), File);
+	fclose(File);
+
+	if (ReadCount != OutEvents.size()) {
+		std::cout << Path << " is truncated\n";
+		return false;
+	}
+
+	//Events are appended per thread buffer, restore the global order
+	std::stable_sort(OutEvents.begin(), OutEvents.end(), [](const TraceEvent& A, const TraceEvent& B) {
+		return A.Timestamp < B.Timestamp;
+	});
+
+	return true;
+}
+
+//Resolve the block ids (reused after free) into slots, returns the number of slots
+//Frees of blocks allocated before the recording started are skipped
+static size_t BuildOps(const std::vector<TraceEvent>& Events, std::vector<ReplayOp>& OutOps, size_t& OutPeakLiveBytes) {
+	std::unordered_map<uint64_t, uint32_t> LiveSlots;
+	std::vector<uint32_t> FreeSlots;
+	std::vector<uint32_t> SlotSizes;
+	size_t LiveBytes = 0;
+
+	OutOps.reserve(Events.size());
+	OutPeakLiveBytes = 0;
+
+	auto FreeSlot = [&](uint32_t Slot) {
+		OutOps.push_back({ Slot, SlotSizes[Slot], false });
+		LiveBytes -= SlotSizes[Slot];
+		FreeSlots.push_back(Slot);
+	};
+
+	for (const TraceEvent& Event : Events) {
+		auto It = LiveSlots.find(Event.BlockId);
+
+		if (Event.Type == ETraceEventType::Free) {
+			if (It != LiveSlots.end()) {
+				FreeSlot(It->second);
+				LiveSlots.erase(It);
+			}
+			continue;
+		}
+
+		//The free of the previous owner of this id was not recorded in order
+		if (It != LiveSlots.end()) {
+			FreeSlot(It->second);
+			LiveSlots.erase(It);
+		}
+
+		uint32_t Slot;
+		if (!FreeSlots.empty()) {
+			Slot = FreeSlots.back();
+			FreeSlots.pop_back();
+			SlotSizes[Slot] = Event.Size;
+		}
+		else {
+			Slot = static_cast<uint32_t>(SlotSizes.size());
+			SlotSizes.push_back(Event.Size);
+		}
+
+		LiveSlots.emplace(Event.BlockId, Slot);
+		OutOps.push_back({ Slot, Event.Size, true });
+
+		LiveBytes += Event.Size;
+		OutPeakLiveBytes = std::max(OutPeakLiveBytes, LiveBytes);
+	}
+
+	//Blocks still live at the end of the recording are freed after the timed replay
+	return SlotSizes.size();
+}
+
+static ptr_t ReplayAlloc(EReplayBackend Backend, uint32_t Size) noexcept {
+	switch (Backend) {
+	case EReplayBackend::MemEx:
+		return MemoryManager::AllocBuffer<uint8_t, true>(Size).Release();
+	case EReplayBackend::System:
+		return malloc(Size ? Size : 1);
+	default:
+		return GAllocate(Size ? Size : 1, MEMEX_CACHE_LINE_SIZE);
+	}
+}
+
+static void ReplayFree(EReplayBackend Backend, ptr_t Ptr) noexcept {
+	switch (Backend) {
+	case EReplayBackend::MemEx:
+		MPtr<uint8_t>(reinterpret_cast<uint8_t*>(Ptr)).Reset();
+		break;
+	case EReplayBackend::System:
+		free(Ptr);
+		break;
+	default:
+		GFree(Ptr);
+		break;
+	}
+}
+
+//Peak resident set size of the process in bytes
+static size_t GetPeakRSS() noexcept {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS Counters{ };
+	if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters))) {
+		return 0;
+	}
+
+	return Counters.PeakWorkingSetSize;
+#else
+	rusage Usage{ };
+	if (getrusage(RUSAGE_SELF, &Usage) != 0) {
+		return 0;
+	}
+
+	//Kilobytes on Linux
+	return static_cast<size_t>(Usage.ru_maxrss) * 1024;
+#endif
+}
+
+#ifdef MEMEX_STATISTICS
+static size_t GetOSFallbacksCount() noexcept {
+	return MemoryManager::SmallBlock::GetTotalOSAllocations()
+		+ MemoryManager::MediumBlock::GetTotalOSAllocations()
+		+ MemoryManager::LargeBlock::GetTotalOSAllocations()
+		+ MemoryManager::ExtraLargeBlock::GetTotalOSAllocations()
+		+ MemoryManager::CustomSizeAllocations.load();
+}
+#endif
+
+int main(int argc, const char** argv)
+{
+	if (argc < 2) {
+		std::cout << "Usage: MemEx_TraceReplay <TraceFile> [memex|system|os] [--no-preallocate]\n";
+		return 1;
+	}
+
+	EReplayBackend Backend = EReplayBackend::MemEx;
+	bool bPreallocate = true;
+
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "memex")) {
+			Backend = EReplayBackend::MemEx;
+		}
+		else if (!strcmp(argv[i], "system")) {
+			Backend = EReplayBackend::System;
+		}
+		else if (!strcmp(argv[i], "os")) {
+			Backend = EReplayBackend::OS;
+		}
+		else if (!strcmp(argv[i], "--no-preallocate")) {
+			bPreallocate = false;
+		}
+		else {
+			std::cout << "Unknown argument " << argv[i] << "\n";
+			return 1;
+		}
+	}
+
+	TraceFileHeader Header{ };
+	std::vector<TraceEvent> Events;
+	if (!LoadTrace(argv[1], Events, Header)) {
+		return 1;
+	}
+
+	std::vector<ReplayOp> Ops;
+	size_t PeakLiveBytes = 0;
+	const size_t SlotsCount = BuildOps(Events, Ops, PeakLiveBytes);
+
+	//Release the trace before measuring the peak RSS of the replay
+	std::vector<TraceEvent>().swap(Events);
+
+	std::vector<ptr_t> Slots(SlotsCount, nullptr);
+
+	if (Backend == EReplayBackend::MemEx && bPreallocate && MemoryManager::Initialize()) {
+		std::cout << "MemoryManager::Initialize() -> Failed";
+		return 1;
+	}
+
+#ifdef MEMEX_STATISTICS
+	const size_t OSFallbacksBefore = GetOSFallbacksCount();
+#endif
+
+	size_t FailedAllocations = 0;
+
+	const auto Start = std::chrono::high_resolution_clock::now();
+
+	for (const ReplayOp& Op : Ops) {
+		if (Op.bAlloc) {
+			ptr_t Ptr = ReplayAlloc(Backend, Op.Size);
+			if (!Ptr) {
+				FailedAllocations++;
+				continue;
+			}
+
+			//Touch the block like the recorded program did
+			*reinterpret_cast<volatile uint8_t*>(Ptr) = 1;
+			Slots[Op.Slot] = Ptr;
+		}
+		else if (Slots[Op.Slot]) {
+			ReplayFree(Backend, Slots[Op.Slot]);
+			Slots[Op.Slot] = nullptr;
+		}
+	}
+
+	const double Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - Start).count();
+
+	const size_t PeakRSS = GetPeakRSS();
+
+	for (ptr_t& Ptr : Slots) {
+		if (Ptr) {
+			ReplayFree(Backend, Ptr);
+			Ptr = nullptr;
+		}
+	}
+
+	const char* BackendNames[] = { "memex", "system", "os" };
+
+	printf("#Trace replay (%s):\n", argv[1]);
+	printf("\tBackend:%s\n\tPreallocated:%s\n", BackendNames[static_cast<int>(Backend)], bPreallocate ? "true" : "false");
+	printf("\tTiers:\n\t\tSmallBlock:%d x %d\n\t\tMediumBlock:%d x %d\n\t\tLargeBlock:%d x %d\n\t\tExtraLargeBlock:%d x %d\n",
+		SmallMemBlockSize, SmallMemBlockCount,
+		MediumMemBlockSize, MediumMemBlockCount,
+		LargeMemBlockSize, LargeMemBlockCount,
+		ExtraLargeMemBlockSize, ExtraLargeMemBlockCount
+	);
+	printf("\tRecorded events:%lld (dropped:%lld)\n\tReplayed operations:%lld\n\tFailed allocations:%lld\n",
+		Header.EventsCount,
+		Header.DroppedEventsCount,
+		Ops.size(),
+		FailedAllocations
+	);
+	printf("\tOperations/sec:%.0f\n\tPeak live bytes:%lld\n\tPeak RSS:%lld\n",
+		Seconds > 0.0 ? static_cast<double>(Ops.size()) / Seconds : 0.0,
+		PeakLiveBytes,
+		PeakRSS
+	);
+
+#ifdef MEMEX_STATISTICS
+	if (Backend == EReplayBackend::MemEx) {
+		printf("\tOS fallbacks:%lld\n", GetOSFallbacksCount() - OSFallbacksBefore);
+	}
+#endif
+
+	return 0;
+}